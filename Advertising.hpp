@@ -17,6 +17,7 @@
 #include "Timer.hpp"
 #include "Battery.hpp"
 #include "Flash.hpp"
+#include "Profile.hpp"
 
 #undef SA
 #define SA [[gnu::noinline]] static auto
@@ -101,8 +102,7 @@ SA  make            (u8* buf) {
                         //2.00v = 0%, 3.00v = 100%
                         //percentage will be mV/10 from 2-3v (77% = 2.77v)
                         u16 bv = battery.read();
-                        DebugFuncHeader();
-                        DebugRtt << "  battery: " << bv << "mV" << endl;
+                        DebugLogHeader(DBG_BATTERY, DBG_INFO) << "  battery: " << bv << "mV" << endl;
                         u8 dat = bv > 3000 ? 100 :
                                  bv < 2000 ? 0 :
                                  (bv - 2000)/10;
@@ -115,7 +115,7 @@ SA  make            (u8* buf) {
 /*------------------------------------------------------------------------------
     MyTemperatureAD - AD data struct(s) to make up payload of adv pdu
 ------------------------------------------------------------------------------*/
-template<typename TempDriver_>
+template<typename TempDriver_, typename Rate_ = FixedRate>
 struct MyTemperatureAD {
 
 //============
@@ -123,14 +123,44 @@ struct MyTemperatureAD {
 //============
 
     SI TempDriver_ temp_;
+    SI Rate_ rate_;
+    SI u32 interval_{ 0 };
+    SI void(*cb_)(void*){ nullptr };
+
+                    //filtered value of the last completed reading (-999 if it failed)
+SA  value_          () -> i16 {
+                        i16 f = temp_.last();
+                        return f == -999 ? f : temp_.value();
+                    }
+
+                    //temp_ callback, a new reading (the rate policy sees each
+                    //reading once, not each packet update)
+SA  done_           (void*) {
+                        interval_ = rate_.next( value_() );
+                        if( cb_ ) cb_( nullptr );
+                    }
 
 //===========
     public:
 //===========
 
+                    //update interval wanted from the rate policy (0 = no change)
+SA  interval        () { return interval_; }
+
+                    //new reading, cb when done (to update the packet), false if
+                    //no read was started (busy), cb is called now with the last value
+SA  sample          (void(*cb)(void*)) -> bool {
+                        auto prev = cb_; //a read in flight keeps its cb
+                        cb_ = cb;
+                        if( temp_.start(done_) ) return true;
+                        cb_ = prev;
+                        if( cb ) cb( nullptr );
+                        return false;
+                    }
+
 SA  update          ( u8 (&buf)[31] ) -> void {
-                        // new temp reading
-                        i16 f = temp_.read(); //~50us
+                        ProfileScope ps{ PROF_TEMP_UPDATE };
+                        i16 f = value_();
                         //making our own decimal point, so %10 needs to be positive
                         u8 f10 = (f < 0) ? -f%10 : f%10;
                         f = f/10;
@@ -147,7 +177,8 @@ SA  update          ( u8 (&buf)[31] ) -> void {
 
 /*------------------------------------------------------------------------------
     Advertising
-    AdT_ = some struct that takes care of the adv data, which has init/update
+    AdT_ = some struct that takes care of the adv data, which has
+           sample(cb)/update(buf)/interval()
     IntervalMS_ = advertising interval in ms
     InitCB_ = function pointer for init() to call if wanted (start a timer)
 ------------------------------------------------------------------------------*/
@@ -178,21 +209,27 @@ struct Advertising {
     SI auto paramInterval_{IntervalMS_*1.6};// 1600 = 1 sec
 
     SI bool isActive_{false};
+    SI bool isConnected_{false}; //no advertising while connected (S112, 1 role)
     SI bool isConnectable_{true}; //start out connectable so can change name
     SI u8   connectableTimeout_{20}; //disable connectable after some number of updates
 
     //update data interval
     SI Timer timerAdvUpdate_;
     SI u32   timerInterval_{UpdateInterval_};
+    SI bool  isTimerCreated_{false};
+    SI bool  isTimerOn_{false};      //off while connected
 
 //===========
     public:
 //===========
 
-                    //call from  ble connected event handler to update the state
-                    //of advertising since the soft device stopped it
-SA  isStopped       () { 
-                        isActive_ = false; 
+                    //call from the ble connected/disconnected event handler, the
+                    //soft device stopped advertising on connect, while connected
+                    //a reading that completes (async driver, alert events) only
+                    //updates the packet, start() would be refused (error.check)
+SA  connected       (bool tf) { 
+                        isConnected_ = tf;
+                        if( tf ) isActive_ = false; 
                     }
 
                     //turn on/off connectable, so can make connectable intially 
@@ -201,56 +238,77 @@ SA  connectable     (bool tf) {
                         isConnectable_ = tf; 
                     }
 
-                    //called by timer
-SA  update          (void* pcontext = nullptr) -> void {
+                    //called by timer, new reading, update when done
+                    //(the driver does not block, the cpu sleeps until then)
+SA  sample          (void* = nullptr) -> void {
+                        ADdata_.sample( update );
+                    }
+
+                    //new reading done
+SA  update          (void* = nullptr) -> void {
+                        ProfileScope ps{ PROF_ADV_UPDATE };
                         stop();
                         ADdata_.update(buffer_);
+                        //AdT_ may want a different update interval, the timer is
+                        //only restarted if running (timerOn uses the new interval)
+                        if( auto ms = ADdata_.interval(); ms and ms != timerInterval_ ){
+                            timerInterval( ms );
+                            if( isTimerOn_ ){ timerOff(); timerOn(); }
+                        }
 
                         //=== Debug ===
-                        DebugFuncHeader();
-                        DebugRtt << FG CYAN "  -advertising packet-" << endl << FG WHITE;
-                        auto i = 0;
-                        while( buffer_[i] ){
-                            u32 len = buffer_[i++];
-                            auto typ = buffer_[i++];
-                            DebugRtt
-                                << reset
-                                << "  len: " << setwf(2,' ') << len-- 
-                                << "  type: " << Hex << setwf(2,'0') << typ
-                                << "  data: ";
-                            //name
-                            if( typ == 9 ){ 
-                                DebugRtt << setwmax(len) << (char*)&buffer_[i] << ' ' << setwmax(0);
-                                }
-                            else {
-                                for( u32 j = 0; j < len; j++ ){ 
-                                    DebugRtt << setwf(2,'0') << Hex << buffer_[i+j] << ' ';
+                        if constexpr( debugOn(DBG_ADV, DBG_TRACE) ){
+                            debugHeader( __FILE__, __LINE__, __func__ ) << FG CYAN "  -advertising packet-" << endl << FG WHITE;
+                            auto i = 0;
+                            while( buffer_[i] ){
+                                u32 len = buffer_[i++];
+                                auto typ = buffer_[i++];
+                                DebugRtt
+                                    << reset
+                                    << "  len: " << setwf(2,' ') << len-- 
+                                    << "  type: " << Hex << setwf(2,'0') << typ
+                                    << "  data: ";
+                                //name
+                                if( typ == 9 ){ 
+                                    DebugRtt << setwmax(len) << (char*)&buffer_[i] << ' ' << setwmax(0);
                                     }
+                                else {
+                                    for( u32 j = 0; j < len; j++ ){ 
+                                        DebugRtt << setwf(2,'0') << Hex << buffer_[i+j] << ' ';
+                                        }
+                                }
+                                i += len;
+                                DebugRtt << endl;
                             }
-                            i += len;
-                            DebugRtt << endl;
+                            DebugRtt << endlr;
                         }
-                        DebugRtt << endlr;
                         //=== Debug ===
 
+                        if( isConnected_ ) return; //disconnect will start it
                         start();
                     }
 
 SA  timerOn         () {
-                        timerAdvUpdate_.init( timerInterval_, update, timerAdvUpdate_.REPEATED );
+                        if( not isTimerCreated_ ){
+                            timerAdvUpdate_.create( sample, timerAdvUpdate_.REPEATED );
+                            isTimerCreated_ = true;
+                        }
+                        timerAdvUpdate_.start( timerInterval_ );
+                        isTimerOn_ = true;
                     }
 
 SA  timerOff        () {
                         timerAdvUpdate_.stop();
+                        isTimerOn_ = false;
                     }
 SA  timerInterval   (u32 ms) {
                         timerInterval_ = ms;
                     }
 
 SA  init            () {
-                        DebugRtt << "Advertising::init..." << endl;
+                        DebugLog(DBG_ADV, DBG_INFO) << "Advertising::init..." << endl;
                         params_.interval = paramInterval_;
-                        update();
+                        sample(); //update when the first reading is done
                         timerOn();
                     }
 
@@ -297,17 +355,28 @@ SA  stop            () -> void {
 /*
     for all who include this file
     someone(main) will need to run adv.init()
-    5 minutes average per history value
     3000ms advertising interval
-    20 second temp update interval
+    20 second temp update interval (or from the AdT_ rate policy)
 */
 // void advInitCB(); //called from adv.init()
 #ifdef TEMPERATURE_INTERNAL
-    inline Advertising< MyTemperatureAD<TemperatureInternal<5> >, 3000, 20_sec > adv; 
+    inline Advertising< MyTemperatureAD<TemperatureInternal<Boxcar<5>> >, 3000, 20_sec > adv; 
+#elif defined TEMPERATURE_TMP117 && defined TMP117_WINDOW
+    //temperature updates come from the tmp117 alert, timer is only for battery/name
+    inline Advertising< MyTemperatureAD<TemperatureTmp117Window<NoFilter>>, 3000, 30*60_sec > adv; 
+#elif defined TEMPERATURE_TMP117 && defined TMP117_AUTO
+    //tmp117 read by hardware every 4s, cpu every 5 samples, timer is only for battery/name
+    inline Advertising< MyTemperatureAD<TemperatureTmp117Auto<NoFilter>>, 3000, 30*60_sec > adv; 
 #elif defined TEMPERATURE_TMP117
-    inline Advertising< MyTemperatureAD<TemperatureTmp117<5> >, 3000, 20_sec > adv; 
+    //8 averages in the ic (one-shot, 125ms), no software history
+    //sample every 20s when changing, up to every 320s when within 0.3F
+    //power policy from the shortest interval (20s = gated)
+    inline Advertising< MyTemperatureAD<TemperatureTmp117<NoFilter, Tmp117Avg8, Tmp117PowerFor<Tmp117Avg8, 20_sec>>, 
+                                        SampleRate<20_sec, 320_sec, 3> >, 3000, 20_sec > adv; 
 #elif defined TEMPERATURE_SI7051
-    inline Advertising< MyTemperatureAD<TemperatureSi7051<5> >, 3000, 20_sec > adv;
+    //power policy from the interval (20s = kept on in standby)
+    inline Advertising< MyTemperatureAD<TemperatureSi7051<Boxcar<5>, Si7051Res::RES_12BIT, Si7051PowerFor<20_sec>> >, 
+                        3000, 20_sec > adv;
 #else
     #error "Temperature source not defined in nRFconfig.hpp" 
 #endif
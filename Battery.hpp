@@ -9,6 +9,7 @@
 
 #include "Print.hpp"
 #include "Saadc.hpp"
+#include "Profile.hpp"
 
 /*------------------------------------------------------------------------------
     Battery - read battery voltage
@@ -20,6 +21,9 @@ struct Battery {
 //============
 
     SCA updateInterval_{ 60 }; //no need to read all the time
+    //offset calibration drifts with temperature, not with each read, so
+    //only on the first read and then every calInterval_ reads
+    SCA calInterval_{ 24 };
     //CH0, gain 1/6, ref = 0.6v, 10us (all default values)
     SI SaadcChan vdd_{ SaadcChan::VDD };
     // millivolts  (adc*vref*1000*scale/resolution)
@@ -27,16 +31,20 @@ struct Battery {
     SI i16 voltage_{ 0 }; 
 
 SA  update          () {
+                        ProfileScope ps{ PROF_BATTERY_UPDATE };
                         static u8 count;
+                        static u8 calCount;
                         if( count == 0 ) {
-                            vdd_.calibrate();
+                            if( calCount == 0 ) vdd_.calibrate();
+                            if( ++calCount >= calInterval_ ) calCount = 0;
                             i16 v = 0;
-                            vdd_.read(v, vdd_.RES10, vdd_.OVER8X);
-                            voltage_ = (i32)v * 3600 / 1024;
+                            //8 samples in 1 burst, sleeps until done
+                            //(a timeout keeps the last value)
+                            if( vdd_.read(v, vdd_.RES10, vdd_.OVER8X) ) voltage_ = (i32)v * 3600 / 1024;
                             //make sure we are in some sane range
                             if( voltage_ < 500 ) voltage_ = 0; // <500mv, show 0000
                             if( voltage_ > 3600 ) voltage_ = 9999; //>3600, show 9999
-                            DebugRtt << "Battery::update  " << (i16)(voltage_/1000) << '.' 
+                            DebugLog(DBG_BATTERY, DBG_INFO) << "Battery::update  " << (i16)(voltage_/1000) << '.' 
                                     << setwf(3,'0') << (i16)(voltage_%1000) << "uV" << endlr; 
                         }
                         if( ++count >= updateInterval_ ) count = 0;  
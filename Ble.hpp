@@ -21,12 +21,11 @@ struct Ble {
     private:
 
 SA  eventHandler    (ble_evt_t const * p_ble_evt, void * p_context) {
-                        DebugFuncHeader();
-                        DebugRtt << ANSI_NORMAL "header.event_id: " << p_ble_evt->header.evt_id << endl;
+                        DebugLogHeader(DBG_BLE, DBG_INFO) << ANSI_NORMAL "header.event_id: " << p_ble_evt->header.evt_id << endl;
                         switch (p_ble_evt->header.evt_id){
 
                             case BLE_GATTS_EVT_WRITE:
-                                DebugRtt << "BLE_GATTS_EVT_WRITE:" << endl;
+                                DebugLog(DBG_BLE, DBG_INFO) << "BLE_GATTS_EVT_WRITE:" << endl;
                                 //if write device name, we are interested
                                 if( p_ble_evt->evt.gatts_evt.params.write.uuid.uuid == BLE_UUID_GAP_CHARACTERISTIC_DEVICE_NAME ){
                                     uint16_t len = 0;
@@ -35,34 +34,35 @@ SA  eventHandler    (ble_evt_t const * p_ble_evt, void * p_context) {
                                     sd_ble_gap_device_name_get( buf, &len );
                                     buf[len] = 0; //0 terminate string
                                     flash.updateName( (const char*)buf );
-                                    DebugRtt << buf << endl;
+                                    DebugLog(DBG_BLE, DBG_INFO) << (const char*)buf << endl;
                                 }
                                 break;
 
                             case BLE_GAP_EVT_CONNECTED:
-                                DebugRtt << "connected" << endl;
+                                DebugLog(DBG_BLE, DBG_INFO) << "connected" << endl;
                                 adv.timerOff(); //stop the adv update timer
-                                adv.isStopped(); //and let adv know it is stopped
+                                adv.connected( true ); //adv is stopped, readings only update the packet
                                 break;
 
                             case BLE_GAP_EVT_DISCONNECTED:
-                                DebugRtt << "disconnected" << endl;
+                                DebugLog(DBG_BLE, DBG_INFO) << "disconnected" << endl;
                                 conn.stop(); //no longer need, so stop (?)
                                 adv.connectable( false ); //no longer need to be connectable
+                                adv.connected( false );
                                 adv.update(); //restart advertising
                                 adv.timerOn(); //restart adv update timer
                                 break;
 
                             case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
                                 {
-                                DebugRtt << "BLE_GAP_EVT_PHY_UPDATE_REQUEST" << endl;
+                                DebugLog(DBG_BLE, DBG_INFO) << "BLE_GAP_EVT_PHY_UPDATE_REQUEST" << endl;
                                 ble_gap_phys_t const phys{ BLE_GAP_PHY_AUTO, BLE_GAP_PHY_AUTO, };
                                 error.check( sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &phys) );
                                 } 
                                 break;
 
                             default:
-                                DebugRtt << FG RED "unhandled event" << ANSI_NORMAL << endl;
+                                DebugLog(DBG_BLE, DBG_WARN) << FG RED "unhandled event" << ANSI_NORMAL << endl;
                                 board.caution(); //red blink
                                 break;
                         }
@@ -73,12 +73,12 @@ SA  eventHandler    (ble_evt_t const * p_ble_evt, void * p_context) {
 //===========
 
 SA  init            () {
-                        DebugRtt << "Ble::init..." << endl;
+                        DebugLog(DBG_BLE, DBG_INFO) << "Ble::init..." << endl;
                         uint32_t ram_start = 0;
                         error.check( nrf_sdh_enable_request() );
                         error.check( nrf_sdh_ble_default_cfg_set(BLE_CONN_CFG_TAG_DEFAULT, &ram_start) );
                         error.check( nrf_sdh_ble_enable(&ram_start) );
-                        DebugRtt << "    ram start: " << Hex0x << setwf(8,'0') << ram_start << endlr;
+                        DebugLog(DBG_BLE, DBG_INFO) << "    ram start: " << Hex0x << setwf(8,'0') << ram_start << endlr;
                         //_name, _prio, _handler, _context
                         NRF_SDH_BLE_OBSERVER(bleObserver_, 3, eventHandler, NULL);
                     }
@@ -6,6 +6,7 @@
 
 #include "Gpio.hpp"
 #include "Print.hpp"
+#include "Twim.hpp"
 
 #ifdef  NRF52840 //for 52840 based boards
 /*------------------------------------------------------------------------------
@@ -32,7 +33,7 @@ struct Pca10059 {
 
             //someone is required to run init to setup pins
 SA  init    () {
-                DebugRtt << "Pca10059::init..." << endl;
+                DebugLog(DBG_BOARD, DBG_INFO) << "Pca10059::init..." << endl;
                 // Debug( "Pca10059::init...\n" );
                 led1G.init( OUTPUT );
                 led2G.init( OUTPUT );
@@ -87,9 +88,20 @@ struct BL651tempBoard {
     //SDA - P0_13 - input, S0D1
     //SCL - P0_15 - input, SOD1
     //PWR - P0_17 - output, power to i2c devices tmp117/si7051
+    //ALERT - P0_16 - input, tmp117 ALERT (open drain, active low)
     Gpio<P0_13>  sda; 
     Gpio<P0_15>  scl;
     Gpio<P0_17>  i2cDevicePwr; 
+    Gpio<P0_16>  tmp117Alert; //taken care of in GpiotePin
+
+    //i2c bus of each sensor (Temperature.hpp), 1 bus on the nRF52810
+    //a nRF52840 board can put sensors on Twim1 (own pins, same or own
+    //power pin), sensors on different buses then convert and read at
+    //the same time (TemperatureGroup)
+    //  using si7051Twi = Twim1< P1_1, P1_2, decltype(i2cDevicePwr)::pinNumber() >;
+    using tmp117Twi = Twim0< decltype(sda)::pinNumber(), decltype(scl)::pinNumber(),
+                             decltype(i2cDevicePwr)::pinNumber() >;
+    using si7051Twi = tmp117Twi;
 
 //taken care of in Twim
 // SA  i2cInit () {
@@ -114,7 +126,7 @@ struct BL651tempBoard {
 
             //someone is required to run init to setup pins
 SA  init    () {
-                DebugRtt << "BL651tempBoard::init..." << endl;
+                DebugLog(DBG_BOARD, DBG_INFO) << "BL651tempBoard::init..." << endl;
                 ledRed.init( OUTPUT, S0S1 ); //standard drive 1
                 ledGreen.init( OUTPUT, S0S1 ); //standard drive 1
                 sw1.init( INPUT, PULLUP );
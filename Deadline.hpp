@@ -0,0 +1,205 @@
+#pragma once
+
+#include "nRFconfig.hpp"
+
+#include "nrf_nvic.h"   //sd_nvic_*, softdevice owns the nvic
+
+/*------------------------------------------------------------------------------
+    Deadline - hardware timeouts (TIMER2, 1MHz, free running while any
+    deadline is on), one compare channel per deadline
+
+    ch 0 is for a __WFE wait, the irq of the waited on peripheral and of
+    TIMER2 stay disabled in the nvic (unless a cb channel is on, then the
+    isr only turns off the ch 0 interrupt), with SEVONPEND set their
+    pending irq is a wakeup event, so the cpu sleeps until the event or
+    the deadline, whichever is first
+
+    Deadline::start( 20000 ); //20ms
+    while( not done() ){
+        sd_nvic_ClearPendingIRQ( irq ); //so the next event pends again
+        if( done() or Deadline::isExpired() ) break;
+        __WFE();
+    }
+    auto us = Deadline::stop(); //elapsed
+
+    ch 1-3 are irq versions, no wait, cb(ch) from the TIMER2 irq (priority
+    6) if not stopped before the deadline, each channel is independent, so
+    a wait (ch 0) does not disturb an async deadline (ch 1-2 Twim, 1 per
+    bus, ch 3 SaadcChan::readAsync)
+
+    Deadline::start( 1, 20000, cb );
+    auto us = Deadline::stop( 1 );
+
+    a start replaces the one running on the same channel
+
+    start/stop are in a critical region, the TIMER2 isr and a twim isr
+    stop their channels, which can turn the timer off (and change on_)
+    in the middle of an arm from thread mode
+
+    TIMER2 has 4 CC's, all are compares, the count (start, elapsed) is
+    captured into the CC of the channel being armed or stopped (its
+    compare is off then, a captured CC does not match until the count
+    comes around)
+
+    TIMER2 is not used by the softdevice (TIMER0) or the sdk (nrfx timer
+    is not enabled), it only runs (PCLK1M) while a deadline is started
+------------------------------------------------------------------------------*/
+struct Deadline {
+
+    SCA         CHANNELS    { 4 };          //compares 0-3
+
+//============
+    private:
+//============
+
+    SCA         base_       { 0x4000A000 }; //TIMER2
+    SCA         IRQN_       { 10 };         //TIMER2_IRQn
+    SCA         IRQPRI_     { 6 };          //APP_IRQ_PRIORITY_LOW
+    SCA         COMPARE0_   { 1u<<16 };     //INTEN.COMPARE0, +ch
+    SCA         SEVONPEND_  { 1u<<4 };      //SCR
+
+    SI u32      scr_        { 0 };          //SCR before start (ch 0)
+    SI u8       on_         { 0 };          //channel bitmask
+    SI u8       irqs_       { 0 };          //channels with a cb
+    SI u32      from_[CHANNELS]{};          //count at start
+    SI u32      us_[CHANNELS]{};            //deadline, us from start
+    SI void     (*cb_[CHANNELS])(u8){};
+
+    struct Timer_; //forward declare register struct, at end
+
+    static inline volatile u32& SCR { *(reinterpret_cast<u32*>(0xE000ED10)) };
+
+                    //count now, ch compare is off (captured into its CC)
+SA  now_            (u8 ch) -> u32 { reg.TASKS_CAPTURE[ch] = 1; return reg.CC[ch]; }
+
+                    //timer running, compare set (not yet enabled), in a
+                    //critical region
+SA  arm_            (u8 ch, u32 us) {
+                        stop_( ch );
+                        if( not on_ ){
+                            reg.MODE = 0;           //timer
+                            reg.BITMODE = 3;        //32bit
+                            reg.PRESCALER = 4;      //16MHz/2^4 = 1MHz
+                            reg.SHORTS = 0;         //free running
+                            reg.TASKS_CLEAR = 1;
+                            reg.TASKS_START = 1;
+                        }
+                        if( us < 2 ) us = 2; //compare not already passed when set
+                        from_[ch] = on_ ? now_( ch ) : 0; //0 = just cleared
+                        on_ or_eq 1u<<ch;
+                        us_[ch] = us;
+                        reg.CC[ch] = from_[ch] + us;
+                        reg.EVENTS_COMPARE[ch] = 0;
+                        reg.INTENSET = COMPARE0_<<ch;
+                    }
+
+                    //in a critical region (or the TIMER2 isr)
+SA  stop_           (u8 ch) -> u32 {
+                        if( not isOn(ch) ) return 0;
+                        reg.INTENCLR = COMPARE0_<<ch;
+                        auto us = now_( ch ) - from_[ch]; //elapsed, up to the deadline
+                        if( us > us_[ch] ) us = us_[ch];
+                        reg.EVENTS_COMPARE[ch] = 0;
+                        on_ and_eq compl (1u<<ch);
+                        if( irqs_ bitand (1u<<ch) ){
+                            irqs_ and_eq compl (1u<<ch);
+                            cb_[ch] = nullptr;
+                            if( not irqs_ ) sd_nvic_DisableIRQ( (IRQn_Type)IRQN_ );
+                        }
+                        if( ch == 0 ) SCR = scr_;
+                        if( not on_ ) reg.TASKS_STOP = 1;
+                        if( not irqs_ ) sd_nvic_ClearPendingIRQ( (IRQn_Type)IRQN_ );
+                        return us;
+                    }
+
+//============
+    public:
+//============
+
+    //give public access to registers
+    static inline volatile Timer_&
+    reg { *(reinterpret_cast<Timer_*>(base_)) };
+
+                    //ch 0, us from now, for a __WFE wait
+SA  start           (u32 us) {
+                        u8 nested;
+                        sd_nvic_critical_region_enter( &nested );
+                        if( not (on_ bitand 1) ) scr_ = SCR; //not when replacing one
+                        arm_( 0, us );
+                        SCR = scr_ bitor SEVONPEND_;
+                        sd_nvic_critical_region_exit( nested );
+                    }
+
+                    //irq version, ch 1-3, cb(ch) at the deadline
+SA  start           (u8 ch, u32 us, void(*cb)(u8)) {
+                        u8 nested;
+                        sd_nvic_critical_region_enter( &nested );
+                        arm_( ch, us );
+                        cb_[ch] = cb;
+                        irqs_ or_eq 1u<<ch;
+                        sd_nvic_SetPriority( (IRQn_Type)IRQN_, IRQPRI_ );
+                        sd_nvic_EnableIRQ( (IRQn_Type)IRQN_ );
+                        sd_nvic_critical_region_exit( nested );
+                    }
+
+SA  isOn            (u8 ch = 0) -> bool { return on_ bitand (1u<<ch); }
+SA  isExpired       (u8 ch = 0) -> bool { return reg.EVENTS_COMPARE[ch]; }
+
+                    //stop, returns elapsed us
+SA  stop            (u8 ch = 0) -> u32 {
+                        u8 nested;
+                        sd_nvic_critical_region_enter( &nested );
+                        auto us = stop_( ch );
+                        sd_nvic_critical_region_exit( nested );
+                        return us;
+                    }
+
+                    //from TIMER2_IRQHandler (only enabled for the cb versions)
+SA  isr             () {
+                        for( u8 ch = 0; ch < CHANNELS; ch++ ){
+                            if( not isOn(ch) or not reg.EVENTS_COMPARE[ch] ) continue;
+                            auto cb = cb_[ch];
+                            //ch 0 (wait) event stays set for isExpired, only its
+                            //irq is turned off, it already woke the cpu
+                            if( not cb ){ reg.INTENCLR = COMPARE0_<<ch; continue; }
+                            stop_( ch );
+                            cb( ch );
+                        }
+                    }
+
+//============
+    private:
+//============
+
+//------------
+//  registers
+//------------
+
+    struct Timer_ {
+                u32 TASKS_START;            //0x000
+                u32 TASKS_STOP;             //0x004
+                u32 TASKS_COUNT;            //0x008
+                u32 TASKS_CLEAR;            //0x00C
+                u32 TASKS_SHUTDOWN;         //0x010
+                u32 unused1[(0x040-0x014)/4];
+                u32 TASKS_CAPTURE[6];       //0x040
+                u32 unused2[(0x140-0x058)/4];
+                u32 EVENTS_COMPARE[6];      //0x140
+                u32 unused3[(0x200-0x158)/4];
+                u32 SHORTS;                 //0x200
+                u32 unused4[(0x304-0x204)/4];
+                u32 INTENSET;               //0x304
+                u32 INTENCLR;               //0x308
+                u32 unused5[(0x504-0x30C)/4];
+                u32 MODE;                   //0x504
+                u32 BITMODE;                //0x508
+                u32 unused6;
+                u32 PRESCALER;              //0x510
+                u32 unused7[(0x540-0x514)/4];
+                u32 CC[6];                  //0x540
+    };
+
+};
+
+//only 1 translation unit (main.cpp), so can define the irq handler here
+extern "C" void TIMER2_IRQHandler(void) { Deadline::isr(); }
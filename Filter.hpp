@@ -0,0 +1,161 @@
+#pragma once
+
+#include "nRFconfig.hpp"
+
+#include "Window.hpp"
+
+/*------------------------------------------------------------------------------
+    temperature filter policies, used as the Temperature template parameter
+    each has- add(i16), value() -> i16
+    (first value added sets the filter output, so value() is valid
+     after the first add)
+
+    ram used (nRF52, sizeof)-
+        NoFilter            2
+        Boxcar<N_>          2*N_ + ~30
+        Ema<Shift_>         2
+        Median<N_>          2*N_ + 2
+        Decimate<R_,F_>     6 + sizeof(F_), rounded up to 4
+------------------------------------------------------------------------------*/
+
+/*------------------------------------------------------------------------------
+    NoFilter - value is the last value added
+------------------------------------------------------------------------------*/
+struct NoFilter {
+
+auto    add         (i16 v) { v_ = v; }
+auto    value       () const { return v_; }
+
+//============
+    private:
+//============
+
+    i16 v_{0};
+
+};
+
+/*------------------------------------------------------------------------------
+    Boxcar - average of the last N_ values
+------------------------------------------------------------------------------*/
+template<u16 N_>
+struct Boxcar {
+
+auto    add         (i16 v) { w_.add( v ); }
+auto    value       () const { return w_.mean(); }
+
+//============
+    private:
+//============
+
+    Window<N_, false, false> w_;
+
+};
+
+/*------------------------------------------------------------------------------
+    Ema - exponential moving average, y += (x - y) / 2^Shift_
+    state is x16 (4 fractional bits) in an i16, so |value| < 2048
+    (temperature Fx10 is -400 to 1800), the initial value is the first add
+
+    step response 63% in ~2^Shift_ samples
+    Shift_ 1 = 2 samples, 2 = 4 samples, 3 = 8 samples ...
+------------------------------------------------------------------------------*/
+template<u8 Shift_>
+struct Ema {
+
+    static_assert( Shift_ >= 1 and Shift_ <= 8, "Ema Shift_ is 1-8" );
+
+auto    add         (i16 v) {
+                        i32 x = (i32)v * FRAC;
+                        if( y_ == UNSET ){ y_ = x; return; }
+                        i32 d = x - y_;
+                        i32 s = d / (1<<Shift_);
+                        if( s == 0 ) s = (d > 0) - (d < 0); //always move, so y_ settles at x
+                        y_ += s;
+                    }
+auto    value       () const {
+                        if( y_ == UNSET ) return (i16)0;
+                        return (i16)( (y_ + (y_ < 0 ? -FRAC/2 : FRAC/2)) / FRAC );
+                    }
+
+//============
+    private:
+//============
+
+    SCA FRAC{ 16 };
+    SCA UNSET{ -32768 };
+
+    i16 y_{ UNSET };
+
+};
+
+/*------------------------------------------------------------------------------
+    Median - median of the last N_ values (N_ = 3 or 5), a single spike
+    (or 2 with N_=5) is ignored
+------------------------------------------------------------------------------*/
+template<u8 N_>
+struct Median {
+
+    static_assert( N_ == 3 or N_ == 5, "Median N_ is 3 or 5" );
+
+auto    add         (i16 v) {
+                        if( not isInit_ ){ //first time, fill with same value
+                            for( auto& h : hist_ ) h = v;
+                            isInit_ = true;
+                        }
+                        hist_[idx_] = v;
+                        idx_ = idx_+1 < N_ ? idx_+1 : 0;
+                    }
+auto    value       () const {
+                        i16 s[N_];
+                        for( auto i = 0; i < N_; i++ ) s[i] = hist_[i];
+                        //insertion sort, at most 10 compares
+                        for( auto i = 1; i < N_; i++ ){
+                            auto v = s[i];
+                            auto j = i;
+                            for( ; j and s[j-1] > v; j-- ) s[j] = s[j-1];
+                            s[j] = v;
+                        }
+                        return s[N_/2];
+                    }
+
+//============
+    private:
+//============
+
+    i16 hist_[N_]{};
+    u8 idx_{0};
+    bool isInit_{false};
+
+};
+
+/*------------------------------------------------------------------------------
+    Decimate - average R_ values, then feed the average to Filter_
+    (sample the sensor R_ times faster than the output is needed)
+    the first value also goes to Filter_ so value() is valid right away
+------------------------------------------------------------------------------*/
+template<u8 R_, typename Filter_ = NoFilter>
+struct Decimate {
+
+    static_assert( R_ >= 1, "Decimate R_ needs to be at least 1" );
+
+auto    add         (i16 v) {
+                        if( not isInit_ ){ f_.add( v ); isInit_ = true; }
+                        sum_ += v;
+                        if( ++n_ < R_ ) return;
+                        f_.add( sum_ / R_ );
+                        sum_ = 0;
+                        n_ = 0;
+                    }
+auto    value       () const { return f_.value(); }
+auto&   filter      () { return f_; }
+
+//============
+    private:
+//============
+
+    i32 sum_{0};
+    u8 n_{0};
+    bool isInit_{false};
+    Filter_ f_;
+
+};
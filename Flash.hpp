@@ -12,6 +12,7 @@
 
 #include "Errors.hpp" //error
 #include "Print.hpp"
+#include "Profile.hpp"
 
 
 /*------------------------------------------------------------------------------
@@ -37,15 +38,15 @@ struct Flash {
 
 
                     //sd soc event handler to get success/error from erase/write
-SA  evtHandler      (u32 evtId, void* ctx) -> void {
-                        DebugRtt << "Flash::handler event : " << evtId << endl;
+SA  evtHandler      (u32 evtId, void*) -> void {
+                        DebugLog(DBG_FLASH, DBG_INFO) << "Flash::handler event : " << evtId << endl;
                         if( evtId == NRF_EVT_FLASH_OPERATION_SUCCESS ){
-                            DebugRtt << "    success" << endl;
+                            DebugLog(DBG_FLASH, DBG_INFO) << "    success" << endl;
                             dump();
                             busy_ = false;
                         }
                         if( evtId == NRF_EVT_FLASH_OPERATION_ERROR ){
-                            DebugRtt << "    error" << endl;
+                            DebugLog(DBG_FLASH, DBG_ERROR) << "    error" << endl;
                             busy_ = false;
                         }
                     }
@@ -56,13 +57,14 @@ SA  evtHandler      (u32 evtId, void* ctx) -> void {
 
                     //dump 32 bytes
 SA  dump            () -> void {
+                        if constexpr( not debugOn(DBG_FLASH, DBG_TRACE) ) return;
                         DebugRtt << "fullname flash values:" << endl << "    ";
                         for( auto i = 0; i < fullnameSiz_; i++ ){
                             DebugRtt << setw(2) << setfill('0') << fullnameFlash_[i];
                             if( (i bitand 15) == 15 ){
                                 DebugRtt << " ";
                                 for( auto j = i-15; j <= i; j++ ){
-                                    DebugRtt << (fullnameFlash_[j] > ' ' and fullnameFlash_[j] < 128 ? 
+                                    DebugRtt << (fullnameFlash_[j] > ' ' and (u8)fullnameFlash_[j] < 128 ? 
                                                 fullnameFlash_[j] : '.');  
                                 }
                                 DebugRtt << endl;
@@ -81,7 +83,7 @@ SA  fullnameValid   () {
                     }
 SA  fullnameErased  () {
                         for( auto i = 0; i < fullnameSiz_; i++ ){
-                            if( fullnameFlash_[i] != 0xFF ) return false;
+                            if( (u8)fullnameFlash_[i] != 0xFF ) return false;
                         }
                         return true;
                     }
@@ -89,9 +91,9 @@ SA  fullnameErased  () {
                     //returns true if already erased or a page erase was accepted by sd
 SA  sdErasePage     () { 
                         if( fullnameErased() ) return true;
-                        DebugRtt << "Flash::sdErasePage" << endl;
+                        DebugLog(DBG_FLASH, DBG_INFO) << "Flash::sdErasePage" << endl;
                         if( busy_ ){
-                            DebugRtt << "    flash busy" << endl;
+                            DebugLog(DBG_FLASH, DBG_WARN) << "    flash busy" << endl;
                             return false;
                         } 
                         dump();
@@ -103,20 +105,21 @@ SA  sdErasePage     () {
 
                     //returns true if write was accepted by sd
 SA  sdFlashWrite32  (const u32* vals, u16 valsN) { 
-                        DebugRtt << "Flash::sdFlashWrite32" << endl;
+                        DebugLog(DBG_FLASH, DBG_INFO) << "Flash::sdFlashWrite32" << endl;
                         if( busy_ ){
-                            DebugRtt << "    flash busy" << endl;
+                            DebugLog(DBG_FLASH, DBG_WARN) << "    flash busy" << endl;
                             return false;
                         } 
                         u32 err = sd_flash_write((u32*)fullnameFlash_, vals, valsN );
-                        DebugRtt << "    return val: " << err << endl;
+                        DebugLog(DBG_FLASH, DBG_INFO) << "    return val: " << err << endl;
                         if( err != NRF_SUCCESS ) return false;
                         busy_ = true;
                         return true;                       
                     }
 
 SA  saveName        () {
-                        DebugRtt << "Flash::saveName : " << fullnameRam_ << endl; 
+                        ProfileScope ps{ PROF_FLASH_SAVENAME };
+                        DebugLog(DBG_FLASH, DBG_INFO) << "Flash::saveName : " << fullnameRam_ << endl; 
                         if( not nrf_sdh_is_enabled() ) return; //these functions use sd
                         if( not sdErasePage() ) return;
                         //will try again from readName() if write is not accepted by sd
@@ -126,21 +129,21 @@ SA  saveName        () {
     public:
                     //stored flash name to ram, or use default if not set
 SA  init            () {
-                        DebugRtt << "Flash::init..." << endl; 
+                        DebugLog(DBG_FLASH, DBG_INFO) << "Flash::init..." << endl; 
                         if( fullnameValid() ){
                             //copy to ram (include 0 terminator)
                             memcpy( (void*)fullnameRam_, (void*)fullnameFlash_, strlen(fullnameFlash_)+1 );
                         } else {
                             memcpy( (void*)fullnameRam_, (void*)"NoName", strlen("NoName")+1 );
                         }
-                        DebugRtt << "    name: " << fullnameRam_ << endl;
+                        DebugLog(DBG_FLASH, DBG_INFO) << "    name: " << fullnameRam_ << endl;
                     }
 
                     //truncated to 32chars including 0 terminator
                     //but only 15 or 16 can be used as setup in adv
                     //(which will do its own truncation)
 SA  updateName      (const char* str) {
-                        DebugRtt << "Flash::updateName : " << str << endl;
+                        DebugLog(DBG_FLASH, DBG_INFO) << "Flash::updateName : " << str << endl;
                         auto len = strlen(str);
                         if( len > fullnameSiz_-1 ) len = fullnameSiz_-1;
                         memset( (void*)fullnameRam_, 0, fullnameSiz_ ); //clear all
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "nRFconfig.hpp"
+
+#include "nrf_nvic.h"   //sd_nvic_*, softdevice owns the nvic
+
+#include "Gpio.hpp"
+
+#undef SA
+#define SA [[gnu::noinline]] static auto
+
+/*------------------------------------------------------------------------------
+    Gpiote struct - PORT event only (gpio SENSE/DETECT, no GPIOTE channel
+    is used so no high frequency clock is needed while waiting)
+
+    any pin with SENSE set will cause a PORT event when its sense level is
+    seen, each handler added is called on a PORT event and checks its own
+    pin (GpiotePin below does this)
+
+    irq priority is the same as app_timer (6) so handlers do not interrupt
+    timer callbacks (and the other way around)
+------------------------------------------------------------------------------*/
+struct Gpiote {
+
+//============
+    private:
+//============
+
+    SCA         base_       { 0x40006000 };
+    SCA         IRQN_       { 6 };          //GPIOTE_IRQn
+    SCA         IRQPRI_     { 6 };          //APP_IRQ_PRIORITY_LOW
+    SCA         PORT_INT_   { 1u<<31 };     //INTEN.PORT
+    SCA         HANDLERS_MAX{ 4 };
+
+    SI void     (*handlers_[HANDLERS_MAX])(){};
+
+    struct Gpiote_; //forward declare register struct, at end
+
+//============
+    public:
+//============
+
+    //give public access to registers
+    static inline volatile Gpiote_&
+    reg { *(reinterpret_cast<Gpiote_*>(base_)) };
+
+                    //add a PORT event handler (enables irq on first one)
+                    //false if no room
+SA  portAdd         (void(*cb)()) -> bool {
+                        for( auto& h : handlers_ ) if( h == cb ) return true;
+                        for( auto& h : handlers_ ){
+                            if( h ) continue;
+                            h = cb;
+                            reg.EVENTS_PORT = 0;
+                            reg.INTENSET = PORT_INT_;
+                            sd_nvic_SetPriority( (IRQn_Type)IRQN_, IRQPRI_ );
+                            sd_nvic_EnableIRQ( (IRQn_Type)IRQN_ );
+                            return true;
+                        }
+                        return false;
+                    }
+
+                    //remove handler (disables irq when none left)
+SA  portRemove      (void(*cb)()) {
+                        auto n = 0;
+                        for( auto& h : handlers_ ){
+                            if( h == cb ) h = nullptr;
+                            if( h ) n++;
+                        }
+                        if( n ) return;
+                        reg.INTENCLR = PORT_INT_;
+                        sd_nvic_DisableIRQ( (IRQn_Type)IRQN_ );
+                    }
+
+                    //from GPIOTE_IRQHandler
+SA  isr             () {
+                        if( not reg.EVENTS_PORT ) return;
+                        reg.EVENTS_PORT = 0;
+                        (void)reg.EVENTS_PORT; //flush write before return
+                        for( auto& h : handlers_ ) if( h ) h();
+                    }
+
+//============
+    private:
+//============
+
+//------------
+//  registers
+//------------
+
+    struct Gpiote_ {
+                u32 TASKS_OUT[8];           //0x000
+                u32 unused1[(0x030-0x020)/4];
+                u32 TASKS_SET[8];           //0x030
+                u32 unused2[(0x060-0x050)/4];
+                u32 TASKS_CLR[8];           //0x060
+                u32 unused3[(0x100-0x080)/4];
+                u32 EVENTS_IN[8];           //0x100
+                u32 unused4[(0x17C-0x120)/4];
+                u32 EVENTS_PORT;            //0x17C
+                u32 unused5[(0x304-0x180)/4];
+                u32 INTENSET;               //0x304
+                u32 INTENCLR;               //0x308
+                u32 unused6[(0x510-0x30C)/4];
+                u32 CONFIG[8];              //0x510
+    };
+
+};
+
+//only 1 translation unit (main.cpp), so can define the irq handler here
+//(the dongle links nrfx_gpiote.c, which has its own GPIOTE_IRQHandler)
+#ifdef NRF52810_BL651_TEMP
+extern "C" void GPIOTE_IRQHandler(void) { Gpiote::isr(); }
+#endif
+
+
+/*------------------------------------------------------------------------------
+    GpiotePin - a pin that calls a function when it reaches its sense
+    level, Pin_ = Gpio<...>, Sense_ = SENSELO/SENSEHI
+
+    on(cb)  pin input w/pullup (SENSELO) or pulldown (SENSEHI), sense on,
+            cb from the gpiote irq when the pin is at the sense level
+    off()   sense off, pin back to default (disconnected), so nothing is
+            pulled into an unpowered ic
+
+    the PORT event is the rising edge of DETECT (the or of all pins with
+    sense on), so cb is called once when the pin reaches its level, the
+    source needs to release the pin before there is another event
+------------------------------------------------------------------------------*/
+template<typename Pin_, SENSE Sense_ = SENSELO>
+struct GpiotePin {
+
+//============
+    private:
+//============
+
+    SI void (*cb_)(){ nullptr };
+
+SA  check_          () {
+                        if( Sense_ == SENSELO ? Pin_::isHigh() : Pin_::isLow() ) return;
+                        if( cb_ ) cb_();
+                    }
+
+//============
+    public:
+//============
+
+SA  on              (void(*cb)()) -> bool {
+                        cb_ = cb;
+                        Pin_::init( INPUT, Sense_ == SENSELO ? PULLUP : PULLDOWN, Sense_ );
+                        return Gpiote::portAdd( check_ );
+                    }
+
+SA  off             () {
+                        Gpiote::portRemove( check_ );
+                        Pin_::init(); //default, disconnected input, sense off
+                        cb_ = nullptr;
+                    }
+
+SA  isActive        () { return Sense_ == SENSELO ? Pin_::isLow() : Pin_::isHigh(); }
+
+};
+
+#undef SA
+#define SA static auto
@@ -17,13 +17,14 @@
 struct Power {
 
 SA  init        () {
-                    DebugRtt << "Power::init..." << endl;                
+                    DebugLog(DBG_POWER, DBG_INFO) << "Power::init..." << endl;                
                     error.check( nrf_pwr_mgmt_init() );
                     //enable REG1 Dc-Dc (instead of LDO, for 1.8v system)
                     nrf_power_dcdcen_set( true );
                 }
 SA  sleep       () { 
-                    DebugFuncHeader();
+                    DebugLogHeader(DBG_POWER, DBG_TRACE);
+                    DebugRtt.flush(); //send any queued debug output
                     nrf_pwr_mgmt_run(); 
                 } 
 SA  loop        () {
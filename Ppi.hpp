@@ -0,0 +1,176 @@
+#pragma once
+
+#include "nRFconfig.hpp"
+
+#include "nrf_soc.h"    //sd_ppi_*, NRF_SOC_SD_PPI_CHANNELS_SD_ENABLED_MSK
+#include "nrf_nvic.h"   //sd_nvic_*, softdevice owns the nvic
+
+/*------------------------------------------------------------------------------
+    Ppi - programmable channel allocator, the softdevice reserves channels
+    (NRF_SOC_SD_PPI_CHANNELS_SD_ENABLED_MSK, 17-19 on S112/S140) and owns
+    the PPI registers, so channels are only set through sd_ppi_*
+
+    auto ch = Ppi::connect( Gpiote::reg.EVENTS_PORT, twi::reg.TASKS.STARTTX );
+    Ppi::enable( ch );
+    ...
+    Ppi::free( ch ); //disable, back to the pool
+
+    connect/alloc return -1 when none left
+------------------------------------------------------------------------------*/
+struct Ppi {
+
+//============
+    private:
+//============
+
+    SCA         CHANNELS_   { 20 };     //programmable, 20-31 are fixed
+    SCA         APP_MASK_   { compl NRF_SOC_SD_PPI_CHANNELS_SD_ENABLED_MSK bitand ((1u<<CHANNELS_)-1) };
+
+    SI u32      used_       { 0 };
+
+//============
+    public:
+//============
+
+SA  alloc           () -> i8 {
+                        for( i8 ch = 0; ch < CHANNELS_; ch++ ){
+                            u32 bm = 1u<<ch;
+                            if( not (APP_MASK_ bitand bm) or (used_ bitand bm) ) continue;
+                            used_ or_eq bm;
+                            return ch;
+                        }
+                        return -1;
+                    }
+
+SA  free            (i8 ch) {
+                        if( ch < 0 ) return;
+                        sd_ppi_channel_enable_clr( 1u<<ch );
+                        used_ and_eq compl (1u<<ch);
+                    }
+
+                    //event register -> task register
+SA  assign          (i8 ch, volatile u32& evt, volatile u32& task) -> bool {
+                        return ch >= 0 and sd_ppi_channel_assign( ch, &evt, &task ) == 0;
+                    }
+
+                    //alloc + assign (disabled), -1 if none or failed
+SA  connect         (volatile u32& evt, volatile u32& task) -> i8 {
+                        auto ch = alloc();
+                        if( assign(ch, evt, task) ) return ch;
+                        free( ch );
+                        return -1;
+                    }
+
+SA  enable          (i8 ch) { if( ch >= 0 ) sd_ppi_channel_enable_set( 1u<<ch ); }
+SA  disable         (i8 ch) { if( ch >= 0 ) sd_ppi_channel_enable_clr( 1u<<ch ); }
+
+SA  available       () -> u8 { return __builtin_popcount( APP_MASK_ bitand compl used_ ); }
+
+};
+
+
+/*------------------------------------------------------------------------------
+    PpiCounter - TIMER1 in counter mode, counts an event through a PPI
+    channel (count() is the task), irq (priority 6) when it reaches n, then
+    starts over, so the cpu only wakes every n events
+
+    PpiCounter::start( n, cb );
+    auto ch = Ppi::connect( twi::reg.EVENTS.STOPPED, PpiCounter::count() );
+
+    counter mode only needs a clock when counting, TIMER2 is Deadline
+------------------------------------------------------------------------------*/
+struct PpiCounter {
+
+//============
+    private:
+//============
+
+    SCA         base_       { 0x40009000 }; //TIMER1
+    SCA         IRQN_       { 9 };          //TIMER1_IRQn
+    SCA         IRQPRI_     { 6 };          //APP_IRQ_PRIORITY_LOW
+    SCA         COMPARE0_   { 1u<<16 };     //INTEN.COMPARE0
+
+    SI void     (*cb_)(){ nullptr };
+
+    struct Timer_; //forward declare register struct, at end
+
+//============
+    public:
+//============
+
+    //give public access to registers
+    static inline volatile Timer_&
+    reg { *(reinterpret_cast<Timer_*>(base_)) };
+
+                    //PPI task
+SA  count           () -> volatile u32& { return reg.TASKS_COUNT; }
+SA  value           () -> u32 { reg.TASKS_CAPTURE[1] = 1; return reg.CC[1]; }
+
+SA  start           (u32 n, void(*cb)()) {
+                        reg.TASKS_STOP = 1;
+                        cb_ = cb;
+                        reg.MODE = 2;           //low power counter
+                        reg.BITMODE = 3;        //32bit
+                        reg.CC[0] = n ? n : 1;
+                        reg.SHORTS = 1<<0;      //COMPARE0_CLEAR
+                        reg.EVENTS_COMPARE[0] = 0;
+                        reg.TASKS_CLEAR = 1;
+                        reg.INTENSET = COMPARE0_;
+                        sd_nvic_ClearPendingIRQ( (IRQn_Type)IRQN_ );
+                        sd_nvic_SetPriority( (IRQn_Type)IRQN_, IRQPRI_ );
+                        sd_nvic_EnableIRQ( (IRQn_Type)IRQN_ );
+                        reg.TASKS_START = 1;
+                    }
+
+SA  stop            () {
+                        reg.TASKS_STOP = 1;
+                        reg.INTENCLR = COMPARE0_;
+                        sd_nvic_DisableIRQ( (IRQn_Type)IRQN_ );
+                        reg.EVENTS_COMPARE[0] = 0;
+                        cb_ = nullptr;
+                    }
+
+                    //from TIMER1_IRQHandler
+SA  isr             () {
+                        if( not reg.EVENTS_COMPARE[0] ) return;
+                        reg.EVENTS_COMPARE[0] = 0;
+                        (void)reg.EVENTS_COMPARE[0]; //flush write before return
+                        if( cb_ ) cb_();
+                    }
+
+//============
+    private:
+//============
+
+//------------
+//  registers
+//------------
+
+    struct Timer_ {
+                u32 TASKS_START;            //0x000
+                u32 TASKS_STOP;             //0x004
+                u32 TASKS_COUNT;            //0x008
+                u32 TASKS_CLEAR;            //0x00C
+                u32 TASKS_SHUTDOWN;         //0x010
+                u32 unused1[(0x040-0x014)/4];
+                u32 TASKS_CAPTURE[6];       //0x040
+                u32 unused2[(0x140-0x058)/4];
+                u32 EVENTS_COMPARE[6];      //0x140
+                u32 unused3[(0x200-0x158)/4];
+                u32 SHORTS;                 //0x200
+                u32 unused4[(0x304-0x204)/4];
+                u32 INTENSET;               //0x304
+                u32 INTENCLR;               //0x308
+                u32 unused5[(0x504-0x30C)/4];
+                u32 MODE;                   //0x504
+                u32 BITMODE;                //0x508
+                u32 unused6;
+                u32 PRESCALER;              //0x510
+                u32 unused7[(0x540-0x514)/4];
+                u32 CC[6];                  //0x540
+    };
+
+};
+
+//only 1 translation unit (main.cpp), so can define the irq handler here
+extern "C" void TIMER1_IRQHandler(void) { PpiCounter::isr(); }
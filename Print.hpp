@@ -45,28 +45,56 @@ using   i64 = int64_t;
 #define FMT_BUFMAX_ 34  //32bit bin w/showbase is 34 chars
 #endif
 /*-------------------------------------------------------------
-    Format
+    FormatT<Derived>, Format
 
     simple class to inherit for cout style 'printing'
-    via virtual put function which has a signature of-
+
+    FormatT is a CRTP base, the device class passes itself as the
+    template argument and provides a put function which has a signature of-
 
         bool put(const char)
         write return value is false if there is an error
 
-    all data goes directly out to the device put function,
+    and optionally a write function for a block of chars-
+
+        unsigned write(const char*, unsigned)
+        return value is the number of chars written
+
+    strings, numbers and fill chars are sent out as blocks via write,
+    if the device does not provide its own write the default will
+    send the block 1 char at a time through put
+
+    all data goes directly out to the device put/write function,
     if any buffering wanted it has to be done in the device
     class that inherits this
 
+    calls to put/write resolve at compile time, so the device functions
+    can inline into the conversion functions and there is no vtable
+
+        struct MyDev : FormatT<MyDev> {
+            bool put(const char c){ ... }
+        };
+
+    Format is the type-erased version (virtual put/write), for when a
+    single Format& is wanted for different devices-
+
+        struct MyDev : Format {
+            virtual bool put(const char c){ ... }
+        };
+
     documentation-
 
     examples-
 
 --------------------------------------------------------------*/
-class Format {
+template<typename Derived_>
+class FormatT {
 
-//change function attributes for functions that return Format&
-#define self    [[ gnu::noinline ]] Format
-//#define self  Format  //no attributes
+//change function attributes for functions that return Derived_&
+//the option functions are small so can inline, the conversion functions
+//are kept out of line so each use does not get its own copy
+#define self    Derived_
+#define selfNI  [[ gnu::noinline ]] Derived_
 
 //-------------|
     public:
@@ -94,7 +122,7 @@ errors          (){ return errors_; }
                 //(first char in NL_ is always used, second char only if not 0)
                 self&
 newline         (const char a, const char b = 0)
-                { NL_[0] = a; NL_[1] = b; return *this; }
+                { NL_[0] = a; NL_[1] = b; return derived_(); }
 
                 // reset options,  << reset
                 self&
@@ -114,18 +142,18 @@ reset           ()
                 optionBA_ = false;
                 optionJL_ = false;
                 optionUC_ = false;
-                return *this;
+                return derived_();
                 }
 
                 // << setw(n) - minumum width, n limited to sane value via OPTIONWMIN_MAX
                 self&
 width           (const int v)
-                { optionWMIN_ = v > OPTIONWMIN_MAX ? OPTIONWMIN_MAX : v; return *this; }
+                { optionWMIN_ = v > OPTIONWMIN_MAX ? OPTIONWMIN_MAX : v; return derived_(); }
 
                 // << setwmax(40) - maximum width (truncate output)
                 self&
 widthmax        (const unsigned int v)
-                { optionWMAX_ = v; return *this; }
+                { optionWMAX_ = v; return derived_(); }
 
                 // << bin|oct|dec|hex
                 // base is max of 16, as the hex table is only 0-F
@@ -136,118 +164,82 @@ base            (const int v)
                 else optionB_ = v bitand 10;//-> base 2,8,10
                 //if 1,4,5 sneaked in, switch resulting 0 to base 10
                 if( not optionB_ ) optionB_ = 10;
-                return *this;
+                return derived_();
                 }
 
             #if FMT_DOUBLE_ || FMT_FLOAT_
                 // << setprecision(n)
                 self&
 precision       (const int v)
-                { optionPRE_ = v > FMT_PREMAX_ ? FMT_PREMAX_ : v; return *this; }
+                { optionPRE_ = v > FMT_PREMAX_ ? FMT_PREMAX_ : v; return derived_(); }
             #endif
 
                 // << setfill('char') (default value is ' ', unset is also ' ')
                 self&
 fill            (const char c = ' ')
-                { optionFIL_ = c; return *this; }
+                { optionFIL_ = c; return derived_(); }
 
                 // << noshowpos , << showpos , + for dec base values
                 self&
 positive        (const bool tf)
-                { optionPOS_ = tf; return *this; }
+                { optionPOS_ = tf; return derived_(); }
 
                 // << noshowalpha , << showalpha , bool "true"/"false or 1 0
                 self&
 boolalpha       (const bool tf)
-                { optionBA_ = tf; return *this; }
+                { optionBA_ = tf; return derived_(); }
 
                 // << left, << right , justify output left/right if min width > output
                 self&
 justify         (const bool tf)
-                { optionJL_ = tf; return *this; }
+                { optionJL_ = tf; return derived_(); }
 
                 // << uppercase, << nouppercase , for hex only (A-F/a-f)
                 self&
 uppercase       (const bool tf)
-                { optionUC_ = tf; return *this; }
+                { optionUC_ = tf; return derived_(); }
 
                 // << showbase, << noshowbase , 0x 0b 0 (for oct if value not 0)
                 self&
 showbase        (const bool tf)
-                { optionSB_ = tf; return *this; }
+                { optionSB_ = tf; return derived_(); }
 
                 // << endl , newline as set in NL_
                 self&
 newline         ()
                 { //if NL_[0] was set to \0, will get it
-                put_( NL_[0] );
-                if( NL_[1] ) put_( NL_[1] ); 
-                return *this; 
+                write_( NL_, NL_[1] ? 2 : 1 );
+                return derived_(); 
                 }
 
+                //send any buffered output, nothing to do unless the
+                //device buffers (device provides its own flush)
+                void
+flush           (){}
+
 
                 //string
                 self&
 operator<<      (const char* str)
                 {
-                auto w = optionWMIN_;
-                auto wmax = optionWMAX_;                    //if 0, first --wmax will make it 0xFFFF (effectively no max limit)
-                auto fc = optionFIL_ ? optionFIL_ : ' ';    //if 0, is ' '
-                u32 i = w ? __builtin_strlen( str ) : 0;    //if w set, need str length
-                auto fill = [&]{ while( (w-- > i) and --wmax ) put_( fc ); }; //lambda
-                if( not optionJL_ ) fill();                 //justify right, fill first
-                while( *str and --wmax ) put_( *str++ );  //srite str
-                if( optionJL_ ) fill();                     //justify left, fill last
+                derived_().text_( str );
                 optionWMIN_ = 0;                            //setw always cleared after use
-                return *this;
+                return derived_();
                 }
 
                 //u64 (or u32 if no u64 support wanted)
                 self&
 operator<<      (const FMT_U64_ vu) //is u64 or u32
                 {
-                FMT_U64_ v = vu;
-                auto div = optionB_; //2,8,10,16 (already limited to only these values)
-                auto w = optionWMIN_;
-                auto fc = optionFIL_ ? optionFIL_ : ' ';  //0 is ' '
-                auto sb = (div == 8 and vu == 0) ? false : optionSB_; //oct 0 does not need showbase
-                u32 i = 0; //buf index
-                char buf[w > FMT_BUFMAX_ ? w : FMT_BUFMAX_]; //64bit binary with showbase uses 66 chars, 32bit 34
-                if( v == 0 ) buf[i++] = '0'; //if 0, add '0' as below loop will be skipped
-                //convert number
-                while( v ){
-                    auto c = hexTable[v % div];
-                    if( c >= 'a' and optionUC_ ) c and_eq compl (1<<5); //to uppercase if hex/uppercase
-                    buf[i++] = c;
-                    v /= div;
-                    }
-                //lambda functions
-                auto fill = [&](){ while( i < w ) buf[i++] = fc; };
-                auto xtras = [&](){
-                    if( div == 10 ) {                           //dec
-                        if( optionNEG_ ) buf[i++] = '-';        //negative
-                        else if( optionPOS_ ) buf[i++] = '+';   //positive and + wanted
-                        }
-                    else if( sb ){ // 2,8,16, showbase
-                        if( div == 16 ) buf[i++] = 'x';
-                        else if( div == 2 ) buf[i++] = 'b';
-                        buf[i++] = '0';
-                        }
-                };
-                //add -, 0b, 0x, 0, now if optionFIL_ is not '0'
-                //else add fill first
-                //(remember this is a reverse buffer)
-                if( fc == '0' ){ fill(); xtras(); } else { xtras(); fill(); }
-                //i is 1 past our last char, i will be at least 1
-                while( i ) put_( buf[--i] );
+                derived_().number_( vu );
                 optionNEG_ = false; //always clear after use
                 optionWMIN_ = 0; //always clear after use
-                return *this;
+                return derived_();
                 }
 
             #if FMT_DOUBLE_ || FMT_FLOAT_
                 //double or float
-                self&
+                selfNI&
 operator<<      (const FMT_FLOAT_TYPE_ d)
                 {
                 FMT_FLOAT_TYPE_ f = d;
@@ -277,7 +269,7 @@ operator<<      (const FMT_FLOAT_TYPE_ d)
                     optionPOS_ = sp;                    
                     }
                 optionB_ = b;                       //back to original base
-                return *this;
+                return derived_();
                 }  
             #endif //FMT_DOUBLE_ || FMT_FLOAT_
 
@@ -292,7 +284,7 @@ operator<<      (const FMT_I64_ v)
                 {
                 if( v >= 0 or optionB_ != 10 ) return operator<<( (FMT_U64_)v );
                 optionNEG_ = true;
-                return operator<<( (FMT_U64_)-v );
+                return operator<<( 0 - (FMT_U64_)v ); //no overflow for the most negative
                 }
 
 
@@ -312,7 +304,7 @@ operator<<      (const i8 v) { return operator<<( (FMT_I64_)v ); }
                 self&
 operator<<      (const u8 vu) { return operator<<( (FMT_U64_)vu ); }
                 self&
-operator<<      (const char v) { put_( v bitand 0xFF ); return *this; }
+operator<<      (const char v) { put_( v bitand 0xFF ); return derived_(); }
                 self&
 operator<<      (const bool v)
                 {
@@ -321,21 +313,148 @@ operator<<      (const bool v)
                 }
 
 //-------------|
-    private:
+    protected:
 //-------------|
 
-                //parent class has the put function
-                virtual bool 
-put             (const char) = 0;
+                //string to text, a derived class can provide its own text_
+                [[ gnu::noinline ]] void
+text_           (const char* str)
+                {
+                auto w = optionWMIN_;
+                auto wmax = optionWMAX_;                    //if 0, first --wmax will make it 0xFFFF (effectively no max limit)
+                auto fc = optionFIL_ ? optionFIL_ : ' ';    //if 0, is ' '
+                u32 i = w ? __builtin_strlen( str ) : 0;    //if w set, need str length
+                auto fill = [&]{                            //lambda
+                    u32 n = 0;
+                    while( (w-- > i) and --wmax ) n++;      //count fill chars
+                    fill_( fc, n );
+                };
+                if( not optionJL_ ) fill();                 //justify right, fill first
+                u32 n = 0;
+                while( str[n] and --wmax ) n++;             //count str chars
+                write_( str, n );                           //write str
+                if( optionJL_ ) fill();                     //justify left, fill last
+                }
+
+                //u64 (or u32) to text, a derived class can provide its own number_
+                //(options are cleared by the caller)
+                [[ gnu::noinline ]] void
+number_         (const FMT_U64_ vu) //is u64 or u32
+                {
+                FMT_U64_ v = vu;
+                auto div = optionB_; //2,8,10,16 (already limited to only these values)
+                auto w = optionWMIN_;
+                auto fc = optionFIL_ ? optionFIL_ : ' ';  //0 is ' '
+                auto sb = (div == 8 and vu == 0) ? false : optionSB_; //oct 0 does not need showbase
+                //64bit binary with showbase uses 66 chars, 32bit 34
+                //(+2 so a fill to w followed by 0x/0b still fits)
+                char buf[w+2 > FMT_BUFMAX_ ? w+2 : FMT_BUFMAX_];
+                char* const end = &buf[sizeof buf];
+                char* p = end; //filled from the end, p is first char
+                //convert number, no division by a runtime base-
+                //dec is 2 digits at a time (/100 is a multiply), 
+                //bin/oct/hex are shift/mask
+                if( div == 10 ){
+                    while( v >= 100 ){
+                        FMT_U64_ q = div100_( v );
+                        auto r = (u32)(v - q*100) * 2;
+                        *--p = decTable[r+1];
+                        *--p = decTable[r];
+                        v = q;
+                        }
+                    if( v >= 10 ){ *--p = decTable[v*2+1]; *--p = decTable[v*2]; }
+                    else *--p = '0' + v; //also takes care of 0
+                    }
+                else {
+                    auto sh = div == 16 ? 4 : div == 8 ? 3 : 1;
+                    auto tbl = optionUC_ ? hexTableUC : hexTable; //uppercase if hex/uppercase
+                    do{ *--p = tbl[v bitand (div-1)]; v >>= sh; } while( v ); //0 gets '0'
+                    }
+                //lambda functions
+                auto fill = [&](){ while( end - p < w ) *--p = fc; };
+                auto xtras = [&](){
+                    if( div == 10 ) {                           //dec
+                        if( optionNEG_ ) *--p = '-';            //negative
+                        else if( optionPOS_ ) *--p = '+';       //positive and + wanted
+                        }
+                    else if( sb ){ // 2,8,16, showbase
+                        if( div == 16 ) *--p = 'x';
+                        else if( div == 2 ) *--p = 'b';
+                        *--p = '0';
+                        }
+                };
+                //add -, 0b, 0x, 0, now if optionFIL_ is not '0'
+                //else add fill first
+                //(remember this is a reverse buffer)
+                if( fc == '0' ){ fill(); xtras(); } else { xtras(); fill(); }
+                //p is our first char, will be at least 1 char
+                write_( p, end - p );
+                }
+
+                //the derived class (device)
+                auto&
+derived_        () { return static_cast<Derived_&>(*this); }
+
+                //derived class has the put function
+                //derived class can also provide a block write, returns number
+                //of chars written (default is to put 1 char at a time)
+                unsigned
+write           (const char* buf, unsigned len)
+                {
+                unsigned n = 0;
+                for( unsigned i = 0; i < len; i++ ) if( derived_().put(buf[i]) ) n++;
+                return n;
+                }
 
                 //helper put, so we can also inc count for each char written
                 //and count errors (whatever an error may be)
                 void
 put_            (const char c)
-                { if( put(c) ) count_++; else errors_++; }
+                { if( derived_().put(c) ) count_++; else errors_++; }
+
+                //helper write, same as put_ but for a block of chars
+                void
+write_          (const char* buf, unsigned len)
+                {
+                if( not len ) return;
+                auto n = derived_().write( buf, len );
+                count_ += n;
+                errors_ += len - n;
+                }
+
+                //fill char n times, written in blocks
+                void
+fill_           (const char c, u32 n)
+                {
+                char buf[16];
+                __builtin_memset( buf, c, sizeof buf );
+                while( n ){
+                    auto w = n > sizeof buf ? sizeof buf : n;
+                    write_( buf, w );
+                    n -= w;
+                    }
+                }
 
 
                 static constexpr char hexTable[]{ "0123456789abcdef" };
+                static constexpr char hexTableUC[]{ "0123456789ABCDEF" };
+                //00-99 pairs
+                static constexpr char decTable[]{
+                    "0001020304050607080910111213141516171819"
+                    "2021222324252627282930313233343536373839"
+                    "4041424344454647484950515253545556575859"
+                    "6061626364656667686970717273747576777879"
+                    "8081828384858687888990919293949596979899" };
+
+                //v/100
+            #if FMT_USE_U64_
+                static FMT_U64_
+div100_         (const FMT_U64_ v) { return v / 100; } //let compiler deal with it
+            #else
+                //multiply by reciprocal (2^37/100), exact for all u32 values
+                static u32
+div100_         (const u32 v) { return ((uint64_t)v * 0x51EB851F) >> 37; }
+            #endif
                 static constexpr auto OPTIONWMIN_MAX{ 128 }; //maximum value of optionWMIN_
 
                 char NL_[3]     {"\r\n"};   //newline combo, can be changed at runtime
@@ -356,6 +475,7 @@ put_            (const char c)
                 bool optionJL_  { false };  //(justify) left/right
  
         #undef self
+        #undef selfNI
         #undef FMT_U64_
         #undef FMT_I64_
         #undef FMT_BUFMAX_
@@ -364,6 +484,34 @@ put_            (const char c)
 
 };
 
+/*-------------------------------------------------------------
+    Format - type-erased FormatT, device provides virtual put
+    (and optionally a virtual write)
+--------------------------------------------------------------*/
+class Format : public FormatT<Format> {
+
+    friend FormatT<Format>;
+
+//-------------|
+    private:
+//-------------|
+
+                //parent class has the put function
+                virtual bool 
+put             (const char) = 0;
+
+                //parent class can override with a block write, returns number
+                //of chars written (default is to put 1 char at a time)
+                virtual unsigned
+write           (const char* buf, unsigned len)
+                {
+                unsigned n = 0;
+                for( unsigned i = 0; i < len; i++ ) if( put(buf[i]) ) n++;
+                return n;
+                }
+
+};
+
 
 /*-------------------------------------------------------------
     Format helpers for << put in a fmt namespace
@@ -411,30 +559,34 @@ namespace fmt {
                 struct Setw_fmt { int n; };
                 inline Setw_fmt
 setw            (int n) { return {n}; }
-                inline Format&
-                operator<<(Format& p, Setw_fmt s)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, Setw_fmt s)
                 { return p.width(s.n); }
 
                 struct SetwMax_fmt { int n; };
                 inline SetwMax_fmt
 setwmax         (int n) { return {n}; }
-                inline Format&
-                operator<<(Format& p, SetwMax_fmt s)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, SetwMax_fmt s)
                 { return p.widthmax(s.n); }
 
                 struct Setfill_fmt { char c; };
                 inline Setfill_fmt
 setfill         (char c = ' ') { return {c}; }
-                inline Format&
-                operator<<(Format& p, Setfill_fmt s)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, Setfill_fmt s)
                 { return p.fill(s.c); }
 
             #if FMT_DOUBLE_ || FMT_FLOAT_
                 struct Setprecision_fmt { int n; };
                 inline Setprecision_fmt
 setprecision    (int n) { return {n}; }
-                inline Format&
-                operator<<(Format& p, Setprecision_fmt s)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, Setprecision_fmt s)
                 { return p.precision(s.n); }
             #endif
             #undef FMT_DOUBLE_ //done with these defines
@@ -444,8 +596,9 @@ setprecision    (int n) { return {n}; }
 
                 enum ENDL_fmt {
 endl            };
-                inline Format&
-                operator<<(Format& p, ENDL_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, ENDL_fmt e)
                 { (void)e; return p.newline(); }
 
                 enum BASE_fmt {
@@ -453,49 +606,56 @@ bin             = 2,
 oct             = 8,
 dec             = 10,
 hex             = 16 };
-                inline Format&
-                operator<<(Format& p, BASE_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, BASE_fmt e)
                 { return p.base(e); }
 
                 enum RESET_fmt {
 reset           };
-                inline Format&
-                operator<<(Format& p, RESET_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, RESET_fmt e)
                 { (void)e; return p.reset(); }
 
                 enum POSITIVE_fmt {
 noshowpos,
 showpos         };
-                inline Format&
-                operator<<(Format& p, POSITIVE_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, POSITIVE_fmt e)
                 { return p.positive(e); }
 
                 enum ALPHA_fmt {
 noshowalpha,
 showalpha       };
-                inline Format&
-                operator<<(Format& p, ALPHA_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, ALPHA_fmt e)
                 { return p.boolalpha(e); }
 
                 enum JUSTIFY_fmt {
 right,
 left            };
-                inline Format&
-                operator<<(Format& p, JUSTIFY_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, JUSTIFY_fmt e)
                 { return p.justify(e); }
 
                 enum UPPERCASE_fmt {
 nouppercase,
 uppercase       };
-                inline Format&
-                operator<<(Format& p, UPPERCASE_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, UPPERCASE_fmt e)
                 { return p.uppercase(e); }
 
                 enum SHOWBASE_fmt {
 noshowbase,
 showbase        };
-                inline Format&
-                operator<<(Format& p, SHOWBASE_fmt e)
+                template<typename D>
+                inline D&
+                operator<<(FormatT<D>& p, SHOWBASE_fmt e)
                 { return p.showbase(e); }
 
 
@@ -537,37 +697,39 @@ showbase        };
 
 
     using DebuRttT = DevRtt<0>; //debug output wanted
-    // using DebuRttT = NullStreamer; //if want no debug output
+    // using DebuRttT = NullFormat; //if want no debug output
     inline DebuRttT DebugRtt; //uses type specified above
 
     DebugRtt << FG BLUE << "Booting..." << endl; //either outputs, or optimized away
 
 ------------------------------------------------------------------------------*/
-class NullFormat : public Format {
+class NullFormat : public FormatT<NullFormat> {
+
+    friend FormatT<NullFormat>;
 
-                //Format virtual put, 1 char
-                virtual bool //unused, as it is never called
+                //FormatT put, 1 char
+                bool //unused, as it is never called
 put             (const char c) { (void)c; return 0; }
 
 public:
 auto count      (){ return 0; }
 auto errors     (){ return 0; }
-auto newline    (const char a, const char b = 0) { (void)a; (void)b; return *this; }
-auto reset      () { return *this; }
-auto width      (const int v) { (void)v; return *this; }
-auto widthmax   (const unsigned int v) { (void)v; return *this; }
-auto base       (const int v) { (void)v; return *this; }
-auto precision  (const int v) { (void)v; return *this; }
-auto fill       (const char c = ' ') { (void)c; return *this; }
-auto positive   (const bool tf) { (void)tf; return *this; }
-auto boolalpha  (const bool tf) { (void)tf; return *this; }
-auto justifyleft(const bool tf) { (void)tf; return *this; }
-auto uppercase  (const bool tf) { (void)tf; return *this; }
-auto showbase   (const bool tf) { (void)tf; return *this; }
-auto newline    () { return *this; }
+auto& newline   (const char a, const char b = 0) { (void)a; (void)b; return *this; }
+auto& reset     () { return *this; }
+auto& width     (const int v) { (void)v; return *this; }
+auto& widthmax  (const unsigned int v) { (void)v; return *this; }
+auto& base      (const int v) { (void)v; return *this; }
+auto& precision (const int v) { (void)v; return *this; }
+auto& fill      (const char c = ' ') { (void)c; return *this; }
+auto& positive  (const bool tf) { (void)tf; return *this; }
+auto& boolalpha (const bool tf) { (void)tf; return *this; }
+auto& justifyleft(const bool tf) { (void)tf; return *this; }
+auto& uppercase (const bool tf) { (void)tf; return *this; }
+auto& showbase  (const bool tf) { (void)tf; return *this; }
+auto& newline   () { return *this; }
 
                 template<typename T> // << anything
-auto operator<< (T t) { return *this; }                
+auto& operator<<(T t) { return *this; }                
 
 
 };
@@ -590,7 +752,9 @@ auto operator<< (T t) { return *this; }
     bp.clear() << "hello"; // buf = "hello",  0 terminated
 ------------------------------------------------------------------------------*/
 template<unsigned N>
-class BufFormat : public Format {
+class BufFormat : public FormatT<BufFormat<N>> {
+
+    friend FormatT<BufFormat>;
 
 //-------------|
     public:
@@ -613,8 +777,8 @@ operator[]      (int n) { return (n >= 0 and (n < (N-1))) ? buf_[n] : '\0'; }
     private:
 //-------------|
 
-                //Format virtual put, 1 char
-                virtual bool 
+                //FormatT put, 1 char
+                bool 
 put             (const char c)
                 {
                 if( count_ < (N-1) ) {
@@ -625,6 +789,18 @@ put             (const char c)
                 return false;
                 }
 
+                //FormatT write, copy as much as will fit
+                unsigned
+write           (const char* str, unsigned len)
+                {
+                unsigned n = (N-1) - count_;
+                if( len < n ) n = len;
+                __builtin_memcpy( &buf_[count_], str, n );
+                count_ += n;
+                buf_[count_] = 0; //0 terminate
+                return n;
+                }
+
                 char buf_[N+1]; //we add the space for terminating '\0'
                 u16 count_{0};
 
@@ -632,9 +808,9 @@ put             (const char c)
 namespace fmt { 
     
                 //so can  Format << bufFormat  and get the buffer printed out
-                template<unsigned N>
-                inline Format&
-                operator<<(Format& p, BufFormat<N>& b)
+                template<typename D, unsigned N>
+                inline D&
+                operator<<(FormatT<D>& p, BufFormat<N>& b)
                 { return p.operator<<( b.buf() ); }
 
 }
@@ -815,14 +991,15 @@ namespace fmt {
         $ telnet localhost 19021
 ------------------------------------------------------------------------------*/
 template<int N>
-struct DevRtt : public Format {
+struct DevRtt : public FormatT<DevRtt<N>> {
 
-                //Printer virtual put, 1 char
-                [[ gnu::noinline ]] virtual bool 
+                //FormatT put, 1 char
+                bool 
 put             (const char c){ return SEGGER_RTT_Write(N, &c, 1); }
 
-                //specified length (binary data)
-                [[ gnu::noinline ]] unsigned int 
+                //FormatT write, specified length (also binary data)
+                //1 SEGGER_RTT_Write (1 lock) for the whole block
+                unsigned int 
 write           (const char *buf, unsigned len)
                 {
                 return SEGGER_RTT_Write(N, buf, len);
@@ -837,3 +1014,213 @@ write           (const char *buf)
 
 };
 
+
+/*------------------------------------------------------------------------------
+    RTT binary - same use as DevRtt, but output is left for the pc to format
+
+        DevRttBin<0> rtt;
+        rtt << FG BLUE << "count: " << setw(4) << 123u << endl;
+
+    string literals (anything in flash) are sent as their 4 byte address,
+    numbers are sent as raw value + options, so no conversion/ansi text
+    is done on the mcu and the rtt channel sees a fraction of the bytes
+
+    the strings are not copied anywhere- the .elf already has them in the
+    .rodata it loads into flash, so the decoder reads them from there
+    (so use the .elf that matches the running firmware)
+
+        $ g++ -O2 -std=c++17 -o rttdecode tools/rttdecode.cpp
+        $ telnet localhost 19021 | ./rttdecode _build/nrf52810_xxaa.out
+
+    records (little endian, 1 SEGGER_RTT_Write per record)-
+        STR  [1][addr u32]                          string in flash
+        CHR  [2][char]                              single char
+        TXT  [3][len u8][chars...]                  ram string, fill, width limited
+        NUM  [4][flags][width][fill][value u32/u64] number
+            flags bit0-1 base 0=2,1=8,2=10,3=16, bit2 uppercase, bit3 showbase
+                  bit4 negative, bit5 showpos, bit7 value is u64
+
+    count() does not include strings/numbers sent as records (the length is
+    not known on the mcu)
+------------------------------------------------------------------------------*/
+extern "C" const char __etext[]; //end of flash code/rodata (linker script)
+
+template<int N>
+struct DevRttBin : public FormatT<DevRttBin<N>> {
+
+                using base_ = FormatT<DevRttBin<N>>;
+                friend base_;
+
+                enum : uint8_t { STR = 1, CHR, TXT, NUM };
+
+                //FormatT put, 1 char
+                bool 
+put             (const char c)
+                {
+                const char r[2]{ CHR, c };
+                return SEGGER_RTT_Write(N, r, sizeof r) == sizeof r;
+                }
+
+                //FormatT write, specified length, split into TXT records
+                unsigned int 
+write           (const char *buf, unsigned len)
+                {
+                char r[2+64];
+                unsigned n = 0;
+                while( n < len ){
+                    auto w = len - n > 64 ? 64 : len - n;
+                    r[0] = TXT; r[1] = w;
+                    __builtin_memcpy( &r[2], &buf[n], w );
+                    if( SEGGER_RTT_Write(N, r, w+2) != w+2 ) break;
+                    n += w;
+                    }
+                return n;
+                }
+
+//-------------|
+    private:
+//-------------|
+
+                //FormatT string, flash strings with no width options are
+                //sent as an address, all others are formatted as text
+                void
+text_           (const char* str)
+                {
+                if( this->optionWMIN_ or this->optionWMAX_ or str >= __etext ){
+                    base_::text_( str );
+                    return;
+                    }
+                auto a = (uint32_t)(uintptr_t)str;
+                const char r[5]{ STR, (char)a, (char)(a>>8), (char)(a>>16), (char)(a>>24) };
+                if( SEGGER_RTT_Write(N, r, sizeof r) != sizeof r ) this->errors_++;
+                }
+
+                //FormatT number, value and options, 4 bytes if value fits
+                template<typename T> void
+number_         (const T vu)
+                {
+                auto b = this->optionB_;
+                uint8_t f = b == 2 ? 0 : b == 8 ? 1 : b == 10 ? 2 : 3;
+                if( this->optionUC_ ) f |= 1<<2;
+                if( this->optionSB_ ) f |= 1<<3;
+                if( this->optionNEG_ ) f |= 1<<4;
+                if( this->optionPOS_ ) f |= 1<<5;
+                auto v = (uint64_t)vu;
+                unsigned vn = v > 0xFFFFFFFF ? 8 : 4;
+                if( vn == 8 ) f |= 1<<7;
+                char r[4+8]{ NUM, (char)f, (char)this->optionWMIN_, this->optionFIL_ };
+                for( unsigned i = 0; i < vn; i++, v >>= 8 ) r[4+i] = v;
+                if( SEGGER_RTT_Write(N, r, 4+vn) != 4+vn ) this->errors_++;
+                }
+
+};
+
+
+/*------------------------------------------------------------------------------
+    RTT queue - same use as DevRtt, but output goes to a ram ring buffer
+    and is sent to RTT later by flush() (from thread mode, Power::sleep)
+
+        DevRttQueue<0, 1024> rtt; //size must be a power of 2
+
+    writers can be thread mode and any irq priority- space is reserved with
+    a cas on reserve_, then the chars are copied, the last writer out (nest_
+    back to 0) moves commit_ up so flush can see all completed writes
+    (a lower priority writer that is interrupted is always done before the
+    nest count gets back to 0, so anything below reserve_ is complete)
+
+    if a write does not fit it is dropped (not split), the dropped char
+    count is reported in the output by the next flush
+
+    flush only sends what the RTT buffer has room for, so never blocks
+    even when RTT is in blocking mode and no debugger is reading
+
+    the format options are shared by all writers, so an irq that changes
+    options in the middle of a thread mode << chain will affect it
+------------------------------------------------------------------------------*/
+template<int N, unsigned Siz_ = 512>
+struct DevRttQueue : public FormatT<DevRttQueue<N, Siz_>> {
+
+                static_assert( Siz_ and (Siz_ bitand (Siz_-1)) == 0, "Siz_ must be a power of 2" );
+
+                //FormatT put, 1 char
+                bool 
+put             (const char c){ return write( &c, 1 ) == 1; }
+
+                //FormatT write, all or nothing
+                unsigned int 
+write           (const char *buf, unsigned len)
+                {
+                if( len > Siz_ ){ dropped_add_( len ); return 0; }
+                __atomic_add_fetch( &nest_, 1, __ATOMIC_ACQUIRE );
+                u32 r = __atomic_load_n( &reserve_, __ATOMIC_RELAXED );
+                bool ok;
+                do{ //tail_ only moves up, a stale value just means less room
+                    ok = r + len - __atomic_load_n( &tail_, __ATOMIC_ACQUIRE ) <= Siz_;
+                    if( not ok ) break;
+                    } while( not __atomic_compare_exchange_n(&reserve_, &r, r + len, true, 
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED) );
+                if( ok ){
+                    auto i = r bitand (Siz_-1);
+                    auto n = Siz_ - i < len ? Siz_ - i : len; //to end of buffer
+                    __builtin_memcpy( &buf_[i], buf, n );
+                    __builtin_memcpy( &buf_[0], &buf[n], len - n ); //any wrap
+                    }
+                else dropped_add_( len );
+                if( __atomic_sub_fetch(&nest_, 1, __ATOMIC_RELEASE) == 0 ){
+                    //an irq can get in after nest_ is 0 and move commit_ further,
+                    //so repeat until reserve_ is unchanged (commit_ ends up current)
+                    u32 h;
+                    do{ h = __atomic_load_n( &reserve_, __ATOMIC_ACQUIRE );
+                        __atomic_store_n( &commit_, h, __ATOMIC_RELEASE );
+                        } while( h != __atomic_load_n(&reserve_, __ATOMIC_ACQUIRE) );
+                    }
+                return ok ? len : 0;
+                }
+
+                //send committed chars to RTT, thread mode only
+                void
+flush           ()
+                {
+                u32 c = __atomic_load_n( &commit_, __ATOMIC_ACQUIRE );
+                while( c != tail_ ){
+                    auto i = tail_ bitand (Siz_-1);
+                    u32 n = c - tail_;
+                    if( n > Siz_ - i ) n = Siz_ - i; //to end of buffer
+                    u32 avail = SEGGER_RTT_GetAvailWriteSpace(N);
+                    if( n > avail ) n = avail;
+                    if( n == 0 ) break; //rtt full, try again next time
+                    n = SEGGER_RTT_Write( N, &buf_[i], n );
+                    __atomic_store_n( &tail_, tail_ + n, __ATOMIC_RELEASE );
+                    }
+                auto d = __atomic_load_n( &dropped_, __ATOMIC_RELAXED );
+                if( d and c == tail_ ){ //after queued output, moves to drop_ once sent
+                    BufFormat<28> b;
+                    b << "\r\n[dropped " << d << "]\r\n";
+                    if( SEGGER_RTT_GetAvailWriteSpace(N) >= b.length() ){
+                        SEGGER_RTT_Write( N, b.buf(), b.length() );
+                        __atomic_sub_fetch( &dropped_, d, __ATOMIC_RELAXED );
+                        drop_ += d;
+                        }
+                    }
+                }
+
+                //total chars dropped (reported by flush)
+                u32
+dropped         () { return drop_ + dropped_; }
+
+//-------------|
+    private:
+//-------------|
+
+                void
+dropped_add_    (u32 n) { __atomic_add_fetch( &dropped_, n, __ATOMIC_RELAXED ); }
+
+                char buf_[Siz_];
+                u32 reserve_    { 0 };  //writers reserve space up to here
+                u32 commit_     { 0 };  //all writes complete up to here
+                u32 tail_       { 0 };  //flush has sent up to here
+                u32 nest_       { 0 };  //writers in progress
+                u32 dropped_    { 0 };  //dropped since last flush
+                u32 drop_       { 0 };  //dropped and already reported
+
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+/*-----------------------------------------------------------------------------
+    includes
+-----------------------------------------------------------------------------*/
+#include "nRFconfig.hpp"
+
+#include "Print.hpp"
+
+/*------------------------------------------------------------------------------
+    enable in makefile (CFLAGS += -DPROFILE_ENABLED=1), when 0 a ProfileScope
+    is an empty object and nothing is added to the code
+------------------------------------------------------------------------------*/
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 0
+#endif
+
+
+/*------------------------------------------------------------------------------
+    DwtCycles - Cortex-M4 DWT cycle counter, 64MHz cpu clock
+    (counter does not run while sleeping, so only awake time is counted)
+------------------------------------------------------------------------------*/
+struct DwtCycles {
+
+//============
+    private:
+//============
+
+    struct Dwt_ {
+        u32 CTRL;           //0xE0001000
+        u32 CYCCNT;         //0xE0001004
+    };
+    static inline volatile Dwt_& reg { *(reinterpret_cast<Dwt_*>(0xE0001000)) };
+    static inline volatile u32& DEMCR { *(reinterpret_cast<u32*>(0xE000EDFC)) };
+
+    SCA TRCENA{ 1<<24 };    //DEMCR, enable DWT
+    SCA CYCCNTENA{ 1 };     //CTRL, enable CYCCNT
+
+//============
+    public:
+//============
+
+    SCA HZ{ 64000000 };
+
+SA  init            () {
+                        DEMCR or_eq TRCENA;
+                        reg.CYCCNT = 0;
+                        reg.CTRL or_eq CYCCNTENA;
+                    }
+SA  now             () -> u32 { return reg.CYCCNT; }
+
+};
+
+
+/*------------------------------------------------------------------------------
+    profile regions, add an id and name as needed
+------------------------------------------------------------------------------*/
+enum PROFILE_ID {
+    PROF_ADV_UPDATE, PROF_TEMP_UPDATE, PROF_TMP117_DONE,
+    PROF_BATTERY_UPDATE, PROF_TWIM_WRITEREAD, PROF_FLASH_SAVENAME,
+    PROF_END
+};
+
+
+/*------------------------------------------------------------------------------
+    ProfileT - count/min/max/total cycles for each region
+    Clock_ = counter source, static init(), static now() -> u32, HZ
+             (so can use something else on a pc, std::chrono::steady_clock
+              in ns is-
+                struct HostClock {
+                    static void init(){}
+                    static u32 now(){ return steady_clock::now().time_since_epoch().count(); }
+                    static constexpr auto HZ{ 1000000000 };
+                };
+             )
+
+    regions run from the app timer irq, ble/soc observers and thread mode,
+    an entry update is not protected so a region interrupted by the same
+    region at another priority can lose a count
+------------------------------------------------------------------------------*/
+template<typename Clock_>
+struct ProfileT {
+
+    struct Entry {
+        u32 count;
+        u32 min;
+        u32 max;
+        u64 total;
+    };
+
+//============
+    private:
+//============
+
+    SI Entry table_[PROF_END];
+
+    static constexpr const char* names_[PROF_END]{
+        "Advertising::update",
+        "MyTemperatureAD::update",
+        "Tmp117 result cb",         //TemperatureTmp117* done_/event_, not the read
+        "Battery::update",
+        "Twim::writeRead",
+        "Flash::saveName"
+    };
+
+    SCA US_DIV{ Clock_::HZ / 1000000 };
+
+//============
+    public:
+//============
+
+SA  init            () { Clock_::init(); clear(); }
+SA  now             () { return Clock_::now(); }
+
+SA  clear           () {
+                        for( auto& e : table_ ) e = { 0, 0xFFFFFFFF, 0, 0 };
+                    }
+
+SA  add             (PROFILE_ID id, u32 cycles) {
+                        auto& e = table_[id];
+                        e.count++;
+                        e.total += cycles;
+                        if( cycles < e.min ) e.min = cycles;
+                        if( cycles > e.max ) e.max = cycles;
+                    }
+
+SA  entry           (PROFILE_ID id) -> const Entry& { return table_[id]; }
+SA  name            (PROFILE_ID id) { return names_[id]; }
+
+                    //table in us (total, count, min, avg, max) to a Format device
+                    template<typename D>
+SA  report          (FormatT<D>& out) {
+                        out << reset << FG LIGHT_SKY_BLUE
+                            << "  profile (us)               total   count     min     avg     max" << endl;
+                        for( auto i = 0; i < PROF_END; i++ ){
+                            auto& e = table_[i];
+                            out << "  " << left << setwmax(24+1) << setw(24) << names_[i] //wmax is +1
+                                << right << setwmax(0);
+                            if( e.count == 0 ){ out << "       -" << endl; continue; }
+                            out << setw(8) << (u32)(e.total/US_DIV)
+                                << setw(8) << e.count
+                                << setw(8) << e.min/US_DIV
+                                << setw(8) << (u32)(e.total/e.count/US_DIV)
+                                << setw(8) << e.max/US_DIV << endl;
+                        }
+                        out << ANSI_NORMAL << reset;
+                    }
+
+};
+
+
+/*------------------------------------------------------------------------------
+    ProfileScopeT - time from construction to destruction is added to a region
+
+    ProfileScope ps{ PROF_ADV_UPDATE };
+------------------------------------------------------------------------------*/
+template<typename Clock_>
+struct ProfileScopeT {
+
+    ProfileScopeT   (PROFILE_ID id) : id_(id), start_(ProfileT<Clock_>::now()) {}
+    ~ProfileScopeT  () { ProfileT<Clock_>::add( id_, ProfileT<Clock_>::now() - start_ ); }
+
+//============
+    private:
+//============
+
+    const PROFILE_ID id_;
+    const u32 start_;
+
+};
+
+
+#if PROFILE_ENABLED
+using Profile = ProfileT<DwtCycles>;
+using ProfileScope = ProfileScopeT<DwtCycles>;
+#else
+struct Profile {
+SA  init            () {}
+SA  clear           () {}
+                    template<typename D>
+SA  report          (FormatT<D>&) {}
+};
+struct ProfileScope {
+    ProfileScope    (PROFILE_ID) {}
+};
+#endif
+
+//for all who include this file
+inline Profile profile;
@@ -2,12 +2,20 @@
 
 #include "nRFconfig.hpp"
 
+#include "nrf_nvic.h"   //sd_nvic_*, softdevice owns the nvic
+
+#include "Deadline.hpp"
+
 #undef SA
 //#define SA [[gnu::always_inline]] static auto
 #define SA [[gnu::noinline]] static auto
 
 /*------------------------------------------------------------------------------
     Saadc struct
+
+    waits (calibrate, SaadcChan::read) sleep (__WFE) until the event or a
+    Deadline, the saadc irq stays disabled in the nvic, its pending irq
+    wakes the cpu (Deadline sets SEVONPEND), same as the Twim waits
 ------------------------------------------------------------------------------*/
 struct Saadc {
 
@@ -16,7 +24,10 @@ struct Saadc {
 //============
 
     SCA         base_   { 0x40007000 };
+    SCA         IRQN_   { 7 };          //SAADC_IRQn
+    SCA         IRQPRI_ { 6 };          //APP_IRQ_PRIORITY_LOW
     SI uint8_t  inuse_  { 0 }; //channels in use 0b00000000
+    SI bool     isAsync_{ false }; //SaadcChan::readAsync in progress
 
     struct cfgT;
     struct Saadc_; //forward declare register struct, at end
@@ -43,6 +54,9 @@ struct Saadc {
     enum OVERSAMP { OVEROFF, OVER2X, OVER4X, OVER8X, OVER16X, OVER32X, 
                     OVER64X, OVER128X, OVER256X  };
 
+                //waits, a burst of 256 samples at 40us tacq is ~11ms
+    SCA TIMEOUT_US      { 20000 };
+
 
     //give public access to registers
     static inline volatile Saadc_&
@@ -91,11 +105,13 @@ SA  start           ()          { enable(); reg.TASKS.START = 1; }
 SA  sample          ()          { reg.TASKS.SAMPLE = 1; } 
 SA  stop            ()          { reg.TASKS.STOP = 1; } 
 SA  calibrate       ()          {   
+                                    if( isAsync_ ) return false;
                                     enable();
+                                    clearCalibrated();
                                     reg.TASKS.CALIBRATE = 1;
-                                    while( not isCalibrated() );
+                                    auto ok = waitFor( reg.EVENTS.CALIBRATEDONE, CALIBRATE );
                                     clearCalibrated();
-                                    //leave enabled
+                                    return ok; //leave enabled
                                 }
 //--------------------
 //  interrupts
@@ -107,6 +123,22 @@ SA  irqOff          (INT e)         { reg.INTENCLR = 1<<e; }
 SA  irqAllOff       ()              { reg.INTENCLR = 0xFFFFFFFF; }
 SA  isIrqOn         (INT e)         { return reg.INTEN bitand (1<<e); }
 
+                    //sleep until evt or the deadline, false = timeout
+                    //(evt is the event register for e)
+SA  waitFor         (volatile u32& evt, INT e, u32 us = TIMEOUT_US) -> bool {
+                        irqOn( e );
+                        Deadline::start( us );
+                        while( true ){
+                            sd_nvic_ClearPendingIRQ( (IRQn_Type)IRQN_ ); //so next event pends again
+                            if( evt or Deadline::isExpired() ) break;
+                            __WFE();
+                        }
+                        Deadline::stop();
+                        irqOff( e );
+                        sd_nvic_ClearPendingIRQ( (IRQn_Type)IRQN_ );
+                        return evt;
+                    }
+
 SA  irqOnLimitH     (CH e)          { irqOn( ch2int(e,0) ); } //H=0,L=1
 SA  irqOnLimitL     (CH e)          { irqOn( ch2int(e,1) ); }
 SA  irqOffLimitH    (CH e)          { irqOff( ch2int(e,0) ); }
@@ -338,7 +370,7 @@ SCA init            (cfgT& it) { //no more arguments
                     template<typename ...Ts>
 SCA init            (CH ch, PSEL p, Ts... ts) { 
                         ch_ = ch;
-                        cfgT it{p, NC, 0x20000}; 
+                        cfgT it{p, NC, 0x20000, -32768, 32767}; 
                         init(it, ts...); 
                     }
 
@@ -346,31 +378,43 @@ SCA init            (CH ch, PSEL p, Ts... ts) {
     private:
 //============
 
+    SCA     BURST_      { 1u<<24 };     //CONFIG.BURST
+    SCA     ASYNC_INTS_ { 1u<<STARTED bitor 1u<<END };
+    SCA     DEADLINE_CH_{ 3 };              //Deadline cb channel, readAsync
+
+    SI RES      res_    { RES10 };      //to restore when done
+    SI OVERSAMP over_   { OVEROFF };
+    SI void     (*cb_)(bool){ nullptr };
+
                     //setup our channel config and buffer in Saadc
                     //take exclusive use of Saadc
-SA setConfig        (i16& v) {
-                        if( isBusy() ) return false;        //is in use
+                    //oversampling uses burst, so 1 SAMPLE task does all of
+                    //the samples (only 1 channel is enabled)
+SA setConfig        (i16& v, OVERSAMP s) {
+                        if( isBusy() or isAsync_ ) return false;    //is in use
                         if( pselP_ == NC and pselN_ == NC ) return false; //or we are not init
-                        channelSetup( ch_, config_, pselP_, pselN_ );  //set config and inputs
-                        bufferSet( (u32)&v, 1 );
+                        auto cfg = s == OVEROFF ? config_ : config_ bitor BURST_;
+                        channelSetup( ch_, cfg, pselP_, pselN_ );  //set config and inputs
+                        bufferSet( addr32(&v), 1 );
                         channelOnly( ch_ );                 //disable all other channels
                         return true;
                     }
 
-                    //get a single sample (blocking) - 
-                    //TODO, should have timeout here 
-SA  sample1         () {
-                        clearConversion();
-                        sample();
-                        while( not isConversion() );     
+SA  begin_          (RES r, OVERSAMP s) {
+                        res_ = resolution();            //save old
+                        over_ = overSample();
+                        resolution( r );                //set new
+                        overSample( s );
+                        clearEvents();
+                        start();                        //start will also enable
                     }
 
-                    //get a single result (blocking) - 
-                    //could be >1 sample if oversample is on
-                    //TODO, should have timeout here  
-SA  result1         () {
-                        clearResult();
-                        for( ; not isResult(); sample() );  
+SA  end_            () {
+                        resolution( res_ );             //restore old
+                        overSample( over_ );
+                        disable();
+                        clearEvents();
+                        channelRelease( ch_ );
                     }
 
 //============
@@ -378,24 +422,78 @@ SA  result1         () {
 //============
 
                     //get with a specific resolution, and number of samples
+                    //(blocking, sleeps), false = in use or timeout
 SA  read            (i16& v, RES r, OVERSAMP s = OVEROFF) {
-                        if( not setConfig( v ) ) return false;
-                        RES rr = resolution();          //save old
-                        OVERSAMP ss = overSample();
-                        resolution( r );                //set new
-                        overSample( s );
-                        start();                        //start will also enable
-                        result1();
-                        resolution( rr );               //restore old
-                        overSample( ss );
-                        disable();
-                        clearEvents();
-                        channelRelease( ch_ );
+                        if( not setConfig( v, s ) ) return false;
+                        begin_( r, s );
+                        //the buffer is latched (STARTED) before the sample,
+                        //END = result is in v
+                        auto ok = waitFor( reg.EVENTS.STARTED, STARTED );
+                        if( ok ){
+                            sample();
+                            ok = waitFor( reg.EVENTS.END, END );
+                        }
+                        if( not ok ) stop();
+                        end_();
+                        return ok;
+                    }
+
+                    //same, cb(true) from the saadc irq (priority 6) when the
+                    //result is in v (v needs to stay valid until then),
+                    //cb(false) from the TIMER2 irq (also priority 6) if not
+                    //done by the deadline (STOP issued)
+                    //false = in use (cb not called)
+SA  readAsync       (i16& v, RES r, OVERSAMP s, void(*cb)(bool)) {
+                        if( not setConfig( v, s ) ) return false;
+                        cb_ = cb;
+                        isAsync_ = true;
+                        Deadline::start( DEADLINE_CH_, TIMEOUT_US, asyncTimeout );
+                        reg.INTENSET = ASYNC_INTS_;
+                        sd_nvic_ClearPendingIRQ( (IRQn_Type)IRQN_ );
+                        sd_nvic_SetPriority( (IRQn_Type)IRQN_, IRQPRI_ );
+                        sd_nvic_EnableIRQ( (IRQn_Type)IRQN_ );
+                        begin_( r, s );
                         return true;
                     }
 
+SA  isAsync         () { return isAsync_; }
+
+                    //from SAADC_IRQHandler (only enabled for readAsync)
+SA  isr             () {
+                        if( isStarted() ){
+                            clearStarted();
+                            sample();
+                        }
+                        if( not isBufferFull() ) return;
+                        clearBufferFull();
+                        (void)reg.EVENTS.END; //flush write before return
+                        Deadline::stop( DEADLINE_CH_ );
+                        asyncEnd_( true );
+                    }
+
+                    //Deadline cb, async read did not end in time
+SA  asyncTimeout    (u8) -> void {
+                        stop();
+                        asyncEnd_( false );
+                    }
+
+//============
+    private:
+//============
+
+SA  asyncEnd_       (bool ok) -> void {
+                        reg.INTENCLR = ASYNC_INTS_;
+                        sd_nvic_DisableIRQ( (IRQn_Type)IRQN_ );
+                        sd_nvic_ClearPendingIRQ( (IRQn_Type)IRQN_ );
+                        end_();
+                        isAsync_ = false;
+                        if( cb_ ) cb_( ok );
+                    }
+
 };
 
 #undef SA
 #define SA static auto
 
+//only 1 translation unit (main.cpp), so can define the irq handler here
+extern "C" void SAADC_IRQHandler(void) { SaadcChan::isr(); }
@@ -12,6 +12,28 @@
 
 //sda/scl pins routed wrong on CR2 board :(
 
+/*------------------------------------------------------------------------------
+    Si7051 resolution, not dependent on Twi_ so can be used as a template
+    argument (Si7051<Twi>::RES_12BIT is the same)
+
+    also the power figures for the power policy (Si7051Async Power_, see
+    PowerFor in Twim.hpp)
+    gated- each read pays the power up (25ms, ~120uA, ~3uC), charging the
+    rail (~0.1uF at 3V, ~0.3uC) and the power up timer wakeups (~0.15uC)
+    keep- ~0.06uA standby (typ), so keep is lower below ~1 minute per sample
+------------------------------------------------------------------------------*/
+struct Si7051Res {
+                    //bitmasks
+    enum RESOLUTION { RES_14BIT, RES_12BIT, RES_13BIT = 0x80, RES_11BIT = 0x81 };
+
+    SCA GATED_NC    { 25 * 120 + 300 + 150 };
+    SCA STANDBY_NA  { 60 };
+};
+
+                    //power policy for a sample interval
+template<u32 IntervalMs_>
+using Si7051PowerFor = PowerFor< IntervalMs_, Si7051Res::GATED_NC, Si7051Res::STANDBY_NA >;
+
 /*------------------------------------------------------------------------------
     Si7051 struct
 
@@ -20,7 +42,7 @@
     Si7051 - Silicon Labs temperature IC
 ------------------------------------------------------------------------------*/
 template<typename Twi_>
-struct Si7051 {
+struct Si7051 : Si7051Res {
 
     //============
         private:
@@ -40,32 +62,34 @@ struct Si7051 {
     enum { USER_RSVD_BITS = 0x3A };
 
 SA  readUser    (u8& v)         { u8 tbuf[1]{ READ_USER }; u8 rbuf[1];
-                                  if( not twi_.writeRead(tbuf, rbuf) ) return false; 
+                                  if( not twi_.writeRead(Addr_, tbuf, rbuf) ) return false; 
                                   v = rbuf[0];
                                   return true;
                                 }
 
 SA  command     (COMMANDS1 cmd) { u8 tbuf[1]{ cmd }; 
-                                  return twi_.write(tbuf);
+                                  return twi_.write(Addr_, tbuf);
                                 }
 
     //============
         public:
     //============
 
-                    //bitmasks
-    enum RESOLUTION { RES_14BIT, RES_12BIT, RES_13BIT = 0x80, RES_11BIT = 0x81 };
+    SCA POWERUP_MS{ 25 };   //typical at 25C, max 80ms
 
-
-SA  init        ()              { 
-                                twi_.init( Addr_, twi_.K400 );
+                                //wait = false when the caller schedules the
+                                //startup time itself (Si7051Async)
+SA  init        (bool wait = true) { 
+                                if( isInit_ ) return; //twi init is counted, so only once
+                                twi_.init( twi_.K400 );
                                 //startup time 18-25ms, max 80ms
                                 //let caller deal with startup time
-                                nrf_delay_ms(2); //but will give time for power to come up
+                                if( wait ) nrf_delay_ms(2); //but will give time for power to come up
+                                isConverting_ = false;
                                 isInit_ = true;
                                 }
 
-SA  deinit      ()              { twi_.deinit(); isInit_ = false; }
+SA  deinit      ()              { if( isInit_ ) twi_.deinit(); isInit_ = false; }
 
 SA  reset       ()              { return command( RESET ); } //5-15ms
 
@@ -75,7 +99,7 @@ SA  reset       ()              { return command( RESET ); } //5-15ms
 SA  resolution  (RESOLUTION e)  { 
                                 u8 v = USER_RSVD_BITS bitor e;
                                 u8 tbuf[2]{ WRITE_USER, v };
-                                return twi_.write(tbuf);
+                                return twi_.write(Addr_, tbuf);
                                 }
 
 SA  isPowerOk   ()              { 
@@ -87,7 +111,7 @@ SA  isPowerOk   ()              {
                                 //blocking on clock stretch, up to 10.8ms
 SA  tempWait    (u16& v)        { 
                                 u8 tbuf[1]{ MEASURE_HOLD }; u8 rbuf[2]; 
-                                if( not twi_.writeRead(tbuf, rbuf) ) return false;
+                                if( not twi_.writeRead(Addr_, tbuf, rbuf) ) return false;
                                 v = (rbuf[0]<<8) bitor rbuf[1];
                                 return true; 
                                 }
@@ -103,7 +127,7 @@ SA  tempStart   ()              {
 SA  tempPoll    (u16& v)        { 
                                 if( not isConverting_ ) return false;
                                 u8 rbuf[2];
-                                if( not twi_.read(rbuf) ) return false; //not ready (nack)
+                                if( not twi_.read(Addr_, rbuf) ) return false; //not ready (nack)
                                 v = (rbuf[0]<<8) bitor rbuf[1];
                                 isConverting_ = false;
                                 return true; //you now have a value
@@ -113,10 +137,10 @@ SA  tempPoll    (u16& v)        {
 SA  esn         (u8 (&buf)[8])  {
                                 u8 tbuf[2]{ READ_ID1>>8, READ_ID1&0xff };
                                 u8 rbuf[8];
-                                if( not twi_.writeRead(tbuf, rbuf) ) return false;
+                                if( not twi_.writeRead(Addr_, tbuf, rbuf) ) return false;
                                 buf[0] = rbuf[0]; buf[1] = rbuf[2]; buf[2] = rbuf[4]; buf[3] = rbuf[6];
                                 tbuf[0] = READ_ID2>>8; tbuf[1] = READ_ID2;
-                                if( not twi_.writeRead(tbuf, rbuf) ) return false;
+                                if( not twi_.writeRead(Addr_, tbuf, rbuf) ) return false;
                                 buf[4] = rbuf[0]; buf[5] = rbuf[2]; buf[6] = rbuf[4]; buf[7] = rbuf[6];
                                 return true;
                                 }
@@ -125,7 +149,7 @@ SA  esn         (u8 (&buf)[8])  {
 SA  firmware    (u8& v)         {
                                 u8 tbuf[2]{ READ_FIRMREV>>8, READ_FIRMREV&0xff };
                                 u8 rbuf[1];
-                                if( not twi_.writeRead(tbuf, rbuf) ) return false;
+                                if( not twi_.writeRead(Addr_, tbuf, rbuf) ) return false;
                                 v = rbuf[0];
                                 return true;
                                 }
@@ -141,9 +165,158 @@ SA  x10C    (u16 v) -> i16      { return x100C(v) / 10; }
 SA  x100F   (u16 v) -> i16      { return x100C(v) * 9L / 5 + 3200; }
 SA  x10F    (u16 v) -> i16      { return x100F(v) / 10; }
 
+                                //max conversion time, ms (rounded up)
+SCA convMs  (RESOLUTION e) -> u8 { return e == RES_11BIT ? 3 : e == RES_12BIT ? 4 : 
+                                          e == RES_13BIT ? 7 : 11; }
+SCA bits    (RESOLUTION e) -> u8 { return e == RES_11BIT ? 11 : e == RES_12BIT ? 12 : 
+                                          e == RES_13BIT ? 13 : 14; }
+
 };
 
+/*------------------------------------------------------------------------------
+    Si7051Async - non-blocking read, no hold master conversion, the power
+    up and conversion waits are one-shot timers so the cpu and twim are
+    idle while the ic converts
+
+    Si7051_     = Si7051<Twi>
+    Timer_      = Timer (create(cb), start(ms), cb is void(*)(void*))
+    StableRes_  = resolution used when the readings are stable (RES_11BIT or
+                  RES_12BIT, 0.08C/0.04C), RES_14BIT (0.01C) is used after
+                  any change more than STABLE_X100C, STABLE_N readings within
+                  STABLE_X100C of each other drops to StableRes_
+    Power_      = PowerGated (power on/off each read), PowerKeep (stays on
+                  in standby, see Twim.hpp), or Si7051PowerFor<ms>
+
+    start(cb)   power on, timer for the power up time (25ms), if kept on
+                start the conversion right away
+    poll()      (timer callback)
+                power up- set resolution (if not what the ic has, 14bit at
+                power on) and start a conversion, a nack is still powering
+                up, so timer again for POWERUP_RETRY_MS (up to 80ms in total)
+                converting- read, a nack is not done, timer again for
+                POLL_MS, else power off (gated), cb
+    status()    result of the last read, raw() its raw value, res() the
+                resolution used
+
+    cb is called from the timer irq, start is ignored (false) if busy
+------------------------------------------------------------------------------*/
+template<typename Si7051_, typename Timer_, 
+         Si7051Res::RESOLUTION StableRes_ = Si7051Res::RES_12BIT,
+         typename Power_ = PowerGated>
+struct Si7051Async {
+
+    using RESOLUTION = Si7051Res::RESOLUTION;
+
+    enum STATUS { OK, BUSY, TIMEOUT };
+
+    SCA STABLE_X100C        { 10 }; //0.1C
+    SCA STABLE_N            { 3 };
+
+//============
+    private:
+//============
+
+    enum STAGE { POWERUP, CONVERT };
+
+    SI Timer_       timer_;
+    SI bool         isCreated_  { false };
+    SI bool         isOn_       { false };  //kept on, in standby
+    SI STATUS       status_     { TIMEOUT };
+    SI STAGE        stage_      { POWERUP };
+    SI u8           tries_      { 0 };
+    SI u16          raw_        { 0 };
+    SI RESOLUTION   res_        { Si7051_::RES_14BIT };
+    SI RESOLUTION   resUsed_    { Si7051_::RES_14BIT };
+    SI RESOLUTION   icRes_      { Si7051_::RES_14BIT }; //in the user register
+    SI i16          lastC_      { -32768 }; //x100C of the last good read
+    SI u8           stableN_    { 0 };
+    SI void(*cb_)(void*){ nullptr };
+
+    SCA POWERUP_RETRY_MS    { 5 };
+    SCA POWERUP_TRIES       { (80 - Si7051_::POWERUP_MS) / POWERUP_RETRY_MS + 1 };
+    SCA POLL_MS             { 1 };
+    SCA POLL_TRIES          { 5 };
+
+SA  done_           (STATUS s) {
+                        //kept on only after a good read, a failure starts
+                        //over from a power on
+                        isOn_ = Power_::KEEP and s == OK;
+                        if( not isOn_ ) Si7051_::deinit(); //turn off power to ic
+                        status_ = s;
+                        if( s == OK ) adapt_();
+                        if( cb_ ) cb_( nullptr );
+                    }
+
+                    //next resolution from how much this read changed
+SA  adapt_          () {
+                        i16 c = Si7051_::x100C( raw_ );
+                        i16 d = c - lastC_;
+                        auto stable = lastC_ != -32768 and d <= STABLE_X100C and d >= -STABLE_X100C;
+                        if( stable ){
+                            //change is measured against the last reported value
+                            //at the lower resolution, so does not drift away
+                            if( stableN_ < STABLE_N ) stableN_++;
+                        } else {
+                            stableN_ = 0;
+                            lastC_ = c;
+                        }
+                        res_ = stableN_ >= STABLE_N ? StableRes_ : Si7051_::RES_14BIT;
+                    }
+
+                    //set resolution (if changed) and start, false if nack
+SA  convert_        () {
+                        if( res_ != icRes_ ){
+                            if( not Si7051_::resolution(res_) ) return false;
+                            icRes_ = res_;
+                        }
+                        if( not Si7051_::tempStart() ) return false;
+                        resUsed_ = res_;
+                        stage_ = CONVERT;
+                        tries_ = POLL_TRIES;
+                        timer_.start( Si7051_::convMs(resUsed_) );
+                        return true;
+                    }
+
+//============
+    public:
+//============
+
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( status_ == BUSY ) return false;
+                        if( not isCreated_ ){ timer_.create( poll ); isCreated_ = true; }
+                        cb_ = cb;
+                        status_ = BUSY;
+                        if( isOn_ ){ //kept on, no power up
+                            if( not convert_() ) done_( TIMEOUT );
+                            return true;
+                        }
+                        stage_ = POWERUP;
+                        tries_ = POWERUP_TRIES;
+                        icRes_ = Si7051_::RES_14BIT; //power on default
+                        Si7051_::init( false );
+                        timer_.start( Si7051_::POWERUP_MS );
+                        return true;
+                    }
+
+SA  poll            (void* = nullptr) -> void {
+                        if( status_ != BUSY ) return;
+                        if( stage_ == POWERUP ){
+                            if( convert_() ) return;
+                            if( --tries_ == 0 ) return done_( TIMEOUT );
+                            timer_.start( POWERUP_RETRY_MS );
+                            return;
+                        }
+                        if( Si7051_::tempPoll(raw_) ) return done_( OK );
+                        if( --tries_ == 0 ) return done_( TIMEOUT );
+                        timer_.start( POLL_MS );
+                    }
+
+SA  isBusy          () { return status_ == BUSY; }
+SA  status          () { return status_; }
+SA  raw             () { return raw_; }
+SA  res             () { return resUsed_; }
 
+};
 
 /*
 
@@ -6,21 +6,27 @@
 #include "nrf_delay.h"
 
 #include "Print.hpp"
+#include "Profile.hpp"
+#include "Timer.hpp"
+#include "Filter.hpp"
+#include "Gpiote.hpp"
 #include "Tmp117.hpp"
 #include "Si7051.hpp"
 
 /*------------------------------------------------------------------------------
-    Temperature
+    Temperature - temperature values (Fx10) limited to a sane range, then
+    filtered by Filter_ (see Filter.hpp- NoFilter, Boxcar<N>, Ema<Shift>,
+    Median<3/5>, Decimate<R,Filter>)
     (not static, each use is seperate)
 ------------------------------------------------------------------------------*/
-template<u8 HistSiz_>
+template<typename Filter_>
 struct Temperature {
 
 //============
     private:
 //============
 
-    i16 tempHistory_[HistSiz_ == 0 ? 1 :HistSiz_]{0};
+    Filter_ filter_;
 
     SCA TEMP_MAX{ 180*10 };
     SCA TEMP_MIN{ -40*10 };
@@ -29,27 +35,15 @@ struct Temperature {
     public:
 //===========
 
-auto    addHistory  (i16 v) {
-                        static bool isInit;
-                        static u8 idx;
-
-                        if( not isInit ){ //first time, populate all with same value
-                            for( auto& i : tempHistory_ ) i = v;
-                            isInit = true;
-                        }
+auto    add         (i16 v) {
                         if( v < TEMP_MIN ) v = TEMP_MIN;
                         if( v > TEMP_MAX ) v = TEMP_MAX;
-                        tempHistory_[idx++] = v;
-                        if( idx >= HistSiz_ ) idx = 0;
-
+                        filter_.add( v ); //first add sets the filter output
                         return v; //the min/max limited value
                     }
 
-auto    average     () {
-                        i16 avg{0};
-                        for( auto& i : tempHistory_ ) avg += i;
-                        return avg / HistSiz_;
-                    }
+auto    value       () { return filter_.value(); }
+auto&   filter      () { return filter_; }
 
 };
 
@@ -58,135 +52,409 @@ auto    average     () {
     assuming softdevice in use 
     (softdevice takes over temp sensor, so have to use sd)
 ------------------------------------------------------------------------------*/
-template<u8 HistSiz_>
+template<typename Filter_>
 struct TemperatureInternal {
 
     private:
 
-    inline static Temperature<HistSiz_> tempH;
+    inline static Temperature<Filter_> tempH;
+    inline static i16 last_{ -999 };
 
     public:
 
-SA  average         () { return tempH.average(); }
-SA  histSize        () { return HistSiz_; }
+                    //filtered value of all good reads
+SA  value           () { return tempH.value(); }
+
+                    //same interface as TemperatureTmp117, but the read is
+                    //done in start, so cb is called before start returns
+SA  last            () { return last_; }
+SA  isBusy          () { return false; }
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        last_ = read();
+                        if( cb ) cb( nullptr );
+                        return true;
+                    }
 
 SA  read            () {
                         i16 f = -999; //-99.9 = failed to get
                         i32 t;
                         if( sd_temp_get(&t) ) return f;
                         f = (t*10*9/5+320*4)/4; // Fx10
-                        f = tempH.addHistory( f );
+                        f = tempH.add( f );
                         i16 f10 = f/10;
                         i16 f1 = __builtin_abs(f)%10;
-                        DebugFuncHeader();
-                        DebugRtt << "  internal raw: " << t << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
+                        DebugLogHeader(DBG_TEMP, DBG_INFO) << "  internal raw: " << t << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
                         return f;
                     }
 };
 
+/*------------------------------------------------------------------------------
+    sample rate policies, for MyTemperatureAD (Rate_)
+    next(f) -> ms, the next sample interval after reporting f (Fx10)
+    (0 = no change)
+
+    FixedRate - always the Advertising UpdateInterval_
+
+    SampleRate - interval doubles (MinMs_ up to MaxMs_) while each value
+    stays within DeadbandFx10_ of the reference, and goes back to MinMs_
+    on the first value outside of it (the reference then moves to that
+    value), the values are the filtered Temperature<> value so the
+    filter history smooths out noise that would otherwise reset the rate
+
+    SampleRate<20_sec, 320_sec, 3> - 20s,40s,80s,160s,320s while within 0.3F
+------------------------------------------------------------------------------*/
+struct FixedRate {
+auto    next        (i16) -> u32 { return 0; }
+};
+
+template<u32 MinMs_, u32 MaxMs_, i16 DeadbandFx10_>
+struct SampleRate {
+
+    static_assert( MinMs_ and MinMs_ <= MaxMs_, "SampleRate needs 0 < MinMs_ <= MaxMs_" );
+
+auto    next        (i16 f) -> u32 {
+                        if( f == -999 ) return ms_ = MinMs_; //failed, try again soon
+                        i16 d = f - ref_;
+                        if( ref_ == -999 or d > DeadbandFx10_ or d < -DeadbandFx10_ ){
+                            ref_ = f;
+                            return ms_ = MinMs_;
+                        }
+                        ms_ = ms_*2 < MaxMs_ ? ms_*2 : MaxMs_;
+                        return ms_;
+                    }
+auto    interval    () const { return ms_; }
+
+//============
+    private:
+//============
+
+    i16 ref_{ -999 };
+    u32 ms_{ MinMs_ };
+
+};
+
 #ifdef NRF52810_BL651_TEMP
-template<u8 HistSiz_>
+/*------------------------------------------------------------------------------
+    Temperature - TMP117, non-blocking (see Tmp117Async), data ready from
+    polling CONFIG, or the ALERT pin if TMP117_ALERT_DATAREADY
+    Profile_ = hardware averaging/conversion time (Tmp117PowerOn,
+    Tmp117Avg1/8/32/64, see table in Tmp117.hpp), with averaging in the ic
+    Power_ = PowerGated/PowerKeep, Tmp117PowerFor<Profile_, interval ms>
+    picks the lower charge one for the sample interval
+    Filter_ can be NoFilter
+    start(cb) returns right away, cb is called from the timer irq when the
+    read is done, last() is the result
+------------------------------------------------------------------------------*/
+template<typename Filter_, typename Profile_ = Tmp117PowerOn, typename Power_ = PowerGated>
 struct TemperatureTmp117 {
 
     private:
 
-    inline static Temperature<HistSiz_> tempH;
+    inline static Temperature<Filter_> tempH;
+    inline static i16 last_{ -999 };
+    inline static void(*cb_)(void*){ nullptr };
+
+    using twi_ = decltype(board)::tmp117Twi; //board bus mapping (Boards.hpp)
 
-    using twi_ = Twim0< board.sda.pinNumber(),   
-                        board.scl.pinNumber(), 
-                        board.i2cDevicePwr.pinNumber() >;
+    using tmp117_ = Tmp117< twi_ >;
+    #ifdef TMP117_ALERT_DATAREADY
+    using reader_ = Tmp117Async< tmp117_, Timer, GpiotePin<decltype(board.tmp117Alert)>, Profile_, Power_ >;
+    #else
+    using reader_ = Tmp117Async< tmp117_, Timer, Tmp117NoAlert, Profile_, Power_ >;
+    #endif
 
-    static inline Tmp117< twi_ > tmp117;
+                    //reader_ callback
+SA  done_           (void*) {
+                        ProfileScope ps{ PROF_TMP117_DONE };
+                        i16 f = -999;
+                        i16 t = reader_::raw();
+                        switch( reader_::status() ){
+                            case reader_::TIMEOUT:  DebugLogHeader(DBG_TEMP, DBG_ERROR) << FG RED "  timeout, ready bit not set" FG WHITE << endl; break;
+                            case reader_::READFAIL: DebugLogHeader(DBG_TEMP, DBG_ERROR) << FG RED "  failed to read temp value" FG WHITE << endl; break;
+                            case reader_::NOVALUE:  DebugLogHeader(DBG_TEMP, DBG_WARN) << "  returned default temp value" << endl; break;
+                            default: {
+                                f = tmp117_::x10F( t );
+                                f = tempH.add( f );
+                                i16 f10 = f/10;
+                                i16 f1 = __builtin_abs(f)%10;
+                                DebugLogHeader(DBG_TEMP, DBG_INFO) << "  Tmp117 raw: " << t << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
+                            }
+                        }
+                        last_ = f;
+                        if( cb_ ) cb_( nullptr );
+                    }
 
     public:
 
-SA  average         () { return tempH.average(); }
-SA  histSize        () { return HistSiz_; }
+                    //filtered value of all good reads
+SA  value           () { return tempH.value(); }
 
-                    // -999 = failed (and is not added to history)
-SA  read            () {
-                        i16 f = -999;
-                        i16 t = -32768;
-                        //get temp Fx10 into f
-
-                        //init will power on, w/2ms delay time for startup
-                        tmp117.init();
-                        //start conversion, one shot, 1 sample
-                        auto i = 10; //10ms
-                        // while( i and not tmp117.oneShot1() ){ nrf_delay_ms(1); i--; }
-                        // nrf_delay_ms(16); //~15.5ms for 1 conversion 
-nrf_delay_ms(125);
-                        //poll for data ready (up to 20ms)
-                        i = 20; //20ms
-                        while( i and not tmp117.isDataReady() ){ nrf_delay_ms(1); i--; }
-                        bool ok = i and tmp117.tempRaw(t);
-                        tmp117.deinit(); //turn off power to ic
-
-                        DebugFuncHeader();
-                        if( not i )      { DebugRtt << FG RED "  timeout, ready bit not set" FG WHITE << endl; return f; }
-                        if( not ok )     { DebugRtt << FG RED "  failed to read temp value" FG WHITE << endl; return f; }
-                        if( t == -32768 ){ DebugRtt << "  returned default temp value" << endl; return f; }
-
-                        f = tmp117.x10F( t );
-                        f = tempH.addHistory( f );
+                    //last completed read, -999 = failed (or none yet)
+SA  last            () { return last_; }
+SA  isBusy          () { return reader_::isBusy(); }
+
+                    //false if a read is already in progress (cb will not be called)
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( reader_::isBusy() ){
+                            DebugLogHeader(DBG_TEMP, DBG_WARN) << "  Tmp117 busy" << endl;
+                            return false;
+                        }
+                        auto prev = cb_;
+                        cb_ = cb;
+                        if( reader_::start( done_ ) ) return true;
+                        cb_ = prev; //refused, the current owner keeps its cb
+                        return false;
+                    }
+};
+
+/*------------------------------------------------------------------------------
+    Temperature - TMP117, event driven (see Tmp117Window)
+    the ic stays powered and only alerts (ALERT pin) when the temperature
+    moves DeadbandFx10_ from the last reported value, cb (from the first
+    start) is called for each new value, at any time (no timer gates it,
+    Advertising::update only updates the packet while connected)
+    start after the first starts no read (false, cb is not called), the
+    last value is always current
+------------------------------------------------------------------------------*/
+template<typename Filter_, i16 DeadbandFx10_ = 5>
+struct TemperatureTmp117Window {
+
+    private:
+
+    inline static Temperature<Filter_> tempH;
+    inline static i16 last_{ -999 };
+    inline static void(*cb_)(void*){ nullptr };
+
+    using twi_ = decltype(board)::tmp117Twi; //board bus mapping (Boards.hpp)
+
+    using tmp117_ = Tmp117< twi_ >;
+    using window_ = Tmp117Window< tmp117_, Timer, GpiotePin<decltype(board.tmp117Alert)> >;
+
+    SCA DEADBAND_RAW{ tmp117_::rawX10F(DeadbandFx10_) - tmp117_::rawX10F(0) };
+
+                    //window_ callback, new value
+SA  event_          (void*) {
+                        ProfileScope ps{ PROF_TMP117_DONE };
+                        i16 t = window_::raw();
+                        i16 f = tmp117_::x10F( t );
+                        f = tempH.add( f );
+                        last_ = f;
                         i16 f10 = f/10;
                         i16 f1 = __builtin_abs(f)%10;
-                        DebugRtt << "  Tmp117 raw: " << t << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
-                        return f;
+                        DebugLogHeader(DBG_TEMP, DBG_INFO) << "  Tmp117 event: " << window_::events() 
+                            << " raw: " << t << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
+                        if( cb_ ) cb_( nullptr );
+                    }
+
+    public:
+
+                    //filtered value of all good reads
+SA  value           () { return tempH.value(); }
+
+                    //last reported value, -999 = none yet
+SA  last            () { return last_; }
+SA  isBusy          () { return false; }
+                    //false if already on (no new read, the last value is current)
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( window_::isOn() ) return false;
+                        auto prev = cb_;
+                        cb_ = cb;
+                        if( window_::start( DEADBAND_RAW, event_ ) ) return true;
+                        cb_ = prev; //refused, the current owner keeps its cb
+                        return false;
                     }
+SA  stop            () { window_::stop(); }
 };
 
-template<u8 HistSiz_>
-struct TemperatureSi7051 {
+/*------------------------------------------------------------------------------
+    Temperature - TMP117, hardware sequenced (see Tmp117Auto)
+    the ic converts every Cycle_ (5 = 4s), each result is read by the twim
+    through PPI with no cpu, cb (from the first start) is called once every
+    N_ samples (20s default) with all N_ added to the history, last() is the
+    newest good sample, the sequence keeps running while connected (its cb
+    only updates the packet then, see Advertising::connected)
+    start after the first starts no read (false, same as
+    TemperatureTmp117Window), it only restarts a stalled sequence (see
+    Tmp117Auto::check)
+------------------------------------------------------------------------------*/
+template<typename Filter_, u8 N_ = 5, u8 Cycle_ = 5>
+struct TemperatureTmp117Auto {
 
     private:
 
-    inline static Temperature<HistSiz_> tempH;
+    inline static Temperature<Filter_> tempH;
+    inline static i16 last_{ -999 };
+    inline static void(*cb_)(void*){ nullptr };
 
-    using twi_ = Twim0< board.sda.pinNumber(),   
-                        board.scl.pinNumber(), 
-                        board.i2cDevicePwr.pinNumber() >;
+    using twi_ = decltype(board)::tmp117Twi; //board bus mapping (Boards.hpp)
 
-    static inline Si7051< twi_ > si7051;
+    using tmp117_ = Tmp117< twi_ >;
+    using auto_ = Tmp117Auto< tmp117_, decltype(board.tmp117Alert), N_, Cycle_ >;
+
+                    //auto_ callback (TIMER1 irq), N_ new samples
+SA  event_          (void*) {
+                        ProfileScope ps{ PROF_TMP117_DONE };
+                        u8 bad = 0;
+                        for( u8 i = 0; i < auto_::size(); i++ ){
+                            i16 t = auto_::raw( i );
+                            if( t == -32768 ){ bad++; continue; }
+                            last_ = tempH.add( tmp117_::x10F(t) );
+                        }
+                        i16 f10 = last_/10;
+                        i16 f1 = __builtin_abs(last_)%10;
+                        DebugLogHeader(DBG_TEMP, DBG_INFO) << "  Tmp117 auto: " << auto_::wakes() 
+                            << " failed: " << bad << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
+                        if( cb_ ) cb_( nullptr );
+                    }
 
     public:
 
-SA  average         () { return tempH.average(); }
-SA  histSize        () { return HistSiz_; }
+                    //filtered value of all good reads
+SA  value           () { return tempH.value(); }
+
+                    //newest good sample, -999 = none yet
+SA  last            () { return last_; }
+SA  isBusy          () { return false; }
+                    //false if already on (no new read, a stalled sequence is restarted)
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( auto_::isOn() ){
+                            if( not auto_::check() ){
+                                DebugLogHeader(DBG_TEMP, DBG_WARN) << "  Tmp117 auto stalled, restart" << endl;
+                            }
+                            return false;
+                        }
+                        auto prev = cb_;
+                        cb_ = cb;
+                        if( auto_::start( event_ ) ) return true;
+                        cb_ = prev; //refused, the current owner keeps its cb
+                        return false;
+                    }
+SA  stop            () { auto_::stop(); }
+};
 
-SA  read            () {
+/*------------------------------------------------------------------------------
+    Temperature - Si7051, non-blocking (see Si7051Async), no hold master
+    conversion, 14bit when changing, StableRes_ when stable
+    Power_ = PowerGated/PowerKeep, Si7051PowerFor<interval ms> picks the
+    lower charge one for the sample interval
+    start(cb) returns right away, cb is called from the timer irq when the
+    read is done, last() is the result
+------------------------------------------------------------------------------*/
+template<typename Filter_, Si7051Res::RESOLUTION StableRes_ = Si7051Res::RES_12BIT,
+         typename Power_ = PowerGated>
+struct TemperatureSi7051 {
+
+    private:
+
+    inline static Temperature<Filter_> tempH;
+    inline static i16 last_{ -999 };
+    inline static void(*cb_)(void*){ nullptr };
+
+    using twi_ = decltype(board)::si7051Twi; //board bus mapping (Boards.hpp)
+
+    using si7051_ = Si7051< twi_ >;
+    using reader_ = Si7051Async< si7051_, Timer, StableRes_, Power_ >;
+
+                    //reader_ callback
+SA  done_           (void*) {
                         i16 f = -999; //-99.9 = failed to get
-                        u16 t;
-
-                        //get temp Fx10 into f
-                        si7051.init();
-                        //we get 2ms delay in .init for power up
-                        //can take up to 80ms for ic to startup at extreme temp
-                        //will just call tempWait until ack'd (true), then is clock 
-                        //stretched and will return a temp value in t,
-                        //conversion time for 14bits is ~10ms, so use 95ms as max time to wait
-                        SCA TIMEOUT_MS{95};
-                        auto ok = false;
-                        for( auto ms = 0; ms < TIMEOUT_MS; ms++, nrf_delay_ms(1) ){ 
-                            if( not si7051.tempWait(t) ) continue;
-                            ok = true;
-                            break;
-                        };
-                        si7051.deinit();
-                        if( not ok ) return f; //timeout, return f (-999)
-
-                        f = si7051.x10F(t);                        
-                        f = tempH.addHistory( f );
-                        i16 f10 = f/10;
-                        i16 f1 = __builtin_abs(f)%10;
-                        DebugFuncHeader();
-                        DebugRtt << "  Si7051 raw: " << t << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
-                        return f;
+                        u16 t = reader_::raw();
+                        if( reader_::status() != reader_::OK ){
+                            DebugLogHeader(DBG_TEMP, DBG_ERROR) << FG RED "  Si7051 timeout" FG WHITE << endl;
+                        } else {
+                            f = si7051_::x10F(t);                        
+                            f = tempH.add( f );
+                            i16 f10 = f/10;
+                            i16 f1 = __builtin_abs(f)%10;
+                            DebugLogHeader(DBG_TEMP, DBG_INFO) << "  Si7051 raw: " << t << " bits: " << si7051_::bits(reader_::res()) 
+                                << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
+                        }
+                        last_ = f;
+                        if( cb_ ) cb_( nullptr );
+                    }
+
+    public:
+
+                    //filtered value of all good reads
+SA  value           () { return tempH.value(); }
+
+                    //last completed read, -999 = failed (or none yet)
+SA  last            () { return last_; }
+SA  isBusy          () { return reader_::isBusy(); }
+
+                    //false if a read is already in progress (cb will not be called)
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( reader_::isBusy() ){
+                            DebugLogHeader(DBG_TEMP, DBG_WARN) << "  Si7051 busy" << endl;
+                            return false;
+                        }
+                        auto prev = cb_;
+                        cb_ = cb;
+                        if( reader_::start( done_ ) ) return true;
+                        cb_ = prev; //refused, the current owner keeps its cb
+                        return false;
                     }
 };
 #endif //#ifdef NRF52810_BL651_TEMP
 
 
+/*------------------------------------------------------------------------------
+    TemperatureGroup - read several temperature sources together
+    Ts_ = TemperatureXxx (start(cb)/last()), started in order, cb when all
+    are done
+
+    the i2c ic's share the power pin, twim init/deinit is counted (on with
+    the first init, off with the last deinit), so when started together
+    the rail is powered up once and is on for the longest conversion
+    instead of the sum, put TemperatureInternal last so it is read while
+    the i2c ic's are converting
+    ic's on different buses (board mapping, Boards.hpp, Twim1 on the
+    nRF52840) also read at the same time, each bus only has its own
+    transfers
+
+    a source is one set of statics (its reader, its cb), so a source
+    already reading for someone else (isBusy) refuses the whole group,
+    nothing is started and the other requester keeps its cb and its
+    result, a source that refuses at start (already on) counts as done
+
+    TemperatureGroup< TemperatureTmp117<NoFilter,Tmp117Avg8>,
+                      TemperatureSi7051<NoFilter>,
+                      TemperatureInternal<NoFilter> >::start( cb );
+------------------------------------------------------------------------------*/
+template<typename... Ts_>
+struct TemperatureGroup {
+
+    private:
+
+    inline static u8 pending_{ 0 };
+    inline static void(*cb_)(void*){ nullptr };
+
+SA  done_           (void*) {
+                        if( pending_ == 0 or --pending_ ) return;
+                        if( cb_ ) cb_( nullptr );
+                    }
+
+                    template<typename T>
+SA  start_          () {
+                        if( not T::start( done_ ) ) done_( nullptr ); //refused, is done
+                    }
+
+    public:
+
+SA  isBusy          () { return pending_ != 0; }
+
+                    //false if still busy from the last start, or a source
+                    //is busy with another read (cb will not be called)
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( pending_ or ( Ts_::isBusy() or ... ) ) return false;
+                        cb_ = cb;
+                        pending_ = sizeof...(Ts_);
+                        ( start_<Ts_>(), ... );
+                        return true;
+                    }
+};
+
+
 
 
 
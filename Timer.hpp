@@ -60,11 +60,21 @@ SA init             () {
                     
                     //for each instance
 auto init           (u32 ms, void(*cb)(void*), TIMER_TYPE typ = ONCE) -> void {
+                        create( cb, typ );
+                        start( ms );
+                    }
+
+                    //create only, start later (a ONCE timer can be started
+                    //again from its own callback to schedule the next step)
+auto create         (void(*cb)(void*), TIMER_TYPE typ = ONCE) -> void {
                         init();
                         error.check( app_timer_create(&ptimerId_, 
                             typ == ONCE ? APP_TIMER_MODE_SINGLE_SHOT : 
                                 APP_TIMER_MODE_REPEATED, cb) 
                         );
+                    }
+
+auto start          (u32 ms) -> void {
                         error.check( app_timer_start(ptimerId_, appTimerTicks(ms), NULL) );
                     }
 
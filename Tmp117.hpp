@@ -5,6 +5,9 @@
 #include "nrf_delay.h"
 
 #include "Twim.hpp"
+#include "TwimQueue.hpp"
+#include "Gpiote.hpp"
+#include "Ppi.hpp"
 #include "Print.hpp"
 
 /*------------------------------------------------------------------------------
@@ -26,6 +29,16 @@ struct Tmp117 {
     static Twi_& twi_;
     static inline bool isInit_{ false };
 
+            //write-through shadows, so a CONFIG field change is 1 write
+            //(no read first) and a write of what the ic already has is
+            //skipped, only the status bits are read from the ic
+            //invalid after init (power on), deinit (power may go off),
+            //reset and a failed write
+    static inline u16  config_  { 0 };      //CONFIG, writable bits only
+    static inline bool isConfig_{ false };
+    static inline i16  limit_[2]{};         //HIGHLIMIT, LOWLIMIT
+    static inline u8   isLimit_ { 0 };      //bit0 = high, bit1 = low
+
             //registers
     enum    { TEMP, CONFIG, HIGHLIMIT, LOWLIMIT, EEUNLOCK, EEPROM1,
               EEPROM2, TEMPOFFSET, EEPROM3, DEVICEID = 15 };
@@ -35,6 +48,29 @@ struct Tmp117 {
             //eeunlock bits
     enum    { EEBUSYu = 14, EUN = 15 };
 
+            //CONFIG,TEMP batch (statusTempAsync, 1 ArrayList entry), or
+            //HIGH/LOWLIMIT writes (limitsAsync, 2 entries)
+    using   queue_ = TwimQueue<Twi_, 2, Tmp117>; //its own (not shared on the bus)
+    static inline const u8 batchRegs_[2]{ CONFIG, TEMP };
+    static inline u8   batchRx_[2][2];
+    static inline u8   limitTx_[2][3];
+    static inline i16  limitNew_[2];
+    static inline u8   limitQ_  { 0 };      //bit0 = high, bit1 = low, in the batch
+    static inline void (*limitCb_)(bool){ nullptr };
+            //CONFIG writable bits (not the status flags, not SOFTRESET)
+    SCA     CONFIG_RW_  { 0x0FFC };
+    SCA     ONESHOT_    { 3<<CONVMODE };
+    SCA     SHUTDOWN_   { 1<<CONVMODE };
+
+SA  invalidate_ ()              { isConfig_ = false; isLimit_ = 0; }
+                //a one-shot goes back to shutdown by itself when done, so
+                //the shadow has shutdown (a field change does not start one)
+SA  shadow_     (u16 v)         {
+                    v and_eq CONFIG_RW_;
+                    if( (v bitand ONESHOT_) == ONESHOT_ ) v = (v bitand compl ONESHOT_) bitor SHUTDOWN_;
+                    config_ = v;
+                    isConfig_ = true;
+                }
 
                 template<typename T> //T = u16 or i16
 SA  read        (const u8 r, T& v) {
@@ -42,12 +78,11 @@ SA  read        (const u8 r, T& v) {
                     u8 rbuf[2]; //if want to init this for some reason, make it volatile
                     u8 tbuf[1] = { r }; //register
                     bool tf = false;
-                    if( twi_.writeRead( tbuf, rbuf) ){
+                    if( twi_.writeRead( Addr_, tbuf, rbuf ) ){
                         v = (rbuf[0]<<8) bitor rbuf[1];
                         tf = true;
                     }
-                    // DebugFuncHeader();
-                    // DebugRtt << "  read reg: " r << " " << (tf ? " " : "[failed]";
+                    // DebugLogHeader(DBG_TEMP, DBG_TRACE) << "  read reg: " r << " " << (tf ? " " : "[failed]";
                     // if( tf ) DebugRtt << '[' << Hex0 << setwf(4,'0') << v << ']';
                     // DebugRtt << endlc;
                     return tf;
@@ -59,32 +94,75 @@ SA  write       (const u8 r, const T& v) {
                     u8 vH = v>>8;   //avoid narrowing conversion
                     u8 vL = v;      //  error in array init
                     u8 buf[3] = { r, vH, vL };
-                    bool tf = twi_.write( buf );
-                    // DebugFuncHeader();
-                    // DebugRtt << "  write reg: " r << " [" << Hex0 << setwf(4,'0') << v << ']' << (tf ? " ok" : " failed" << clear;
+                    bool tf = twi_.write( Addr_, buf );
+                    // DebugLogHeader(DBG_TEMP, DBG_TRACE) << "  write reg: " r << " [" << Hex0 << setwf(4,'0') << v << ']' << (tf ? " ok" : " failed" << clear;
                     return tf;
                 }
 
-SA  configR     (u16& v)        { return read( CONFIG, v ); }
-SA  configW     (u16 v)         { return write( CONFIG, v ); }
-                //bitmask to clear, new value bitmask
+                //any CONFIG read also refreshes the shadow
+SA  configR     (u16& v)        { 
+                    if( not read( CONFIG, v ) ) return false;
+                    shadow_( v );
+                    return true;
+                }
+SA  configW     (u16 v)         { 
+                    if( not write( CONFIG, v ) ){ isConfig_ = false; return false; }
+                    shadow_( v );
+                    return true;
+                }
+                //bitmask to clear, new value bitmask, the ic is only read
+                //when the shadow is not valid, the write is skipped if
+                //nothing changes (a one-shot is always written)
 SA  configWbm   (u16 bm, u16 nvm){
                     u16 v;
-                    if( not configR( v ) ) return false;    //R
-                    v  = (v bitand compl bm) bitor nvm;     //M
-                    return configW( v );                    //W
+                    if( not isConfig_ and not configR( v ) ) return false;  //R
+                    v = (config_ bitand compl bm) bitor nvm;                //M
+                    if( v == config_ and (v bitand ONESHOT_) != ONESHOT_ ) return true;
+                    return configW( v );                                    //W
+                }
+                //i = 0 high, 1 low, skipped if the ic already has it
+SA  limitW      (u8 i, i16 v)   {
+                    u8 bm = 1<<i;
+                    if( (isLimit_ bitand bm) and limit_[i] == v ) return true;
+                    isLimit_ and_eq compl bm;
+                    if( not write( HIGHLIMIT+i, v ) ) return false;
+                    limit_[i] = v;
+                    isLimit_ or_eq bm;
+                    return true;
+                }
+                //limitsAsync batch done (twim irq), the shadow has what was
+                //written (a failed batch leaves both to be written again)
+SA  limitsDone_ (bool ok) -> void {
+                    for( u8 i = 0; ok and i < 2; i++ ){
+                        if( not (limitQ_ bitand (1<<i)) ) continue;
+                        limit_[i] = limitNew_[i];
+                        isLimit_ or_eq 1<<i;
+                    }
+                    limitQ_ = 0;
+                    if( limitCb_ ) limitCb_( ok );
                 }
 
     //============
         public:
     //============
 
-SA  init        ()              { twi_.init( Addr_, twi_.K400 );
-                                  nrf_delay_ms( 2 ); //startup time is 2ms
+    SCA STARTUP_MS{ 2 };        //power on to first i2c access
+
+    using twi = Twi_;           //for hardware sequenced reads (Tmp117Auto)
+    SCA ADDR    { Addr_ };
+    SCA TEMP_REG{ TEMP };
+
+                                //wait = false when the caller schedules the
+                                //2ms startup time itself (Tmp117Async)
+SA  init        (bool wait = true) { 
+                                  if( isInit_ ) return; //twi init is counted, so only once
+                                  invalidate_(); //power on, registers from eeprom
+                                  twi_.init( twi_.K400 );
+                                  if( wait ) nrf_delay_ms( STARTUP_MS ); 
                                   isInit_ = true;
                                 }
 
-SA  deinit      ()              { twi_.deinit(); isInit_ = false; }
+SA  deinit      ()              { if( isInit_ ) twi_.deinit(); isInit_ = false; invalidate_(); }
 
                                 //these most likely end up in loops, so make it so it breaks
                                 //the loop if a read failure
@@ -97,7 +175,18 @@ SA  isDataReady () -> bool      { u16 s = 0;
                                   return (s bitand (1<<DATAREADY));
                                 } 
 
-SA  reset       ()              { configW( 1<<SOFTRESET ); }
+                                //ALERT pin = data ready flag, active low
+SA  alertDataReady()            { return configWbm( 1<<ALERTSEL|1<<ALERTPOL, 1<<ALERTSEL|0<<ALERTPOL ); }
+
+                                //ALERT pin = limit alert (HIGH/LOWALERT flags), active low,
+                                //flags (and pin) clear when CONFIG is read
+SA  alertLimits ()              { return configWbm( 1<<ALERTSEL|1<<ALERTPOL|1<<TAMODE, 0 ); }
+                                //read CONFIG (clears data ready, alert flags)
+SA  status      (u16& v)        { return configR( v ); }
+SA  isHighAlert (u16 v)         { return v bitand (1<<HIGHALERT); }
+SA  isLowAlert  (u16 v)         { return v bitand (1<<LOWALERT); }
+
+SA  reset       ()              { configW( 1<<SOFTRESET ); invalidate_(); }
 
 SA  continuous  ()              { return configWbm( 3<<CONVMODE, 0<<CONVMODE ); }
 SA  shutdown    ()              { return configWbm( 3<<CONVMODE, 1<<CONVMODE ); }
@@ -106,6 +195,13 @@ SA  oneShot1    ()              { return configWbm( 3<<CONVMODE|3<<AVERAGE, 3<<C
 SA  oneShot8    ()              { return configWbm( 3<<CONVMODE|3<<AVERAGE, 3<<CONVMODE|1<<AVERAGE ); }
 SA  oneShot32   ()              { return configWbm( 3<<CONVMODE|3<<AVERAGE, 3<<CONVMODE|2<<AVERAGE ); }
 SA  oneShot64   ()              { return configWbm( 3<<CONVMODE|3<<AVERAGE, 3<<CONVMODE|3<<AVERAGE ); }
+                                //averages code 0-3 (1,8,32,64)
+SA  oneShotAvg  (u8 a)          { return configWbm( 3<<CONVMODE|3<<AVERAGE, 3<<CONVMODE|(a bitand 3)<<AVERAGE ); }
+
+                                //continuous mode, conversion cycle 0-7 (with 8 averages-
+                                //125ms,125ms,250ms,500ms,1s,4s,8s,16s)
+SA  cycle       (u8 c)          { return configWbm( 3<<CONVMODE|7<<CONVCYCLE|3<<AVERAGE, 
+                                                    0<<CONVMODE|(c bitand 7)<<CONVCYCLE|1<<AVERAGE ); }
 
 SA  averageOff  ()              { return configWbm( 3<<AVERAGE, 0<<AVERAGE ); }
 SA  average8    ()              { return configWbm( 3<<AVERAGE, 1<<AVERAGE ); }
@@ -116,10 +212,53 @@ SA  eeUnlock    ()              { return write( EEUNLOCK, 0<<EUN ); }
 SA  eeLock      ()              { return write( EEUNLOCK, 1<<EUN ); }
 
 SA  id          (u16& v)        { return read( DEVICEID, v ); }
-SA  highLimit   (u16& v)        { return write( HIGHLIMIT, v ); }
-SA  lowLimit    (u16& v)        { return write( LOWLIMIT, v ); }
+SA  highLimit   (i16 v)         { return limitW( 0, v ); }
+SA  lowLimit    (i16 v)         { return limitW( 1, v ); }
 SA  tempRaw     (i16& v)        { return read( TEMP, v ); }
 
+                                //CONFIG and TEMP as 1 batch from the twim irq
+                                //(TwimQueue, EasyDMA ArrayList, the buffers
+                                //are set up once), cb(ok), then statusTemp has
+                                //the values, false = twim busy (cb not called)
+SA  statusTempAsync(void(*cb)(bool)) -> bool {
+                                  if( not isInit_ ) init();
+                                  if( queue_::addList( Addr_, batchRegs_, batchRx_ ) and queue_::run( cb ) ) return true;
+                                  queue_::clear();
+                                  return false;
+                                }
+                                //HIGH/LOWLIMIT as 1 batch from the twim irq (TwimQueue),
+                                //a limit the ic already has is skipped (cb(true)
+                                //right away if both are), cb(ok), false = twim
+                                //busy (cb not called)
+SA  limitsAsync (i16 h, i16 l, void(*cb)(bool)) -> bool {
+                                  if( not isInit_ ) init();
+                                  limitNew_[0] = h;
+                                  limitNew_[1] = l;
+                                  limitCb_ = cb;
+                                  limitQ_ = 0;
+                                  for( u8 i = 0; i < 2; i++ ){
+                                      i16 v = limitNew_[i];
+                                      if( (isLimit_ bitand (1<<i)) and limit_[i] == v ) continue;
+                                      isLimit_ and_eq compl (1<<i);
+                                      limitTx_[i][0] = HIGHLIMIT+i;
+                                      limitTx_[i][1] = v>>8;
+                                      limitTx_[i][2] = v;
+                                      queue_::add( Addr_, limitTx_[i] );
+                                      limitQ_ or_eq 1<<i;
+                                  }
+                                  if( limitQ_ == 0 ){ if( cb ) cb( true ); return true; }
+                                  if( queue_::run( limitsDone_ ) ) return true;
+                                  queue_::clear();
+                                  limitQ_ = 0;
+                                  return false;
+                                }
+                                //after a good statusTempAsync, CONFIG refreshes the shadow
+SA  statusTemp  (u16& c, i16& t) {
+                                  c = (batchRx_[0][0]<<8) bitor batchRx_[0][1];
+                                  t = (batchRx_[1][0]<<8) bitor batchRx_[1][1];
+                                  shadow_( c );
+                                }
+
 
     /*
     conversion from raw to C or F x10,x100,x1000
@@ -139,7 +278,477 @@ SA  x1000F  (i16 v) -> int32_t  { return ((v * 225L)>>4) + 32000; }
 SA  x10C    (i16 v) -> i16      { return (v * 5L)>>6; }
 SA  x100C   (i16 v) -> i16      { return (v * 25L)>>5; }
 SA  x1000C  (i16 v) -> int32_t  { return (v * 125L)>>4; }
+                                //Fx10 to raw (for limits), 9/64 F x10 per count
+SCA rawX10F (i16 f) -> i16      { return ((f - 320L) * 64)/9; }
+
+};
+
+
+/*------------------------------------------------------------------------------
+    Tmp117 acquisition profiles (Tmp117Async Profile_), hardware averaging
+    in a one-shot conversion, so 1 power up = 1 reported sample
+
+    profile         AVG  conv   charge/sample   noise (rms)   note
+    Tmp117PowerOn    8   125ms      ~17uC       ~1 lsb        no config write,
+                                                              the power on conversion
+    Tmp117Avg1       1   15.5ms     ~2.4uC      ~3 lsb        
+    Tmp117Avg8       8   125ms      ~17uC       ~1 lsb        
+    Tmp117Avg32     32   500ms      ~68uC       <1 lsb        
+    Tmp117Avg64     64   1000ms     ~135uC      <1 lsb        
+
+    1 lsb = 0.0078C (0.014F), so at 0.1F resolution any averaging profile
+    is quiet enough that a software history is not needed (NoFilter)
+    charge = 135uA active (datasheet typ) * (2ms startup + conversion),
+    the mcu side (4 i2c transfers ~100us each, 2 wakeups) adds ~1.4uC
+    noise is approximate, from the datasheet noise/repeatability figures
+
+    power policy (Tmp117Async Power_, see PowerFor in Twim.hpp)
+    gated- each read pays the 2ms startup (~0.27uC), charging the rail
+    (~0.1uF at 3V, ~0.3uC) and the startup timer wakeup (~0.15uC), ~0.72uC
+    keep- ~0.25uA in shutdown, so keep is only lower below ~3s per sample
+    Tmp117PowerFor<Profile, interval ms> picks from these
+------------------------------------------------------------------------------*/
+template<u8 Avg_, bool OneShot_ = true>
+struct Tmp117Profile {
+    static_assert( Avg_ <= 3, "Tmp117Profile Avg_ is 0-3 (1,8,32,64 averages)" );
+
+    SCA AVG         { Avg_ };
+    SCA ONESHOT     { OneShot_ };
+                    //conversion time, ms (15.5ms rounded up)
+    SCA CONV_MS     { Avg_ == 0 ? 16 : Avg_ == 1 ? 125 : Avg_ == 2 ? 500 : 1000 };
+    SCA STARTUP_MS  { 2 };  //same as Tmp117::STARTUP_MS
+    SCA ACTIVE_UA   { 135 };
+                    //charge per sample in nC (uA*ms)
+    SCA CHARGE_NC   { (u32)ACTIVE_UA * (STARTUP_MS + CONV_MS) };
+                    //noise in lsb rms x10 (approximate)
+    SCA NOISE_LSB10 { Avg_ == 0 ? 30 : Avg_ == 1 ? 10 : Avg_ == 2 ? 7 : 5 };
+                    //extra charge per read when power gated, nC
+                    //(startup + rail capacitance + timer wakeup)
+    SCA GATED_NC    { (u32)ACTIVE_UA * STARTUP_MS + 300 + 150 };
+    SCA SHUTDOWN_NA { 250 };
+};
+
+using Tmp117PowerOn = Tmp117Profile<1, false>;
+using Tmp117Avg1    = Tmp117Profile<0>;
+using Tmp117Avg8    = Tmp117Profile<1>;
+using Tmp117Avg32   = Tmp117Profile<2>;
+using Tmp117Avg64   = Tmp117Profile<3>;
+
+                    //power policy for a sample interval
+template<typename Profile_, u32 IntervalMs_>
+using Tmp117PowerFor = PowerFor< IntervalMs_, Profile_::GATED_NC, Profile_::SHUTDOWN_NA >;
+
+
+/*------------------------------------------------------------------------------
+    Tmp117Async - non-blocking read, the waits are one-shot timers (or the
+    ALERT pin) so the cpu can sleep while the ic converts
+
+    Tmp117_ = Tmp117<Twi,...>
+    Timer_  = Timer (create(cb), start(ms), stop(), cb is void(*)(void*))
+    Alert_  = Tmp117NoAlert (poll CONFIG for data ready), or the mcu pin
+              connected to ALERT (GpiotePin<...>, on(cb) -> bool, off())
+    Profile_= Tmp117PowerOn, Tmp117Avg1/8/32/64 (averages, conversion time)
+    Power_  = PowerGated (power on/off each read), PowerKeep (stays on in
+              shutdown mode, see Twim.hpp), or Tmp117PowerFor<Profile_,ms>
+
+    start(cb)   power on, timer for the 2ms startup time, if kept on (and
+                in shutdown) go straight to the conversion
+    poll()      (timer callback)
+                startup done- a one-shot conversion with the Profile_
+                averages is started (unless Tmp117PowerOn and gated, which
+                uses the power on conversion), if the Alert_ pin can be
+                used (ALERT set to data ready once per power on) wait for
+                the pin (timer is a timeout), else timer for the conversion
+                time
+                no Alert_- data ready? read raw value, power off (gated),
+                cb, else timer again for POLL_MS, up to POLL_TRIES times
+    ready_()    (Alert_ callback) read raw value (1 TEMP read), power off
+                (gated), cb
+    status()    result of the last read, raw() its raw value
+
+    Tmp117Async<Tmp117<twi>, Timer> rd;
+    rd.start( [](void*){ if( rd.status() == rd.OK ) use( rd.raw() ); } );
+
+    cb is called from the timer (or gpiote) irq, start is ignored (false)
+    if busy
+------------------------------------------------------------------------------*/
+struct Tmp117NoAlert {
+SA  on              (void(*)()) { return false; }
+SA  off             () {}
+};
+
+template<typename Tmp117_, typename Timer_, typename Alert_ = Tmp117NoAlert,
+         typename Profile_ = Tmp117PowerOn, typename Power_ = PowerGated>
+struct Tmp117Async {
+
+    enum STATUS { OK, BUSY, TIMEOUT, READFAIL, NOVALUE };
+
+//============
+    private:
+//============
+
+    enum STAGE { STARTUP, CONVERT, ALERT };
+
+    SI Timer_       timer_;
+    SI bool         isCreated_  { false };
+    SI bool         isOn_       { false };  //kept on, configured, in shutdown
+    SI STATUS       status_     { NOVALUE };
+    SI STAGE        stage_      { STARTUP };
+    SI u8           tries_      { 0 };
+    SI i16          raw_        { -32768 };
+    SI void(*cb_)(void*){ nullptr };
+
+    SCA POLL_MS     { 2 };
+    SCA POLL_TRIES  { 10 };    //20ms past the conversion time
+
+SA  done_           (STATUS s) {
+                        Alert_::off();
+                        //kept on only after a good read, a failure starts
+                        //over from a power on
+                        isOn_ = Power_::KEEP and s == OK;
+                        if( not isOn_ ) Tmp117_::deinit(); //turn off power to ic
+                        status_ = s;
+                        if( cb_ ) cb_( nullptr );
+                    }
+
+SA  readRaw_        () {
+                        if( not Tmp117_::tempRaw(raw_) ) return done_( READFAIL );
+                        done_( raw_ == -32768 ? NOVALUE : OK );
+                    }
+
+                    //ic is on, start the conversion, wait for Alert_ or the timer
+                    //(kept on- the data ready flag was cleared by the last TEMP
+                    //read, so the pin is released before anything waits on it,
+                    //the one-shot is a CONFIG write only (shadow) and the ic
+                    //returns to shutdown when done, Tmp117PowerOn too)
+SA  convert_        () -> void {
+                        auto alert = Alert_::on(ready_) and (isOn_ or Tmp117_::alertDataReady());
+                        if( not alert ) Alert_::off();
+                        if constexpr( Profile_::ONESHOT or Power_::KEEP ){
+                            if( not Tmp117_::oneShotAvg(Profile_::AVG) ) return done_( READFAIL );
+                        }
+                        stage_ = alert ? ALERT : CONVERT; //ALERT- timer is a timeout
+                        timer_.start( Profile_::CONV_MS + (alert ? POLL_MS*POLL_TRIES : 0) );
+                    }
+
+                    //Alert_ pin is low, conversion done
+SA  ready_          () {
+                        if( status_ != BUSY or stage_ != ALERT ) return;
+                        timer_.stop();
+                        readRaw_();
+                    }
+
+//============
+    public:
+//============
+
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( status_ == BUSY ) return false;
+                        if( not isCreated_ ){ timer_.create( poll ); isCreated_ = true; }
+                        cb_ = cb;
+                        status_ = BUSY;
+                        stage_ = STARTUP;
+                        tries_ = POLL_TRIES;
+                        if( isOn_ ){ convert_(); return true; } //kept on, no startup
+                        //power on, no delay, the startup time and the
+                        //conversion are waited on by the timer (or Alert_)
+                        Tmp117_::init( false );
+                        timer_.start( Tmp117_::STARTUP_MS );
+                        return true;
+                    }
+
+SA  poll            (void* = nullptr) -> void {
+                        if( status_ != BUSY ) return;
+                        if( stage_ == STARTUP ) return convert_();
+                        if( stage_ == ALERT ) return done_( TIMEOUT );
+                        if( Tmp117_::isDataReady() ) return readRaw_();
+                        if( --tries_ == 0 ) return done_( TIMEOUT );
+                        timer_.start( POLL_MS );
+                    }
+
+SA  isBusy          () { return status_ == BUSY; }
+SA  status          () { return status_; }
+SA  raw             () { return raw_; }
+
+};
+
+
+/*------------------------------------------------------------------------------
+    Tmp117Window - event driven, the ic stays powered in continuous (cycle)
+    mode with a +/-deadband window (HIGH/LOWLIMIT) around the last reported
+    value, the mcu sleeps until the ALERT pin (limit alert mode) shows the
+    temperature left the window, then reads, moves the window and calls cb
+
+    Tmp117_ = Tmp117<Twi,...>
+    Timer_  = Timer (create(cb), start(ms), stop(), cb is void(*)(void*))
+    Alert_  = mcu pin connected to ALERT (GpiotePin<...>)
+    Cycle_  = conversion cycle (Tmp117::cycle), 7 = 16s
+
+    start(deadband,cb)  power on, after the 2ms startup set the mode and a
+                        window the first conversion will be outside of
+    stop()              power off
+    raw()               last reported raw value, status() OK/READFAIL
+
+    an ALERT event reads CONFIG and TEMP as 1 async batch (statusTempAsync),
+    the window is moved from the twim irq when the batch is done
+
+    cb is called from the twim (or timer) irq, a failed read is retried
+    every RETRY_MS (the pin stays low until CONFIG is read)
+
+    ic current with 8 averages is ~135uA for 125ms per cycle, 16s = ~1uA
+------------------------------------------------------------------------------*/
+template<typename Tmp117_, typename Timer_, typename Alert_, u8 Cycle_ = 7>
+struct Tmp117Window {
+
+    enum STATUS { OK, BUSY, READFAIL, OFF };
+
+//============
+    private:
+//============
+
+    SI Timer_       timer_;
+    SI bool         isCreated_  { false };
+    SI STATUS       status_     { OFF };
+    SI i16          raw_        { -32768 };
+    SI i16          deadband_   { 0 };
+    SI u16          events_     { 0 };
+    SI bool         isReading_  { false };  //batch in flight (read, then limits)
+    SI i16          next_       { -32768 }; //read, reported once the window moved
+    SI void(*cb_)(void*){ nullptr };
+
+    SCA RETRY_MS    { 1000 };
+
+                    //limits = raw +/- deadband_, no overflow, written from the
+                    //twim irq (no blocking transfer in an irq), cb(ok) when done
+SA  window_         (i16 raw, void(*cb)(bool)) {
+                        i32 h = raw + deadband_; if( h > 32767 ) h = 32767;
+                        i32 l = raw - deadband_; if( l < -32768 ) l = -32768;
+                        return Tmp117_::limitsAsync( h, l, cb );
+                    }
+
+                    //startup done, or a retry
+SA  timer_cb_       (void*) {
+                        if( status_ == OFF ) return;
+                        if( status_ == BUSY ){ //startup time done
+                            //high limit below anything, so first conversion alerts
+                            if( not Tmp117_::alertLimits() or not Tmp117_::highLimit( -32768 ) or
+                                not Tmp117_::lowLimit( -32768 ) or not Tmp117_::cycle( Cycle_ ) ){
+                                timer_.start( RETRY_MS );
+                                return;
+                            }
+                            status_ = OK;
+                            Alert_::on( event_ );
+                            return;
+                        }
+                        event_(); //READFAIL retry
+                    }
+
+SA  fail_           () {
+                        status_ = READFAIL;
+                        timer_.start( RETRY_MS );
+                    }
+
+                    //limit writes done (twim irq), report the new value
+SA  moved_          (bool ok) -> void {
+                        isReading_ = false;
+                        if( status_ == OFF ) return;
+                        if( not ok ) return fail_();
+                        status_ = OK;
+                        raw_ = next_;
+                        events_++;
+                        if( cb_ ) cb_( nullptr );
+                        //a conversion alerted while the batch was in flight
+                        //(the pin is low, no new PORT event)
+                        if( Alert_::isActive() ) event_();
+                    }
+
+                    //CONFIG,TEMP batch done (twim irq), move the window
+SA  read_           (bool ok) -> void {
+                        if( status_ == OFF ){ isReading_ = false; return; }
+                        u16 c;
+                        if( ok ) Tmp117_::statusTemp( c, next_ );
+                        if( ok and window_(next_, moved_) ) return;
+                        isReading_ = false;
+                        fail_();
+                    }
+
+                    //ALERT pin low
+SA  event_          () {
+                        if( status_ == OFF or status_ == BUSY or isReading_ ) return;
+                        //CONFIG read clears the alert flags (pin released)
+                        isReading_ = true;
+                        if( Tmp117_::statusTempAsync( read_ ) ) return;
+                        isReading_ = false;
+                        fail_();
+                    }
+
+//============
+    public:
+//============
+
+                    //deadband is in raw counts (Tmp117::rawX10F(5)-rawX10F(0) for 0.5F)
+SA  start           (i16 deadband, void(*cb)(void*) = nullptr) -> bool {
+                        if( status_ != OFF ) return false;
+                        if( not isCreated_ ){ timer_.create( timer_cb_ ); isCreated_ = true; }
+                        deadband_ = deadband;
+                        cb_ = cb;
+                        status_ = BUSY;
+                        Tmp117_::init( false );
+                        timer_.start( Tmp117_::STARTUP_MS );
+                        return true;
+                    }
+
+SA  stop            () {
+                        if( status_ == OFF ) return;
+                        timer_.stop();
+                        Alert_::off();
+                        Tmp117_::deinit();
+                        status_ = OFF;
+                    }
+
+SA  isOn            () { return status_ != OFF; }
+SA  status          () { return status_; }
+SA  raw             () { return raw_; }
+SA  events          () { return events_; }
 
 };
 
 
+/*------------------------------------------------------------------------------
+    Tmp117Auto - hardware sequenced, no cpu per sample
+
+    the ic converts on its own (continuous, Cycle_) with ALERT = data ready,
+    the ALERT pin (SENSE low) PORT event starts the twim through PPI (TEMP
+    read, LASTTX_STARTRX_STOP), reading TEMP releases ALERT, the rx EasyDMA
+    list moves each result to the next slot of a ring, each STOPPED counts
+    in PpiCounter and the cpu wakes (cb) once every N_ samples
+    a nack is stopped through PPI (ERROR -> STOP), its slot keeps -32768
+
+    Tmp117_ = Tmp117<Twi,...>
+    Pin_    = mcu pin connected to ALERT (Gpio<...>)
+    N_      = samples per wakeup
+    Cycle_  = conversion cycle (Tmp117::cycle), 5 = 4s
+
+    start(cb)   power on, ic/twim/ppi/counter setup, false if not enough ppi
+                channels or the ic setup failed (all undone)
+    stop()      all undone, power off
+    check()     restart if no wakeup since the last check, a failed read
+                leaves ALERT low (no more PORT events), call at a period
+                longer than N_ samples
+    raw(i)      sample i (0 = oldest) of the last N_, -32768 = failed
+
+    cb is called from the TIMER1 irq, the twim is reserved while on (the
+    rail stays on, other ic's on the twim cannot be read)
+
+    the nRF52810 has no free rtc (RTC0 softdevice, RTC1 app_timer) and a
+    periodic rtc compare would need the cpu to move CC, so the period is
+    the ic conversion cycle (~1uA at 16s, 8 averages)
+------------------------------------------------------------------------------*/
+template<typename Tmp117_, typename Pin_, u8 N_ = 5, u8 Cycle_ = 5>
+struct Tmp117Auto {
+
+//============
+    private:
+//============
+
+    using twi_ = typename Tmp117_::twi;
+
+    SI u8           ring_[N_][2];
+    SI i16          raw_[N_];
+    SI const u8     tx_[1]      { Tmp117_::TEMP_REG };
+    SI i8           ch_[3]      { -1, -1, -1 };
+    SI bool         isOn_       { false };
+    SI u16          wakes_      { 0 };
+    SI u16          checked_    { 0 };
+    SI void(*cb_)(void*){ nullptr };
+
+                    //ring back to the first slot, -32768 in each
+SA  arm_            () {
+                        for( auto& r : ring_ ){ r[0] = 0x80; r[1] = 0; }
+                        twi_::rxBufferSet( addr32(ring_), 2 );
+                    }
+
+                    //PpiCounter callback, N_ samples in the ring
+SA  full_           () {
+                        for( auto i = 0; i < N_; i++ ) raw_[i] = (ring_[i][0]<<8) bitor ring_[i][1];
+                        arm_();
+                        wakes_++;
+                        if( cb_ ) cb_( nullptr );
+                    }
+
+SA  ppiFree_        () { for( auto& c : ch_ ){ Ppi::free( c ); c = -1; } }
+
+//============
+    public:
+//============
+
+SA  start           (void(*cb)(void*) = nullptr) -> bool {
+                        if( isOn_ ) return false;
+                        if( Ppi::available() < 3 ) return false;
+                        Tmp117_::init(); //2ms startup
+                        //blocking config writes, before the twim is reserved
+                        if( not Tmp117_::alertDataReady() or not Tmp117_::cycle( Cycle_ ) ){
+                            Tmp117_::deinit();
+                            return false;
+                        }
+                        cb_ = cb;
+                        //the ppi starts use ADDRESS as is, so only set once the
+                        //twim is ours (not in the middle of an async transfer)
+                        if( twi_::isBusy() ){
+                            Tmp117_::deinit();
+                            return false;
+                        }
+                        for( auto& r : raw_ ) r = -32768;
+                        twi_::reserve( true );
+                        twi_::irqAllOff(); //no cpu wakeup per transfer
+                        twi_::address( Tmp117_::ADDR );
+                        twi_::txBufferSet( tx_ );
+                        twi_::rxList( true );
+                        arm_();
+                        twi_::clearEvents();
+                        twi_::shortsSetup( twi_::LASTTX_STARTRX_STOP );
+                        PpiCounter::start( N_, full_ );
+                        ch_[0] = Ppi::connect( Gpiote::reg.EVENTS_PORT, twi_::reg.TASKS.STARTTX );
+                        ch_[1] = Ppi::connect( twi_::reg.EVENTS.STOPPED, PpiCounter::count() );
+                        ch_[2] = Ppi::connect( twi_::reg.EVENTS.ERROR, twi_::reg.TASKS.STOP );
+                        if( ch_[0] < 0 or ch_[1] < 0 or ch_[2] < 0 ){
+                            isOn_ = true;
+                            stop();
+                            return false;
+                        }
+                        for( auto c : ch_ ) Ppi::enable( c );
+                        isOn_ = true;
+                        //sense last, if ALERT is already low the PORT event is now
+                        Pin_::init( INPUT, PULLUP, SENSELO );
+                        return true;
+                    }
+
+SA  stop            () {
+                        if( not isOn_ ) return;
+                        Pin_::init(); //default, disconnected input, sense off
+                        ppiFree_();
+                        PpiCounter::stop();
+                        twi_::shortsSetup( twi_::ALL_OFF );
+                        twi_::rxList( false );
+                        twi_::reserve( false );
+                        Tmp117_::shutdown();
+                        Tmp117_::deinit();
+                        isOn_ = false;
+                    }
+
+                    //false = was stalled (restarted)
+SA  check           () -> bool {
+                        if( not isOn_ ) return false;
+                        if( wakes_ != checked_ ){ checked_ = wakes_; return true; }
+                        auto cb = cb_;
+                        stop();
+                        start( cb );
+                        return false;
+                    }
+
+SA  isOn            () { return isOn_; }
+SA  raw             (u8 i) { return i < N_ ? raw_[i] : -32768; }
+SA  wakes           () { return wakes_; }
+SCA size            () { return N_; }
+
+};
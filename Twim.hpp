@@ -3,15 +3,402 @@
 //TODO - clearing events and clearing interrupts can take up to 4 cycles
 //so I guess can get into situation where exit isr before event is cleared
 //or irq is cleared, although seems unlikely
-//
+//(isr flushes the event clear with a read back)
 
 
 #include "nRFconfig.hpp"
 
 #include "nrf_delay.h"
+#include "nrf_nvic.h"   //sd_nvic_*, softdevice owns the nvic
 
 #include "Gpio.hpp"
 #include "Print.hpp"
+#include "Profile.hpp"
+#include "Deadline.hpp"
+
+#undef SA
+#define SA [[gnu::noinline]] static auto
+
+/*------------------------------------------------------------------------------
+    TwimCore - the transfer engine, not a template so there is one copy
+    for every Twim<...> (any pins, any buffer sizes), buffers are addr + len
+    (a len of 0 = none, so write only or read only)
+
+    Bus = state of one twim peripheral, twimBus<BaseAddr_> (below) is the
+    one shared by all Twim<BaseAddr_,...>
+
+    transfer        blocking, sleeps until done
+    transferAsync   cb(ok) from the twim irq, false = busy (cb not called)
+    nextAsync       the last async transfer again (EasyDMA ArrayList)
+
+    the slave address is an argument of each transfer, ADDRESS is only
+    written once the bus is known to be free (a shared bus, a transfer
+    refused as busy leaves the one in flight alone)
+
+    every transfer has a deadline (Bus::timeoutUs, TIMER2 Deadline), on a
+    timeout the twim is disabled and the bus is recovered (Bus::recover,
+    Twim::busRecover clocks SCL until a slave lets go of SDA), so a read
+    is bounded by timeoutUs + ~100us
+    if SDA is still held low (slave browned out), the bus is marked stuck
+    and each later transfer only tries the recovery again (~100us) and
+    fails without starting, until SDA is released (a recovery that gets
+    SDA back, a transfer that completes ok, or a power cycle clears it)
+
+    an async transfer uses a Deadline cb channel of its own (1 = TWIM0,
+    2 = TWIM1), so both buses can run async transfers at the same time,
+    and a blocking transfer on one (Deadline ch 0) while the other is in
+    flight does not disturb it
+
+    Stats per bus: transfers, nacks, timeouts, recoveries, stuck (refused,
+    SDA low), max and a log2 histogram of the durations for p99
+------------------------------------------------------------------------------*/
+struct TwimCore {
+
+    struct Regs; //forward declare register struct, at end
+
+    SCA IRQPRI_     { 6 };  //APP_IRQ_PRIORITY_LOW, same as app_timer/gpiote
+    SCA STOP_INTS_  { 1u<<1 bitor 1u<<9 }; //INTEN STOPPED, ERROR
+    SCA LASTTX_STARTRX_STOP_{ 1u<<7 bitor 1u<<12 };
+    SCA LASTTX_STOP_{ 1u<<9 };
+    SCA LASTRX_STOP_{ 1u<<12 };
+
+    struct Bus;
+
+                    //for the twim irq handlers (extern "C", at end), index
+                    //0/1 = TWIM0/1, only set by an async start so the isr is
+                    //not linked in when not used
+    SI void     (*isr_)(Bus&){ nullptr };
+    SI Bus*     irqBus_[2]{};
+
+    SCA HIST_N      { 16 };         //log2 buckets, last is 16ms and up
+
+    struct Stats {
+        u32     transfers   { 0 };
+        u32     nacks       { 0 };
+        u32     timeouts    { 0 };
+        u32     recoveries  { 0 };      //SDA released by the recovery
+        u32     stuck       { 0 };      //refused, SDA still low
+        u32     maxUs       { 0 };
+        u16     hist[HIST_N]{};         //bucket n = us < 2^n (saturates)
+    };
+
+    struct Bus {
+        u32     base;
+        u8      irqn;
+        u32     timeoutUs   { 20000 };
+        u16     txN         { 0 };      //expected amounts, 0 = none
+        u16     rxN         { 0 };
+        bool    isBusy      { false };  //async in progress (or reserved)
+        bool    isError     { false };
+        bool    isStuck     { false };  //SDA low after a recovery
+        void    (*cb)(bool) { nullptr };
+        i8      (*recover)(){ nullptr };//Twim::busRecover (pins)
+        Stats   stats{};
+    };
+
+SA  reg             (Bus& b) -> volatile Regs& { return *(reinterpret_cast<Regs*>(b.base)); }
+SA  index           (Bus& b) -> u8 { return b.irqn - 3; } //irqBus_, 0/1
+SA  deadlineCh      (Bus& b) -> u8 { return index( b ) + 1; }
+
+                    //a transfer done (any result)
+SA  record          (Bus& b, u32 us) {
+                        auto& s = b.stats;
+                        s.transfers++;
+                        if( us > s.maxUs ) s.maxUs = us;
+                        u8 n = us ? 32 - __builtin_clz( us ) : 0;
+                        if( n >= HIST_N ) n = HIST_N-1;
+                        if( s.hist[n] != 0xFFFF ) s.hist[n]++;
+                    }
+
+                    //error event, ERRORSRC counted and cleared, stop
+SA  error           (Bus& b) {
+                        auto& r = reg( b );
+                        if( r.ERRORSRC bitand 6 ) b.stats.nacks++; //ANACK, DNACK
+                        r.ERRORSRC = 7;
+                        r.EVENTS.ERROR = 0;
+                        r.TASKS.STOP = 1; //STOPPED follows
+                    }
+
+                    //us that 99% of the transfers are under (a bucket
+                    //edge, 2^n, or maxUs if lower), 0 = none
+SA  p99             (Bus& b) -> u32 {
+                        auto& s = b.stats;
+                        u32 total = 0;
+                        for( auto h : s.hist ) total += h;
+                        if( total == 0 ) return 0;
+                        u32 over = 0;
+                        for( auto n = HIST_N-1; n > 0; n-- ){
+                            over += s.hist[n];
+                            if( over*100 > total ) return n == HIST_N-1 or s.maxUs < (1u<<n) ? s.maxUs : 1u<<n;
+                        }
+                        return 1;
+                    }
+
+                    //disable aborts a transfer
+SA  reEnable        (Bus& b) {
+                        auto& r = reg( b );
+                        r.ENABLE = 0;
+                        r.ERRORSRC = 7;
+                        r.EVENTS.ERROR = 0;
+                        r.SHORTS = 0;
+                        r.ENABLE = 6;
+                    }
+
+                    //twim off (pins are gpio), SCL clocked until SDA is
+                    //released, twim back on, false = SDA still low
+SA  recover         (Bus& b) -> bool {
+                        auto& r = reg( b );
+                        r.ENABLE = 0;
+                        auto n = b.recover ? b.recover() : 0;
+                        if( n > 0 ) b.stats.recoveries++;
+                        b.isStuck = n < 0;
+                        reEnable( b );
+                        return not b.isStuck;
+                    }
+
+                    //deadline passed, abort and recover the bus
+SA  timeout         (Bus& b) {
+                        b.stats.timeouts++;
+                        recover( b );
+                    }
+
+                    //address, buffers (lengths kept for isComplete/start)
+SA  setup           (Bus& b, u8 addr, u32 tx, u16 ntx, u32 rx, u16 nrx) {
+                        auto& r = reg( b );
+                        r.ADDRESS = addr;
+                        b.txN = ntx; b.rxN = nrx;
+                        if( ntx ){ r.TXD.MAXCNT = ntx; r.TXD.PTR = tx; }
+                        if( nrx ){ r.RXD.MAXCNT = nrx; r.RXD.PTR = rx; }
+                    }
+
+                    //events cleared, shorts for the lengths, start
+SA  start           (Bus& b) {
+                        auto& r = reg( b );
+                        auto ntx = b.txN;
+                        auto nrx = b.rxN;
+                        r.ERRORSRC = 7;
+                        r.EVENTS.ERROR = 0;
+                        r.EVENTS.STOPPED = 0;
+                        r.EVENTS.SUSPENDED = 0;
+                        r.EVENTS.RXSTARTED = 0;
+                        r.EVENTS.TXSTARTED = 0;
+                        r.EVENTS.LASTRX = 0;
+                        r.EVENTS.LASTTX = 0;
+                        r.SHORTS = ntx and nrx ? LASTTX_STARTRX_STOP_ : ntx ? LASTTX_STOP_ : LASTRX_STOP_;
+                        if( ntx ) r.TASKS.STARTTX = 1; else r.TASKS.STARTRX = 1;
+                    }
+
+                    //amounts are what was asked for, else unknown error, reset twi
+SA  isComplete      (Bus& b) -> bool {
+                        auto& r = reg( b );
+                        if( (b.txN == 0 or r.TXD.AMOUNT == b.txN) and
+                            (b.rxN == 0 or r.RXD.AMOUNT == b.rxN) ) return true;
+                        reEnable( b );
+                        return false;
+                    }
+
+                    //sleep (__WFE) until stopped or the deadline, the twim irq
+                    //stays disabled in the nvic, its pending irq (STOPPED/ERROR)
+                    //wakes the cpu (Deadline sets SEVONPEND)
+                    //false = error (nack) or timeout (twim disabled to abort)
+SA  waitForStop     (Bus& b) -> bool {
+                        auto& r = reg( b );
+                        auto ok = true;
+                        auto isTimeout = false;
+                        Deadline::start( b.timeoutUs );
+                        r.INTENSET = STOP_INTS_;
+                        while( true ){
+                            sd_nvic_ClearPendingIRQ( (IRQn_Type)b.irqn ); //so next event pends again
+                            if( r.EVENTS.ERROR ){
+                                error( b );
+                                ok = false;
+                            }
+                            if( r.EVENTS.STOPPED ) break;
+                            if( Deadline::isExpired() ){
+                                isTimeout = true;
+                                ok = false;
+                                break;
+                            }
+                            __WFE();
+                        }
+                        r.INTENCLR = STOP_INTS_;
+                        sd_nvic_ClearPendingIRQ( (IRQn_Type)b.irqn );
+                        record( b, Deadline::stop() );
+                        if( isTimeout ) timeout( b ); //after the deadline is stopped
+                        return ok;
+                    }
+
+                    //false without a start when the bus is stuck (SDA low)
+SA  isUsable        (Bus& b) -> bool {
+                        if( not b.isStuck or recover( b ) ) return true;
+                        b.stats.stuck++;
+                        return false;
+                    }
+
+                    //blocking, sleeps until done
+SA  transfer        (Bus& b, u8 addr, u32 tx, u16 ntx, u32 rx, u16 nrx) -> bool {
+                        if( b.isBusy or not isUsable( b ) ) return false;
+                        setup( b, addr, tx, ntx, rx, nrx );
+                        start( b );
+                        auto ok = waitForStop( b ) and isComplete( b );
+                        if( ok ) b.isStuck = false; //a good transfer, the bus works
+                        return ok;
+                    }
+
+                    //Deadline cb, async transfer did not stop in time
+SA  asyncTimeout    (u8 ch) -> void {
+                        auto bp = irqBus_[ch-1];
+                        if( not bp or not bp->isBusy ) return;
+                        auto& b = *bp;
+                        reg( b ).INTENCLR = STOP_INTS_;
+                        sd_nvic_DisableIRQ( (IRQn_Type)b.irqn );
+                        sd_nvic_ClearPendingIRQ( (IRQn_Type)b.irqn );
+                        record( b, b.timeoutUs );
+                        timeout( b );
+                        b.isBusy = false;
+                        if( b.cb ) b.cb( false );
+                    }
+
+                    //start (buffers already set up), irq on- the events are
+                    //cleared by start first, a blocking transfer leaves
+                    //STOPPED set, which would fire the irq right away (a
+                    //transfer done before INTENSET still pends the irq, the
+                    //line is a level)
+SA  startAsync      (Bus& b, void(*cb)(bool)) {
+                        b.cb = cb;
+                        b.isError = false;
+                        b.isBusy = true;
+                        isr_ = isr;
+                        irqBus_[index(b)] = &b;
+                        sd_nvic_ClearPendingIRQ( (IRQn_Type)b.irqn );
+                        sd_nvic_SetPriority( (IRQn_Type)b.irqn, IRQPRI_ );
+                        Deadline::start( deadlineCh(b), b.timeoutUs, asyncTimeout );
+                        start( b );
+                        reg( b ).INTENSET = STOP_INTS_;
+                        sd_nvic_EnableIRQ( (IRQn_Type)b.irqn );
+                    }
+
+SA  transferAsync   (Bus& b, u8 addr, u32 tx, u16 ntx, u32 rx, u16 nrx, void(*cb)(bool)) -> bool {
+                        if( b.isBusy or not isUsable( b ) ) return false;
+                        setup( b, addr, tx, ntx, rx, nrx );
+                        startAsync( b, cb );
+                        return true;
+                    }
+
+                    //the last async transfer again (same slave, lengths), only
+                    //a start, with list(true) the buffers are the next
+                    //ArrayList element (the twim moved PTR)
+SA  nextAsync       (Bus& b, void(*cb)(bool)) -> bool {
+                        if( b.txN == 0 and b.rxN == 0 ) return false;
+                        if( b.isBusy or not isUsable( b ) ) return false;
+                        startAsync( b, cb );
+                        return true;
+                    }
+
+                    //from the twim irq
+SA  isr             (Bus& b) -> void {
+                        auto& r = reg( b );
+                        if( r.EVENTS.ERROR ){
+                            error( b );
+                            b.isError = true;
+                        }
+                        if( not r.EVENTS.STOPPED ) return;
+                        r.EVENTS.STOPPED = 0;
+                        (void)r.EVENTS.STOPPED; //flush write before return
+                        r.INTENCLR = STOP_INTS_;
+                        sd_nvic_DisableIRQ( (IRQn_Type)b.irqn );
+                        record( b, Deadline::stop(deadlineCh(b)) );
+                        auto ok = not b.isError and isComplete( b );
+                        if( ok ) b.isStuck = false; //a good transfer, the bus works
+                        b.isBusy = false;
+                        if( b.cb ) b.cb( ok );
+                    }
+
+//------------
+//  registers
+//------------
+
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+
+    struct Regs {
+        struct {
+                u32 STARTRX;        //0x00
+                u32 unused1;
+                u32 STARTTX;        //0x08
+                u32 unused2[2];
+                u32 STOP;           //0x14
+                u32 unused3;
+                u32 SUSPEND;        //0x1C
+                u32 RESUME;         //0x20
+        }   TASKS;
+
+        u32 unused4[(0x104-0x24)/4]; 
+
+        struct {
+                u32 STOPPED;            //0x104
+                u32 unused5[(0x124-0x108)/4];
+                u32 ERROR;              //0x124
+                u32 unused6[(0x148-0x128)/4];
+                u32 SUSPENDED;          //0x148
+                u32 RXSTARTED;          //0x14C
+                u32 TXSTARTED;          //0x150
+                u32 unused7[2];
+                u32 LASTRX;             //0x15C
+                u32 LASTTX;             //0x160
+        }   EVENTS;
+
+        u32 unused8[(0x200-0x164)/4];
+
+        u32 SHORTS;             //0x200
+        u32 unused9[(0x300-0x204)/4];
+        u32 INTEN;              //0x300
+        u32 INTENSET;           //0x304
+        u32 INTENCLR;           //0x308
+        u32 unused10[(0x4C4-0x30C)/4];
+        u32 ERRORSRC;           //0x4C4
+        u32 unused11[(0x500-0x4C8)/4];
+        u32 ENABLE;             //0x500
+        u32 unused12;
+        u32 PSEL_SCL;           //0x508
+        u32 PSEL_SDA;           //0x50C
+        u32 unused13[(0x524-0x510)/4];
+        u32 FREQUENCY;          //0x524
+
+        u32 unused14[(0x534-0x528)/4];
+
+        struct {
+                u32 PTR;        //0x534
+                u32 MAXCNT;
+                u32 AMOUNT;     //RO
+                u32 LIST;
+        }   RXD;
+        struct {
+                u32 PTR;        //0x544
+                u32 MAXCNT;
+                u32 AMOUNT;     //RO
+                u32 LIST;
+        }   TXD;
+
+        u32 unused15[(0x588-0x554)/4];
+        u32 ADDRESS;            //0x588
+    };
+    #pragma GCC diagnostic pop
+
+};
+
+#undef SA
+#define SA static auto
+
+                    //one per twim peripheral, irq number from the address
+                    //0x40003000 = 3, 0x40004000 = 4
+template<u32 BaseAddr_>
+inline TwimCore::Bus twimBus{ BaseAddr_, (BaseAddr_>>12) bitand 0x3F };
+
+                    //users of a power pin, counted across buses (sensors on
+                    //TWIM0 and TWIM1 can share one power pin)
+template<PIN Pwr_>
+inline u8 twimPowerUsers{ 0 };
 
 /*------------------------------------------------------------------------------
     Twim struct (TWI master)
@@ -26,6 +413,9 @@
     option (see enum), the nRF52840 also has a 'simple' Twi chapter (no 
     Easy-DMA) using ENABLE = 5, that the nRF52810 does not show, but they
     most likely both will work with the code below (only tested on a nRF52810)
+
+    the transfers are thin wrappers of TwimCore (addr + len), so buffer
+    sizes and pins do not make more copies of the transfer code
 ------------------------------------------------------------------------------*/
 template<u32 BaseAddr_, PIN Sda_, PIN Scl_, PIN Pwr_>
 struct Twim {
@@ -34,7 +424,11 @@ struct Twim {
     protected:
 //============
 
-    struct Twim_; //forward declare register struct, at end
+    using Twim_ = TwimCore::Regs;
+
+    SI u8 users_{ 0 }; //init'd users, power/twi off when last one deinit's
+
+    static inline TwimCore::Bus& bus_{ twimBus<BaseAddr_> };
 
 //============
     public:
@@ -49,9 +443,13 @@ struct Twim {
                   LASTTX_STARTRX_STOP = LASTTX_STARTRX|LASTRX_STOP,
                   ALL_OFF = 0
                  }; 
-    enum INT    { STOPPED, ERROR, SUSPENDED, RXSTARTED, TXSTARTED, LASTRX, LASTTX };
+                //INTEN bit positions
+    enum INT    { STOPPED = 1, ERROR = 9, SUSPENDED = 18, RXSTARTED = 19, TXSTARTED = 20,
+                  LASTRX = 23, LASTTX = 24 };
     enum FREQ   { K100 = 0x01980000, K250 = 0x04000000, K400 = 0x06400000 };
 
+    SCA BASE    { BaseAddr_ }; //which bus (board mapping, Boards.hpp)
+
     //give public access to registers
     static inline volatile Twim_& reg { *(reinterpret_cast<Twim_*>(BaseAddr_)) };
 
@@ -61,7 +459,7 @@ struct Twim {
 private: //have to go through init (or throught init via the constructor)
          //so will get the address, frequency, pins setup
 SA  enable          ()          { reg.ENABLE = 6; }
-SA  reEnable        ()          { disable(); clearError(); shortsSetup(ALL_OFF); enable(); }
+SA  reEnable        ()          { TwimCore::reEnable( bus_ ); }
 
 public:
 SA  disable         ()          { reg.ENABLE = 0; }
@@ -82,7 +480,7 @@ SA  txBufferSet     (u32 addr, u16 len) {
 
                     template<unsigned N>
 SA  txBufferSet     (const u8 (&addr)[N]) {
-                        txBufferSet( (u32)addr, N );
+                        txBufferSet( addr32(addr), N );
                     }
 
 SA  rxBufferSet     (u32 addr, u16 len) {
@@ -94,9 +492,14 @@ SA  rxBufferSet     (u32 addr, u16 len) {
                     template<typename T, unsigned N>
 SA  rxBufferSet     (T (&addr)[N]) {
                         static_assert(sizeof(T) == 1, "Twi::rxBufferSet needs a byte array");
-                        rxBufferSet( (u32)addr, N );
+                        rxBufferSet( addr32(addr), N );
                     }
 
+                    //EasyDMA ArrayList, PTR moves on by MAXCNT after each
+                    //transfer, so the next start uses the next element
+SA  list            (bool on)   { reg.TXD.LIST = on; reg.RXD.LIST = on; }
+SA  rxList          (bool on)   { reg.RXD.LIST = on; }
+
 SA  txAmount        ()          { return reg.TXD.AMOUNT; }
 SA  rxAmount        ()          { return reg.RXD.AMOUNT; }
 
@@ -183,8 +586,12 @@ SA  isDataNack      ()          { return reg.ERRORSRC bitand 4; }
 //--------------------
 //  init/constructors
 //--------------------
-SA  init            (u8 addr, FREQ f = K400) { 
-                        address( addr );
+                    //more than 1 slave can init (shared power pin), only the
+                    //first does the init (frequency is from the first init),
+                    //the slave address is given with each transfer
+SA  init            (FREQ f = K400) { 
+                        if( users_++ ) return; //already on
+                        bus_.recover = busRecover;
                         frequency( f );  
                         //when twi not enabled, set pins gpio state like twi
                         Gpio<Sda_>::init( INPUT, S0D1, PULLUP );
@@ -193,25 +600,65 @@ SA  init            (u8 addr, FREQ f = K400) {
                         pinSda( Sda_ );
                         pinScl( Scl_ ); 
                         //if a power pin specified, turn on to power twi slave
+                        //(first user of the pin on any bus)
                         if constexpr( Pwr_ != PIN(-1) ){
-                            Gpio<Pwr_>::init( OUTPUT, S0H1 );
-                            Gpio<Pwr_>::on();
+                            if( not twimPowerUsers<Pwr_>++ ){
+                                Gpio<Pwr_>::init( OUTPUT, S0H1 );
+                                Gpio<Pwr_>::on();
+                            }
                         }
                         enable(); 
                     }
 
 SA  deinit          () { 
+                        if( users_ == 0 or --users_ ) return; //still in use
                         disable();
                         //if a power pin specified, turn off power to twi slave
-                        if constexpr( Pwr_ != -1 ){
+                        //(last user of the pin on any bus)
+                        if constexpr( Pwr_ != PIN(-1) ){
+                            if( --twimPowerUsers<Pwr_> ) return; //other bus still on
                             Gpio<Pwr_>::off();
                             //and twi pins back to default so no pullups driving anything
                             Gpio<Sda_>::init();
                             Gpio<Scl_>::init();
+                            bus_.isStuck = false; //slave is reset by the power cycle
+                        }
+                    }
+
+                    //twim disabled (pins are gpio), a slave holding SDA low
+                    //(reset or brownout in the middle of a byte) is clocked
+                    //(SCL, 100kHz) until it lets go, up to 9 clocks, then a STOP
+                    //returns the clocks used, 0 = SDA was not low, -1 = still low
+SA  busRecover      () -> i8 {
+                        Gpio<Sda_>::init( INPUT, S0D1, PULLUP );
+                        Gpio<Scl_>::init( OUTPUT, S0D1, PULLUP ); //init sets it low
+                        Gpio<Scl_>::high();
+                        nrf_delay_us( 5 );
+                        if( Gpio<Sda_>::isHigh() ){
+                            Gpio<Scl_>::init( INPUT, S0D1, PULLUP );
+                            return 0;
+                        }
+                        i8 n = 0;
+                        while( n < 9 and Gpio<Sda_>::isLow() ){
+                            Gpio<Scl_>::low();  nrf_delay_us( 5 );
+                            Gpio<Scl_>::high(); nrf_delay_us( 5 );
+                            n++;
+                        }
+                        if( Gpio<Sda_>::isLow() ) n = -1;
+                        else { //STOP, SDA low to high while SCL is high
+                            Gpio<Scl_>::low();
+                            Gpio<Sda_>::low();
+                            Gpio<Sda_>::init( OUTPUT, S0D1, PULLUP ); nrf_delay_us( 5 );
+                            Gpio<Scl_>::high(); nrf_delay_us( 5 );
+                            Gpio<Sda_>::high(); nrf_delay_us( 5 );
                         }
+                        //same as init, twim takes the pins when enabled
+                        Gpio<Sda_>::init( INPUT, S0D1, PULLUP );
+                        Gpio<Scl_>::init( INPUT, S0D1, PULLUP );
+                        return n;
                     }
 
-    Twim            (u8 addr, FREQ f = K100) { init( addr, f ); }
+    Twim            (FREQ f) { init( f ); }
     Twim            (){} //call init manually
 
 
@@ -219,134 +666,96 @@ SA  deinit          () {
 //  tx/rx functions
 //--------------------
 
-//TODO - add timeouts so if something wrong we don't block forever
-
-SA  waitForStop     () {
-                        while( not isStopped() ){
-                            if( isError() ){
-                                stop();
-                                while( not isStopped() ){}
-                                //DebugFuncHeader();
-                                //DebugRtt << FG ORANGE "  twim xfer ERRORSRC:" WHITE " "
-                                //  << hex << setfill('0') << showbase << setw(8) << reg.ERRORSRC << endl << clear;
-                                return false;
-                            }
-                        }
-                        return true;
+                    //transfer deadline, blocking and async (clock stretching
+                    //included, Si7051 hold master is up to 11ms)
+SA  timeout         (u32 us)    { bus_.timeoutUs = us; }
+SA  isBusy          ()          { return bus_.isBusy; }
+                    //twim used by hardware (ppi), other transfers are refused
+SA  reserve         (bool on)   { bus_.isBusy = on; }
+
+                    //after a start, sleeps until stopped or the timeout
+                    //false = error (nack) or timeout (twim disabled to abort)
+SA  waitForStop     ()          { return TwimCore::waitForStop( bus_ ); }
+
+                    //per bus (all Twim<BaseAddr_,...> share it)
+SA  stats           () -> const TwimCore::Stats& { return bus_.stats; }
+SA  statsClear      ()          { bus_.stats = {}; }
+SA  p99Us           ()          { return TwimCore::p99( bus_ ); }
+SA  isStuck         ()          { return bus_.isStuck; }
+SA  statsReport     () {
+                        auto& s = bus_.stats;
+                        DebugLogHeader(DBG_TWIM, DBG_INFO) << "  twim xfers: " << s.transfers
+                            << " nacks: " << s.nacks << " timeouts: " << s.timeouts
+                            << " recoveries: " << s.recoveries << " stuck: " << s.stuck
+                            << " p99: " << p99Us() << "us max: " << s.maxUs << "us" << endl;
+                    }
+
+                    //slave address first (0-127), addr/len versions, len is
+                    //used as-is, 0 = none
+SA  writeRead       (u8 sa, u32 tx, u16 ntx, u32 rx, u16 nrx) -> bool {
+                        ProfileScope ps{ PROF_TWIM_WRITEREAD };
+                        return TwimCore::transfer( bus_, sa, tx, ntx, rx, nrx );
                     }
+SA  write           (u8 sa, u32 tx, u16 ntx) -> bool { return TwimCore::transfer( bus_, sa, tx, ntx, 0, 0 ); }
+SA  read            (u8 sa, u32 rx, u16 nrx) -> bool { return TwimCore::transfer( bus_, sa, 0, 0, rx, nrx ); }
 
                     //write,read
                     template<typename T, unsigned NT, unsigned NR>
-                    // [[ gnu::noinline ]]
-SA  writeRead       (const u8 (&txbuf)[NT], T (&rxbuf)[NR]) {  
-                        txBufferSet( txbuf );
-                        rxBufferSet( rxbuf );
-                        startTxRxStop(); 
-                        if( not waitForStop() ) return false;
-                        if( (txAmount() == NT) and (rxAmount() == NR) ) return true;
-                        //unknown error, reset twi
-                        reEnable();
-                        return false;
+SA  writeRead       (u8 sa, const u8 (&txbuf)[NT], T (&rxbuf)[NR]) {  
+                        static_assert(sizeof(T) == 1, "Twi::writeRead needs a byte array");
+                        return writeRead( sa, addr32(txbuf), NT, addr32(rxbuf), NR );
                     }
 
                     //write only
                     template<unsigned N>
-SA  write           (const u8 (&txbuf)[N]) {
-                        txBufferSet( txbuf );
-                        startTxStop();
-                        if( not waitForStop() ) return false;
-                        if( txAmount() == N ) return true;
-                        //unknown error, reset twi
-                        reEnable();
-                        return false;
-                    }
+SA  write           (u8 sa, const u8 (&txbuf)[N]) { return write( sa, addr32(txbuf), N ); }
 
                     //read only
                     template<typename T, unsigned N>
-SA  read            (T (&rxbuf)[N]) {
-                        rxBufferSet( rxbuf );
-                        startRxStop();
-                        if( not waitForStop() ) return false;
-                        if( rxAmount() == N ) return true;
-                        //unknown error, reset twi
-                        reEnable();
-                        return false;
+SA  read            (u8 sa, T (&rxbuf)[N]) {
+                        static_assert(sizeof(T) == 1, "Twi::read needs a byte array");
+                        return read( sa, addr32(rxbuf), N );
                     }
 
-//============
-    protected:
-//============
-
-//------------
-//  registers
-//------------
-
-    #pragma GCC diagnostic push
-    #pragma GCC diagnostic ignored "-Wpedantic"
-
-    struct Twim_ {
-        struct {
-                u32 STARTRX;        //0x00
-                u32 unused1;
-                u32 STARTTX;        //0x08
-                u32 unused2[2];
-                u32 STOP;           //0x14
-                u32 unused3;
-                u32 SUSPEND;        //0x1C
-                u32 RESUME;         //0x20
-        }   TASKS;
-
-        u32 unused4[(0x104-0x24)/4]; 
-
-        struct {
-                u32 STOPPED;            //0x104
-                u32 unused5[(0x124-0x108)/4];
-                u32 ERROR;              //0x124
-                u32 unused6[(0x148-0x128)/4];
-                u32 SUSPENDED;          //0x148
-                u32 RXSTARTED;          //0x14C
-                u32 TXSTARTED;          //0x150
-                u32 unused7[2];
-                u32 LASTRX;             //0x15C
-                u32 LASTTX;             //0x160
-        }   EVENTS;
-
-        u32 unused8[(0x200-0x164)/4];
+//--------------------
+//  async (irq) transfers
+//--------------------
+                    //cb(ok) from the twim irq (priority 6, same as app_timer
+                    //and gpiote, so it never interrupts their callbacks), the
+                    //buffers need to stay valid until then
+                    //false = busy (cb not called)
+
+                    //addr/len versions (TwimQueue), len is used as-is
+SA  writeReadAsync  (u8 sa, u32 tx, u16 ntx, u32 rx, u16 nrx, void(*cb)(bool)) -> bool {
+                        return TwimCore::transferAsync( bus_, sa, tx, ntx, rx, nrx, cb );
+                    }
+SA  writeAsync      (u8 sa, u32 tx, u16 ntx, void(*cb)(bool)) -> bool {
+                        return TwimCore::transferAsync( bus_, sa, tx, ntx, 0, 0, cb );
+                    }
+SA  readAsync       (u8 sa, u32 rx, u16 nrx, void(*cb)(bool)) -> bool {
+                        return TwimCore::transferAsync( bus_, sa, 0, 0, rx, nrx, cb );
+                    }
 
-        u32 SHORTS;             //0x200
-        u32 unused9[(0x300-0x204)/4];
-        u32 INTEN;              //0x300
-        u32 INTENSET;           //0x304
-        u32 INTENCLR;           //0x308
-        u32 unused10[(0x4C4-0x30C)/4];
-        u32 ERRORSRC;           //0x4C4
-        u32 unused11[(0x500-0x4C8)/4];
-        u32 ENABLE;             //0x500
-        u32 unused12;
-        u32 PSEL_SCL;           //0x508
-        u32 PSEL_SDA;           //0x50C
-        u32 unused13[(0x524-0x510)/4];
-        u32 FREQUENCY;          //0x524
+                    //the last async transfer again, same slave and lengths, with
+                    //list(true) the buffers are the next ArrayList element
+SA  nextAsync       (void(*cb)(bool)) -> bool { return TwimCore::nextAsync( bus_, cb ); }
 
-        u32 unused14[(0x534-0x528)/4];
+                    template<typename T, unsigned NT, unsigned NR>
+SA  writeReadAsync  (u8 sa, const u8 (&txbuf)[NT], T (&rxbuf)[NR], void(*cb)(bool)) -> bool {
+                        static_assert(sizeof(T) == 1, "Twi::writeReadAsync needs a byte array");
+                        return writeReadAsync( sa, addr32(txbuf), NT, addr32(rxbuf), NR, cb );
+                    }
 
-        struct {
-                u32 PTR;        //0x534
-                u32 MAXCNT;
-                u32 AMOUNT;     //RO
-                u32 LIST;
-        }   RXD;
-        struct {
-                u32 PTR;        //0x544
-                u32 MAXCNT;
-                u32 AMOUNT;     //RO
-                u32 LIST;
-        }   TXD;
+                    template<unsigned N>
+SA  writeAsync      (u8 sa, const u8 (&txbuf)[N], void(*cb)(bool)) -> bool {
+                        return writeAsync( sa, addr32(txbuf), N, cb );
+                    }
 
-        u32 unused15[(0x588-0x554)/4];
-        u32 ADDRESS;            //0x588
-    };
-    #pragma GCC diagnostic pop
+                    template<typename T, unsigned N>
+SA  readAsync       (u8 sa, T (&rxbuf)[N], void(*cb)(bool)) -> bool {
+                        static_assert(sizeof(T) == 1, "Twi::readAsync needs a byte array");
+                        return readAsync( sa, addr32(rxbuf), N, cb );
+                    }
 
 };
 
@@ -357,3 +766,45 @@ using Twim0 = Twim<0x40003000, Sda_, Scl_, Pwr_>; //all
 template<PIN Sda_, PIN Scl_, PIN Pwr_ = PIN(-1)>
 using Twim1 = Twim<0x40004000, Sda_, Scl_, Pwr_>; //nRF52840 has 2 twi instances
 #endif
+
+//only 1 translation unit (main.cpp), so can define the irq handlers here
+extern "C" void SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler(void) { 
+    if( TwimCore::irqBus_[0] ) TwimCore::isr_( *TwimCore::irqBus_[0] ); 
+}
+#ifdef  NRF52840 
+extern "C" void SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQHandler(void) { 
+    if( TwimCore::irqBus_[1] ) TwimCore::isr_( *TwimCore::irqBus_[1] ); 
+}
+#endif
+
+
+/*------------------------------------------------------------------------------
+    power policy for a slave powered from the Twim Pwr_ pin
+    (Tmp117Async/Si7051Async Power_)
+
+    PowerGated  power on for each read, off when done, the startup time,
+                the rail capacitance and any config writes are paid for
+                on every read
+    PowerKeep   power stays on after the first good read, the ic is in its
+                own low power state between reads (TMP117 shutdown, Si7051
+                standby) so a read is only the conversion command, a failed
+                read powers off so the next one starts from a power on
+
+    PowerFor<IntervalMs_, GatedNc_, KeepNa_>
+                the policy with the lower charge for a sample interval,
+                gated costs GatedNc_ (nC) per read, keep costs KeepNa_ (nA)
+                all the time, so keep when KeepNa_ * interval < GatedNc_
+
+    the rail is shared (twim init/deinit is counted per power pin, on
+    either bus), it is only off when all of its users are off, so a gated ic next to a kept one stays
+    powered (use a one-shot profile so it still goes back to shutdown)
+------------------------------------------------------------------------------*/
+template<bool Keep_>
+struct PowerPolicy { SCA KEEP{ Keep_ }; };
+
+using PowerGated    = PowerPolicy<false>;
+using PowerKeep     = PowerPolicy<true>;
+
+                    //nA * ms = pC, nC * 1000 = pC
+template<u32 IntervalMs_, u32 GatedNc_, u32 KeepNa_>
+using PowerFor      = PowerPolicy< ((u64)KeepNa_ * IntervalMs_ < (u64)GatedNc_ * 1000) >;
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "nRFconfig.hpp"
+
+#include "Twim.hpp"
+
+/*------------------------------------------------------------------------------
+    TwimQueue - a batch of twim transfers run back to back from the twim
+    irq (each STOPPED starts the next), cb once when all are done or on
+    the first failure, the caller sleeps for the whole batch
+
+    Twim_   = Twim0<...>
+    N_      = max transfers in a batch
+    Tag_    = owner, the state is static (one queue per <Twim_,N_,Tag_>),
+              so each user gives its own type (Tmp117 uses itself) and
+              does not share a queue with another user on the same bus
+
+    add(addr, tx, rx)       write,read (register read)
+    add(addr, tx)           write only
+    addList(addr, regs, rx) read regs[i] into rx[i] for each i, 1 entry,
+                            uses EasyDMA ArrayList (TXD/RXD.LIST), so after
+                            the first element the buffers are not set up
+                            again, each element is only a start
+    run(cb)                 start, cb(ok) from the twim irq, false if empty
+                            or already running (queue kept), or if the
+                            first transfer did not start (queue cleared)
+    done()                  transfers (list elements) completed
+
+    u8 cfgT[1]{ CONFIG }, tmpT[1]{ TEMP }, cfg[2], tmp[2];
+    q.add( 0x48, cfgT, cfg );
+    q.add( 0x48, tmpT, tmp );
+    q.run( cb );
+
+    u8 regs[2]{ CONFIG, TEMP }, rx[2][2];   //same as above, ArrayList
+    q.addList( 0x48, regs, rx );
+    q.run( cb );
+
+    the buffers need to stay valid until cb, the queue is cleared when
+    run is done (add again for the next batch)
+------------------------------------------------------------------------------*/
+template<typename Twim_, u8 N_ = 4, typename Tag_ = void>
+struct TwimQueue {
+
+//============
+    private:
+//============
+
+    struct Xfer {
+        u32 tx;
+        u32 rx;
+        u8  addr;
+        u8  ntx;
+        u8  nrx;    //0 = write only
+        u8  count;  //ArrayList elements, 1 = normal
+    };
+
+    SI Xfer     q_[N_];
+    SI u8       n_      { 0 };  //in queue
+    SI u8       i_      { 0 };  //running
+    SI u8       k_      { 0 };  //ArrayList element of i_
+    SI u8       done_   { 0 };
+    SI bool     isBusy_ { false };
+    SI void     (*cb_)(bool){ nullptr };
+
+SA  push_           (Xfer x) -> bool {
+                        if( isBusy_ or n_ >= N_ ) return false;
+                        q_[n_++] = x;
+                        return true;
+                    }
+
+                    //start q_[i_]
+SA  start_          () -> bool {
+                        auto& x = q_[i_];
+                        k_ = 0;
+                        Twim_::list( x.count > 1 );
+                        return x.nrx ?
+                            Twim_::writeReadAsync( x.addr, x.tx, x.ntx, x.rx, x.nrx, next_ ) :
+                            Twim_::writeAsync( x.addr, x.tx, x.ntx, next_ );
+                    }
+
+SA  finish_         (bool ok) {
+                        Twim_::list( false );
+                        n_ = 0;
+                        isBusy_ = false;
+                        if( cb_ ) cb_( ok );
+                    }
+
+                    //Twim_ callback (twim irq), next element/transfer
+SA  next_           (bool ok) -> void {
+                        if( not ok ) return finish_( false );
+                        done_++;
+                        if( ++k_ < q_[i_].count ){
+                            if( not Twim_::nextAsync( next_ ) ) finish_( false );
+                            return;
+                        }
+                        if( ++i_ >= n_ ) return finish_( true );
+                        if( not start_() ) finish_( false );
+                    }
+
+//============
+    public:
+//============
+
+                    template<typename T, unsigned NT, unsigned NR>
+SA  add             (u8 addr, const u8 (&tx)[NT], T (&rx)[NR]) -> bool {
+                        static_assert(sizeof(T) == 1, "TwimQueue::add needs a byte array");
+                        return push_( { addr32(tx), addr32(rx), addr, NT, NR, 1 } );
+                    }
+
+                    template<unsigned NT>
+SA  add             (u8 addr, const u8 (&tx)[NT]) -> bool {
+                        return push_( { addr32(tx), 0, addr, NT, 0, 1 } );
+                    }
+
+                    //N register reads, M bytes each
+                    template<typename T, unsigned N, unsigned M>
+SA  addList         (u8 addr, const u8 (&regs)[N], T (&rx)[N][M]) -> bool {
+                        static_assert(sizeof(T) == 1, "TwimQueue::addList needs a byte array");
+                        return push_( { addr32(regs), addr32(rx), addr, 1, M, N } );
+                    }
+
+SA  run             (void(*cb)(bool) = nullptr) -> bool {
+                        if( isBusy_ or n_ == 0 or Twim_::isBusy() ) return false;
+                        cb_ = cb;
+                        i_ = 0;
+                        done_ = 0;
+                        isBusy_ = true;
+                        if( start_() ) return true;
+                        Twim_::list( false );
+                        n_ = 0; //same as done, add again for the next batch
+                        isBusy_ = false;
+                        return false;
+                    }
+
+SA  clear           () { if( not isBusy_ ) n_ = 0; }
+SA  isBusy          () { return isBusy_; }
+SA  done            () { return done_; }
+
+};
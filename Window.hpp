@@ -0,0 +1,118 @@
+#pragma once
+
+#include "nRFconfig.hpp"
+
+/*------------------------------------------------------------------------------
+    Window - sliding window of the last N_ i16 values
+    N_ = window size
+    Var_ = true to also keep a sum of squares for variance()
+    MinMax_ = false if min/max not needed (saves the 2 queues, 4*N_ bytes)
+
+    all O(1) (min/max amortized O(1))-
+        mean    running i32 sum
+        min/max monotonic queues of ring positions, the front is the
+                min (max) of the window, removed when its position is
+                overwritten
+        var     running i64 sum of squares (only if Var_)
+
+    the first value added fills the whole window (so mean/min/max are
+    valid from the start)
+
+    Window<288> w;  //1 day at 5 minutes
+    w.add( v );
+    w.mean(); w.min(); w.max();
+------------------------------------------------------------------------------*/
+template<u16 N_, bool Var_ = false, bool MinMax_ = true>
+struct Window {
+
+    static_assert( N_ > 0, "Window size needs to be at least 1" );
+
+//============
+    private:
+//============
+
+    //monotonic queue of ring positions (values from hist_), capacity N_
+    struct Mono {
+        u16 pos[MinMax_ ? N_ : 1];
+        u16 head{0};
+        u16 len{0};
+
+        auto front      () const { return pos[head]; }
+        auto back       () const { return pos[ head+len-1 < N_ ? head+len-1 : head+len-1-N_ ]; }
+        auto popFront   () { head = head+1 < N_ ? head+1 : 0; len--; }
+        auto popBack    () { len--; }
+        auto pushBack   (u16 p) { pos[ head+len < N_ ? head+len : head+len-N_ ] = p; len++; }
+    };
+
+    i16 hist_[N_]{};
+    u16 idx_{0};                //next position to write
+    bool isInit_{false};
+    i32 sum_{0};
+    Mono min_;
+    Mono max_;
+    i64 sumSq_{0};              //only used if Var_
+
+    auto add_       (i16 v) {
+                        auto& old = hist_[idx_];
+                        //oldest value leaves the window
+                        if( isInit_ ){
+                            sum_ -= old;
+                            if constexpr( Var_ ) sumSq_ -= (i32)old*old;
+                        }
+                        if constexpr( MinMax_ ){
+                            if( min_.len and min_.front() == idx_ ) min_.popFront();
+                            if( max_.len and max_.front() == idx_ ) max_.popFront();
+                        }
+                        //new value
+                        old = v;
+                        sum_ += v;
+                        if constexpr( Var_ ) sumSq_ += (i32)v*v;
+                        if constexpr( MinMax_ ){
+                            while( min_.len and hist_[min_.back()] >= v ) min_.popBack();
+                            min_.pushBack( idx_ );
+                            while( max_.len and hist_[max_.back()] <= v ) max_.popBack();
+                            max_.pushBack( idx_ );
+                        }
+                        idx_ = idx_+1 < N_ ? idx_+1 : 0;
+                    }
+
+//===========
+    public:
+//===========
+
+auto    add         (i16 v) {
+                        if( not isInit_ ){ //first time, fill window with same value
+                            for( auto i = 0; i < N_; i++ ) add_( v );
+                            isInit_ = true;
+                            return;
+                        }
+                        add_( v );
+                    }
+
+auto    size        () const { return N_; }
+auto    isInit      () const { return isInit_; }
+auto    sum         () const { return sum_; }
+auto    mean        () const { return (i16)(sum_ / N_); }
+auto    min         () const {
+                        static_assert( MinMax_, "Window needs MinMax_ = true for min" );
+                        return isInit_ ? hist_[min_.front()] : (i16)0;
+                    }
+auto    max         () const {
+                        static_assert( MinMax_, "Window needs MinMax_ = true for max" );
+                        return isInit_ ? hist_[max_.front()] : (i16)0;
+                    }
+
+                    //population variance (units squared)
+auto    variance    () const {
+                        static_assert( Var_, "Window needs Var_ = true for variance" );
+                        return (i32)( (sumSq_*N_ - (i64)sum_*sum_) / ((i64)N_*N_) );
+                    }
+
+                    //value n samples back (0 = newest)
+auto    operator[]  (u16 n) const {
+                        if( n >= N_ ) n = N_-1;
+                        auto i = idx_ > n ? idx_-1-n : idx_+N_-1-n;
+                        return hist_[i];
+                    }
+
+};
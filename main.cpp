@@ -81,6 +81,7 @@ BL651 module (nRF52810)-
 #include "Gap.hpp"          //provides inline class var 'gap'
 #include "Power.hpp"        //provides inline class var 'power'
 #include "Flash.hpp"        //provides inline class var 'flash'
+#include "Profile.hpp"      //provides inline class var 'profile'
 #include "Print.hpp"
 
 
@@ -91,14 +92,44 @@ BL651 module (nRF52810)-
 Timer timerTestTemp{
     20_sec, 
     [](void*){ 
-        TemperatureInternal<1>::read();
-        TemperatureTmp117<1>::read();
-        TemperatureSi7051<1>::read(); 
+        //twim stats since boot, per bus (board mapping)
+        decltype(board)::tmp117Twi::statsReport();
+        if constexpr( decltype(board)::si7051Twi::BASE != decltype(board)::tmp117Twi::BASE ){
+            decltype(board)::si7051Twi::statsReport();
+        }
+        #if !defined(TMP117_WINDOW) && !defined(TMP117_AUTO) //ic/twim kept by adv, leave it alone
+        //the sources adv is not using, at once (1 power up for the i2c ic's),
+        //adv's sensor is left out so its timed reads are not refused as busy
+        //(a group with a busy source refuses, adv's read is never taken over)
+        #if defined(TEMPERATURE_TMP117)
+        TemperatureGroup< TemperatureSi7051<NoFilter>,
+                          TemperatureInternal<NoFilter> >::start();
+        #else
+        TemperatureGroup< TemperatureTmp117<NoFilter, Tmp117Avg8>,
+                          TemperatureInternal<NoFilter> >::start();
+        #endif
+        #else
+        TemperatureInternal<NoFilter>::read();
+        #endif
     }, 
     timerTestTemp.REPEATED 
 };
 #endif
 
+// PROFILE
+// report the profile table every 20 seconds (same as the adv update), 
+// then clear so each report is 1 cycle
+#if PROFILE_ENABLED
+Timer timerProfile{
+    20_sec,
+    [](void*){
+        if constexpr( debugOn(DBG_MAIN, DBG_INFO) ) profile.report( DebugRtt );
+        profile.clear();
+    },
+    timerProfile.REPEATED
+};
+#endif
+
 
 
 
@@ -107,7 +138,7 @@ Timer timerTestTemp{
     functions
 -----------------------------------------------------------------------------*/
 static void headerMessage(const char* str){
-    DebugRtt 
+    DebugLog(DBG_MAIN, DBG_INFO)
         << ANSI_NORMAL FG MEDIUM_PURPLE << endl
         << cdup('=',60) << endl
         << '\t' << str << endl 
@@ -119,6 +150,7 @@ int main() {
 
     headerMessage("Boot start...");
 
+    profile.init();         //start cycle counter (if PROFILE_ENABLED)
     board.init();           //init board pins
     board.alive();          //blink led's to show boot
     power.init();           //start power management
@@ -29,6 +29,10 @@ SCA operator "" _i32 (u64 v) { return (i32)v; }
 SCA operator "" _u64 (u64 v) { return (u64)v; }
 SCA operator "" _i64 (u64 v) { return (i64)v; }
 
+//a buffer address as the u32 an EasyDMA PTR register takes (32bit target,
+//the host tests keep their buffers and stack below 4GB)
+inline auto addr32 (const volatile void* p) -> u32 { return (u32)(uintptr_t)p; }
+
 
 
 
@@ -57,6 +61,9 @@ SCA operator "" _i64 (u64 v) { return (i64)v; }
     #define LAST_PAGE (LAST_PAGE_ADDR/4096)
     #define TEMPERATURE_TMP117
     // #define TEMPERATURE_SI7051
+    // #define TMP117_ALERT_DATAREADY //use board.tmp117Alert for data ready
+    // #define TMP117_WINDOW //tmp117 event driven, board.tmp117Alert for the window alert
+    // #define TMP117_AUTO //tmp117 read through ppi, board.tmp117Alert for data ready
     #include "nRF52810.hpp"
 #endif
 
@@ -68,28 +75,76 @@ SCA operator "" _i64 (u64 v) { return (i64)v; }
 using namespace fmt;
 
 #ifdef NRF52810_BL651_TEMP //set in makefile
-
 using DebuRttT = DevRtt<0>;
-// using DebuRttT = NullStreamer; //if want no debug output
+// using DebuRttT = DevRttBin<0>; //binary records, decode on pc with tools/rttdecode
+// using DebuRttT = DevRttQueue<0, 1024>; //queued, sent to rtt from Power::sleep
+// using DebuRttT = NullFormat; //if want no debug output
+#else //nrf52840 has no output
+using DebuRttT = NullFormat;
+#endif
 inline DebuRttT DebugRtt;
 
 
+/*------------------------------------------------------------------------------
+    debug log levels, per module, resolved at compile time
+
+    DebugLog(DBG_FLASH, DBG_INFO) << "Flash::init..." << endl;
+    DebugLogHeader(DBG_TEMP, DBG_INFO) << "  raw: " << t << endl; //time/file/func header first
+
+    a statement above its module level is discarded (if constexpr), so its
+    arguments are not evaluated and its strings are not in the binary
+
+    each expands to 'if constexpr(...){} else ...', so use only as a whole
+    statement (not in an expression or a comma list), an else that follows
+    it in an unbraced if binds to that if as expected (the macro if already
+    has its own else)-
+        if( bad ) DebugLog(DBG_MAIN, DBG_ERROR) << "bad" << endl; else ok();
+------------------------------------------------------------------------------*/
+enum DEBUG_LEVEL { DBG_OFF, DBG_ERROR, DBG_WARN, DBG_INFO, DBG_TRACE };
+
+enum DEBUG_MODULE { 
+    DBG_MAIN, DBG_BOARD, DBG_POWER, DBG_FLASH, DBG_BLE, 
+    DBG_ADV, DBG_TEMP, DBG_BATTERY, DBG_TWIM 
+};
+
+                //set each module level as needed
+                constexpr DEBUG_LEVEL
+debugLevel      (const DEBUG_MODULE m){
+            #ifdef NRF52810_BL651_TEMP
+                switch( m ){
+                    case DBG_MAIN:      return DBG_TRACE;
+                    case DBG_BOARD:     return DBG_TRACE;
+                    case DBG_POWER:     return DBG_TRACE;
+                    case DBG_FLASH:     return DBG_TRACE;
+                    case DBG_BLE:       return DBG_TRACE;
+                    case DBG_ADV:       return DBG_TRACE;
+                    case DBG_TEMP:      return DBG_TRACE;
+                    case DBG_BATTERY:   return DBG_TRACE;
+                    case DBG_TWIM:      return DBG_TRACE;
+                    }
+            #endif
+                (void)m;
+                return DBG_OFF; //no debug device, all off
+                }
+
+                constexpr bool
+debugOn         (const DEBUG_MODULE m, const DEBUG_LEVEL lvl){
+                return lvl != DBG_OFF and lvl <= debugLevel(m);
+                }
+
                 // using app timer rtc1 as system time, is /2 so 16384 per sec
-                [[ gnu::noinline ]] inline void 
-DebugFuncHeader (){
+                [[ gnu::noinline ]] inline DebuRttT&
+debugHeader     (const char* file, const u32 line, const char* func){
                 u32 t = app_timer_cnt_get();
-                DebugRtt 
+                return DebugRtt 
                     << reset << FG SEA_GREEN
                     << setfill('0') 
                     << '[' << setw(4) << t/16384 << '.' << setw(6) << (t%16384)*61 << ']'
-                    << '[' << __FILE__ << ':' << (u32)__LINE__ << " ::" << __func__ << ']' 
+                    << '[' << file << ':' << line << " ::" << func << ']' 
                     << endl << ANSI_NORMAL << reset;
                 }
 
-#else //nrf52840 has no output, send debug to NullStreamer
-inline NullStreamer DebugRtt{};
-#define DebugFuncHeader()
-#endif
-
-
-
+#define DebugLog(m_, lvl_) \
+    if constexpr( not debugOn(m_, lvl_) ){} else DebugRtt
+#define DebugLogHeader(m_, lvl_) \
+    if constexpr( not debugOn(m_, lvl_) ){} else debugHeader( __FILE__, __LINE__, __func__ )
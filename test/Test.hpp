@@ -0,0 +1,35 @@
+#pragma once
+
+/*------------------------------------------------------------------------------
+    Test.hpp - minimal host test helpers (see test/Makefile)
+
+        CHECK( a == b );        //prints file:line and the expression on fail
+        return Test::result();  //from main, 0 = all passed
+------------------------------------------------------------------------------*/
+#include <cstdio>
+
+namespace Test {
+
+                inline int fails{ 0 };
+                inline int checks{ 0 };
+
+                inline bool
+check           (bool ok, const char* expr, const char* file, int line)
+                {
+                checks++;
+                if( ok ) return true;
+                fails++;
+                printf( "  FAIL %s:%d: %s\n", file, line, expr );
+                return false;
+                }
+
+                inline int
+result          (const char* name)
+                {
+                printf( "%-16s %s (%d checks, %d failed)\n", name, fails ? "FAIL" : "ok", checks, fails );
+                return fails ? 1 : 0;
+                }
+
+}
+
+#define CHECK(e_) Test::check( (e_), #e_, __FILE__, __LINE__ )
@@ -0,0 +1,63 @@
+/*------------------------------------------------------------------------------
+    debug_log - [user-005] compile-time debug levels
+
+    a disabled DebugLog/DebugLogHeader does not evaluate its arguments and
+    its strings are not in the binary (this test's own elf is searched),
+    an enabled one outputs, and an else after the macro binds to the
+    enclosing if
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include <string>
+
+static std::string out;
+unsigned SEGGER_RTT_Write(unsigned, const void* b, unsigned len){ out.append( (const char*)b, len ); return len; }
+
+static int evals;
+static int eval(){ return ++evals; }
+
+static bool
+inFile          (const char* fname, const std::string& s)
+                {
+                std::string d;
+                auto fp = fopen( fname, "rb" );
+                int c;
+                while( (c = fgetc(fp)) != EOF ) d += (char)c;
+                fclose( fp );
+                return d.find( s ) != std::string::npos;
+                }
+
+int main(int, char** argv){
+
+    //DBG_OFF is never on, any module
+    DebugLog(DBG_TEMP, DBG_OFF) << "disabled-log-marker-1" << eval() << endl;
+    DebugLogHeader(DBG_TEMP, DBG_OFF) << "disabled-log-marker-2" << eval() << endl;
+    CHECK( evals == 0 );
+    CHECK( out.empty() );
+
+    //the board in this build has every module at DBG_TRACE
+    DebugLog(DBG_TEMP, DBG_INFO) << "enabled-log-marker" << eval() << endl;
+    CHECK( evals == 1 );
+    CHECK( out.find("enabled-log-marker1") != std::string::npos );
+
+    out.clear();
+    DebugLogHeader(DBG_TEMP, DBG_ERROR) << "x" << endl;
+    CHECK( out.find("debug_log.cpp:") != std::string::npos );
+    CHECK( out.find("::main]") != std::string::npos );
+
+    //else after the macro, both enabled and disabled
+    int which = 0;
+    for( bool c : { true, false } ){
+        if( c ) DebugLog(DBG_MAIN, DBG_INFO) << "a" << endl; else which |= 1;
+        if( c ) DebugLog(DBG_MAIN, DBG_OFF) << "b" << endl; else which |= 2;
+        if( not c ) CHECK( which == 3 ); else CHECK( which == 0 );
+    }
+
+    //strings of the disabled statements were discarded (search strings
+    //built at runtime, so they are not themselves in the elf)
+    auto marker = [](const char* a){ return std::string(a) + "-log-marker"; };
+    CHECK( inFile(argv[0], marker("enabled")) );
+    CHECK( not inFile(argv[0], marker("disabled")) );
+
+    return Test::result( "debug_log" );
+}
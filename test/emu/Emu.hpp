@@ -0,0 +1,1219 @@
+#pragma once
+
+/*------------------------------------------------------------------------------
+    Emu.hpp - nRF52 peripherals for the host tests, the firmware headers
+    run unchanged against it (include after nRFconfig.hpp, 1 per test)
+
+    registers are pages mapped at the peripheral addresses, read only for
+    the firmware, a write faults (SIGSEGV), the page is opened for that 1
+    instruction (trap flag), then the write is handled like the hardware
+    would (tasks, INTENSET/CLR, OUTSET/CLR, ...) in the SIGTRAP handler,
+    so back to back writes to the same register are all seen, models write
+    the registers through a second (rw) mapping of the same memory, the
+    TWIM pages also fault on a read (polled), a read of a register that
+    nothing changed since its last read is a spin loop (while not STOPPED),
+    time moves to the next event for it
+
+    time is virtual (us), it only moves in __WFE, nrf_delay_* and wait(),
+    straight to the next thing that can happen (timer compare, twim byte,
+    app_timer expiry, device conversion), so a 16s sleep costs nothing
+
+    TIMER1/2    timer (1MHz) and counter mode, compares, shorts, capture
+    TWIM0/1     address/tx/rx/stop phases at the bus speed, shorts,
+                EasyDMA (and ArrayList), ANACK/DNACK, SDA held low by a
+                slave (released by SCL clocks on the gpio, busRecover)
+    P0          OUT/IN/PIN_CNF, pulls, open drain inputs from the models,
+                DETECT -> GPIOTE PORT event
+    PPI         sd_ppi_* channels, an event fires its tasks
+    NVIC        sd_nvic_*, level irqs, SEVONPEND, __WFE/__SEV, critical
+                region, irqs run (priority 6, not nested) after any
+                register write (preempting the code that wrote it) and
+                while time moves
+    SAADC       1 channel, gain/reference/resolution from the registers,
+                oversampling per SAMPLE task or in 1 burst, calibration,
+                a stalled conversion (test)
+    app_timer   create/start/stop, callbacks from the RTC1 irq (17)
+
+    Tmp117      TMP117 model (power pin, startup, one-shot/continuous,
+                averaging times, DATAREADY, limits, ALERT pin)
+
+    the test body runs on a stack below 4GB (run), the firmware casts
+    buffer addresses to u32 for EasyDMA
+------------------------------------------------------------------------------*/
+#include <cmath>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+namespace emu {
+
+    using T64 = unsigned long long;
+    constexpr T64 NEVER{ ~0ull };
+
+    inline volatile T64 now { 0 };          //us (volatile, a spin loop moves it in the signal handler)
+    inline T64  asleepUs    { 0 };          //in __WFE
+    inline u32  wfes        { 0 };          //__WFE that slept
+    inline u32  writes      { 0 };          //register writes seen
+    inline u32  irqs[32]    {};             //handler entries per irq
+    inline T64  irqUs       { 0 };          //in irq handlers (a blocking transfer in a callback)
+
+//------------
+//  memory
+//------------
+
+    struct Page { u32 base; bool trap; bool poll{false}; u8* rw{nullptr}; };
+
+    inline Page pages[]{
+        { 0x40003000, true, true }, { 0x40004000, true, true }, //TWIM0/1
+        { 0x40006000, true }, { 0x40007000, true },     //GPIOTE, SAADC
+        { 0x40009000, true }, { 0x4000A000, true },     //TIMER1/2
+        { 0x50000000, true },                           //P0 (P1)
+        { 0xE0001000, false }, { 0xE000E000, false },   //DWT, SCB
+    };
+
+                inline Page*
+page            (u32 a) {
+                    for( auto& p : pages ) if( p.base == (a bitand compl 0xFFFu) ) return &p;
+                    return nullptr;
+                }
+
+                //model side of a register
+                inline volatile u32&
+r               (u32 a) { return *(volatile u32*)(page(a)->rw + (a bitand 0xFFF)); }
+
+                //EasyDMA
+                inline u8*
+ram             (u32 a) { return (u8*)(uintptr_t)a; }
+
+    inline volatile u32& SCR{ *(volatile u32*)0xE000ED10 };
+    constexpr u32 SEVONPEND{ 1u<<4 };
+
+//------------
+//  nvic
+//------------
+
+    enum { TWIM0_IRQ = 3, TWIM1_IRQ = 4, GPIOTE_IRQ = 6, SAADC_IRQ = 7,
+           TIMER1_IRQ = 9, TIMER2_IRQ = 10, RTC1_IRQ = 17 };
+
+    inline bool en[32], pend[32];
+    inline bool event   { false };  //__WFE event register
+    inline bool inIrq   { false };
+    inline u8   critical{ 0 };
+
+    void update();
+    void dispatch();
+    void advance(T64 until);
+
+//------------
+//  ppi
+//------------
+
+    struct Ppi { u32 eep, tep; };
+    inline Ppi  ppi[20];
+    inline u32  ppiEn   { 0 };
+
+    void task(u32 a);
+
+                //an event, and the tasks connected to it
+                inline void
+fire            (u32 a) {
+                    r( a ) = 1;
+                    for( u8 ch = 0; ch < 20; ch++ ){
+                        if( (ppiEn bitand (1u<<ch)) and ppi[ch].eep == a ) task( ppi[ch].tep );
+                    }
+                }
+
+//------------
+//  twi slaves
+//------------
+
+    struct Device {
+        u8      addr;
+        i8      pwrPin  { -1 };     //powered while this P0 output is high, -1 = always
+        bool    on      { false };
+        bool    nack    { false };  //test- address nack
+        u32     xfers   { 0 };      //transactions addressed to it (acked)
+        u32     nacks   { 0 };
+        Device(u8 a, i8 pwr = -1) : addr(a), pwrPin(pwr) {}
+        virtual void power  (bool o) { on = o; }
+        virtual bool start  (bool /*read*/) { return true; }  //address ack
+        virtual bool write  (u8) { return true; }             //data ack
+        virtual u8   read   () { return 0xFF; }
+        virtual void stop   () {}
+        virtual u32  stretch() { return 0; }                  //us per byte (SCL held)
+        virtual T64  next   () { return NEVER; }
+        virtual void process() {}
+        virtual bool alertLow() { return false; }             //open drain ALERT pin
+        virtual i8   alertPin() { return -1; }
+    };
+
+    inline Device* devices[8];
+
+//------------
+//  TIMER
+//------------
+
+    struct Timer {
+        u32     base;
+        u8      irqn;
+        bool    running { false };
+        u32     c0      { 0 };      //count at t0
+        T64     t0      { 0 };
+        u32     seen    { 0 };      //last count compares were checked at
+        u32     inten   { 0 };
+
+        u32  R      (u32 o) { return r( base+o ); }
+        u32  mask   () { u32 b = R(0x508) bitand 3; return b == 0 ? 0xFFFF : b == 1 ? 0xFF : b == 2 ? 0xFFFFFF : 0xFFFFFFFF; }
+        bool isTimer() { return (R(0x504) bitand 3) == 0; }
+        u32  pre    () { auto p = R(0x510) bitand 15; return p > 9 ? 9 : p; }
+        u32  count  () {
+                        if( not running or not isTimer() ) return c0;
+                        return (c0 + (u32)(((now - t0) * 16) >> pre())) bitand mask();
+                    }
+        void rebase () { c0 = count(); t0 = now; }
+        void compare(u8 n) {
+                        fire( base + 0x140 + 4*n );
+                        u32 sh = R( 0x200 );
+                        if( sh bitand (1u<<n) ){ c0 = 0; t0 = now; seen = 0; }
+                        if( sh bitand (1u<<(n+8)) ){ rebase(); running = false; }
+                    }
+        void check  () {
+                        u32 c = count();
+                        if( c == seen ) return;
+                        seen = c;
+                        for( u8 n = 0; n < 6; n++ ) if( (R(0x540+4*n) bitand mask()) == c ) compare( n );
+                    }
+        T64  next   () {
+                        if( not running or not isTimer() ) return NEVER;
+                        u32 c = count();
+                        T64 best = NEVER;
+                        for( u8 n = 0; n < 6; n++ ){
+                            T64 d = (R(0x540+4*n) - c) bitand mask();
+                            if( d == 0 ) d = (T64)mask() + 1;
+                            //ticks to us, first us the count reaches it
+                            T64 us = ((d << pre()) + 15) / 16;
+                            T64 tt = now + (us ? us : 1);
+                            if( tt < best ) best = tt;
+                        }
+                        return best;
+                    }
+                    //a compare is the count changing to CC, a CC written (or
+                    //captured) at the count does not match until it comes around
+        void write  (u32 o, u32 v) {
+                        auto& reg = r( base+o );
+                        check(); seen = count();
+                        switch( o ){
+                            case 0x000: if( v and not running ){ running = true; t0 = now; seen = count(); } reg = 0; return;
+                            case 0x004: if( v ){ rebase(); running = false; } reg = 0; return;
+                            case 0x008: if( v and running and not isTimer() ){ c0 = (c0 + 1) bitand mask(); check(); } reg = 0; return;
+                            case 0x00C: if( v ){ c0 = 0; t0 = now; seen = 0; } reg = 0; return;
+                            case 0x010: if( v ){ running = false; c0 = 0; } reg = 0; return;
+                            case 0x304: inten or_eq v; break;
+                            case 0x308: inten and_eq compl v; break;
+                        }
+                        if( o >= 0x040 and o < 0x058 ){
+                            if( v ) r( base + 0x540 + (o-0x040) ) = count();
+                            reg = 0;
+                        }
+                        if( o == 0x304 or o == 0x308 ){ r(base+0x304) = inten; r(base+0x308) = inten; }
+                        if( o == 0x540 or o == 0x504 or o == 0x510 ) rebase();
+                    }
+        bool line   () {
+                        for( u8 n = 0; n < 6; n++ ) if( R(0x140+4*n) and (inten bitand (1u<<(16+n))) ) return true;
+                        return false;
+                    }
+    };
+
+    inline Timer timer1{ 0x40009000, TIMER1_IRQ };
+    inline Timer timer2{ 0x4000A000, TIMER2_IRQ };
+
+//------------
+//  P0, GPIOTE
+//------------
+
+    struct Port {
+        u32     in      { 0 };
+        bool    detect  { false };
+        u32     gpioteInten{ 0 };
+        u32     sclClocks{ 0 };     //SCL falling edges driven as gpio
+
+        u32  out    () { return r( 0x50000504 ); }
+        u32  cnf    (u8 p) { return r( 0x50000700 + 4*p ); }
+        bool isOut  (u8 p) { return cnf(p) bitand 1; }
+        bool isHigh (u8 p) { return in bitand (1u<<p); }
+                    //pin output high (power pins)
+        bool drives (i8 p) { return p < 0 or (isOut(p) and (out() bitand (1u<<p))); }
+
+        void update ();
+        void write  (u32 o, u32 v);
+    };
+
+    inline Port port;
+
+//------------
+//  TWIM
+//------------
+
+    struct Twim {
+        u32     base;
+        u8      irqn;
+        u32     inten   { 0 };
+        enum    { IDLE, ADDR, TX, RX, HOLD, STOPPING, HUNG } st{ IDLE };
+        bool    isRead  { false };
+        T64     due     { NEVER };
+        u16     i       { 0 };
+        Device* dev     { nullptr };
+        bool    isOpen  { false };  //START sent, no STOP yet
+
+                //test- SDA held low by the slave from byte hangAt (0 =
+                //the address) of the next transfer, released after
+                //releaseClocks SCL clocks (0xFF = never, until power off)
+        i8      hangAt  { -1 };
+        u8      releaseClocks{ 9 };
+        bool    sdaLow  { false };
+        u32     sclClocks0{ 0 };
+
+        u32  R      (u32 o) { return r( base+o ); }
+        bool isOn   () { return R(0x500) == 6; }
+        u32  byteUs () {
+                        u32 f = R(0x524);
+                        u32 khz = f == 0x01980000 ? 100 : f == 0x04000000 ? 250 : 400;
+                        return (9000 + khz - 1) / khz;
+                    }
+        u8   sda    () { return R(0x50C) bitand 0x1F; }
+        u8   scl    () { return R(0x508) bitand 0x1F; }
+        Device* find() {
+                        for( auto d : devices ) if( d and d->addr == (R(0x588) bitand 0x7F) and base == busOf(d) ) return d;
+                        return nullptr;
+                    }
+        static u32 busOf(Device* d);
+
+        bool hangNow(u16 b) {
+                        if( hangAt < 0 or hangAt != b ) return false;
+                        hangAt = -1;
+                        sdaLow = true;
+                        sclClocks0 = port.sclClocks;
+                        st = HUNG;
+                        due = NEVER;
+                        port.update();
+                        return true;
+                    }
+        void phase  (bool read) {
+                        isRead = read;
+                        st = ADDR;
+                        i = 0;
+                        fire( base + (read ? 0x14C : 0x150) ); //RX/TXSTARTED
+                        r( base + (read ? 0x53C : 0x54C) ) = 0; //AMOUNT
+                        due = now + byteUs() + (isOpen ? 0 : 5);
+                        isOpen = true;
+                    }
+        void error  (u32 src) {
+                        r( base+0x4C4 ) = R(0x4C4) bitor src;
+                        st = HOLD;
+                        due = NEVER;
+                        fire( base+0x124 ); //after, a ppi STOP moves on from HOLD
+                    }
+        void stopNow() {
+                        if( st == HUNG ) return;
+                        due = (st == TX or st == RX ? due : now) + 5;
+                        st = STOPPING;
+                    }
+        void last   () {
+                        u32 sh = R(0x200);
+                        u32 list = base + (isRead ? 0x540 : 0x550);
+                        if( r(list) bitand 1 ){
+                            u32 p = base + (isRead ? 0x534 : 0x544);
+                            r( p ) = r( p ) + r( p+4 );
+                        }
+                        fire( base + (isRead ? 0x15C : 0x160) ); //LASTRX/LASTTX
+                        if( st == STOPPING or st == IDLE ) return; //ppi did it
+                        st = HOLD; due = NEVER;
+                        if( not isRead and (sh bitand (1u<<7)) ) return phase( true );
+                        if( isRead and (sh bitand (1u<<10)) ) return phase( false );
+                        if( sh bitand (isRead ? (1u<<12) : (1u<<9)) ) return stopNow();
+                    }
+        void process() {
+                        while( due <= now ){
+                            auto t = due;
+                            if( st == ADDR ){
+                                dev = find();
+                                if( hangNow(0) ) return;
+                                if( not dev or not dev->on or dev->nack or not dev->start(isRead) ){
+                                    if( dev ) dev->nacks++;
+                                    error( 2 ); //ANACK
+                                    continue;
+                                }
+                                dev->xfers++;
+                                u16 n = r( base + (isRead ? 0x538 : 0x548) );
+                                if( n == 0 ){ due = NEVER; st = HOLD; last(); continue; }
+                                st = isRead ? RX : TX;
+                                due = t + byteUs() + dev->stretch();
+                                continue;
+                            }
+                            if( st == TX or st == RX ){
+                                u32 p = base + (isRead ? 0x534 : 0x544);
+                                u16 n = r( p+4 );
+                                if( not dev->on ){ error( isRead ? 1 : 4 ); continue; }
+                                if( isRead ) ram( r(p) )[i] = dev->read();
+                                else if( not dev->write( ram(r(p))[i] ) ){
+                                    r( p+8 ) = i + 1;
+                                    error( 4 ); //DNACK
+                                    continue;
+                                }
+                                r( p+8 ) = ++i;
+                                if( hangNow(i) ) return;
+                                if( i < n ){ due = t + byteUs() + dev->stretch(); continue; }
+                                due = NEVER;
+                                last();
+                                continue;
+                            }
+                            if( st == STOPPING ){
+                                if( dev ) dev->stop();
+                                dev = nullptr;
+                                st = IDLE; due = NEVER; isOpen = false;
+                                fire( base+0x104 ); //STOPPED
+                                continue;
+                            }
+                            due = NEVER;
+                        }
+                    }
+        void write  (u32 o, u32 v) {
+                        auto& reg = r( base+o );
+                        switch( o ){
+                            case 0x000: reg = 0; if( v and isOn() and st != HUNG and st != STOPPING ) phase( true ); return;
+                            case 0x008: reg = 0; if( v and isOn() and st != HUNG and st != STOPPING ) phase( false ); return;
+                            case 0x014: reg = 0; if( v and isOn() ){ if( st == IDLE ) fire( base+0x104 ); else stopNow(); } return;
+                            case 0x304: inten or_eq v; break;
+                            case 0x308: inten and_eq compl v; break;
+                            case 0x300: inten = v; break;
+                            case 0x500: if( v != 6 and st != IDLE ){
+                                            if( dev and st != HUNG ) dev->stop();
+                                            if( st != HUNG ) st = IDLE;
+                                            due = NEVER; isOpen = false; dev = nullptr;
+                                        }
+                                        return;
+                        }
+                        if( o >= 0x300 and o <= 0x308 ){ r(base+0x300) = inten; r(base+0x304) = inten; r(base+0x308) = inten; }
+                    }
+                    //ERRORSRC is write 1 to clear, needs the value before the write
+        void errorsrc(u32 old, u32 v) { r( base+0x4C4 ) = old bitand compl v; }
+        void released() {
+                        if( not sdaLow ) return;
+                        if( releaseClocks != 0xFF and port.sclClocks - sclClocks0 >= releaseClocks ){
+                            sdaLow = false;
+                            if( st == HUNG ){ st = IDLE; isOpen = false; dev = nullptr; }
+                        }
+                    }
+        bool line   () {
+                        const u16 ev[]{ 0x104, 0x124, 0x148, 0x14C, 0x150, 0x15C, 0x160 };
+                        const u8  bit[]{ 1, 9, 18, 19, 20, 23, 24 };
+                        for( u8 k = 0; k < 7; k++ ) if( R(ev[k]) and (inten bitand (1u<<bit[k])) ) return true;
+                        return false;
+                    }
+    };
+
+    inline Twim twim[2]{ { 0x40003000, TWIM0_IRQ }, { 0x40004000, TWIM1_IRQ } };
+    inline u32  devBus[8];
+
+    inline u32 Twim::busOf(Device* d) {
+                    for( u8 k = 0; k < 8; k++ ) if( devices[k] == d ) return devBus[k];
+                    return 0;
+                }
+
+                //device on a twim (0x40003000/0x40004000)
+                inline void
+attach          (Device& d, u32 bus = 0x40003000) {
+                    for( u8 k = 0; k < 8; k++ ){
+                        if( devices[k] ) continue;
+                        devices[k] = &d; devBus[k] = bus;
+                        d.power( port.drives(d.pwrPin) );
+                        port.update();
+                        return;
+                    }
+                }
+
+//------------
+//  SAADC
+//------------
+
+                //1 channel (the first with PSELP set), single ended, EasyDMA
+                //of 1 result, oversampling by SAMPLE tasks or in 1 burst
+                //(CONFIG.BURST), START/SAMPLE/STOP/CALIBRATE and the events
+                //STARTED, END, DONE, RESULTDONE, CALIBRATEDONE, STOPPED
+    struct Saadc {
+        u32     base    { 0x40007000 };
+        u32     inten   { 0 };
+        bool    isStarted{ false };     //buffer latched
+        T64     startAt { NEVER }, sampleAt{ NEVER }, calAt{ NEVER }, stopAt{ NEVER };
+        u32     sum     { 0 }, n{ 0 }, want{ 0 };
+        i32     acc     { 0 };
+        double  vdd     { 3.0 };        //test- supply, V
+        double  ain[8]  {};             //test- AIN0-7, V
+        bool    stall   { false };      //test- a SAMPLE never completes
+                //counters
+        u32     starts{ 0 }, samples{ 0 }, conversions{ 0 }, calibrations{ 0 }, stops{ 0 };
+
+        static constexpr u32 TACQ_US[]{ 3, 5, 10, 15, 20, 40, 40, 40 };
+        static constexpr u32 TCONV_US { 2 };
+        static constexpr u32 TCAL_US  { 100 };  //model, not the datasheet
+
+        u32  R      (u32 o) { return r( base+o ); }
+        bool isOn   () { return R(0x500) bitand 1; }
+        i8   ch     () { for( u8 c = 0; c < 8; c++ ) if( R(0x510+16*c) ) return c; return -1; }
+        u32  cfg    () { return R(0x518 + 16*ch()); }
+        u32  bits   () { return 8 + 2*(R(0x5F0) bitand 3); }
+        u32  over   () { u32 o = R(0x5F4) bitand 15; return 1u << (o > 8 ? 8 : o); }
+        bool isBurst() { return (cfg()>>24) bitand 1; }
+        u32  sampleUs() { return TACQ_US[ (cfg()>>16) bitand 7 ] + TCONV_US; }
+        double in   () {
+                        u32 p = R(0x510 + 16*ch());
+                        return p == 9 ? vdd : p == 0x0D ? vdd/5 : p >= 1 and p <= 8 ? ain[p-1] : 0;
+                    }
+                    //1 conversion, gain/ref from CONFIG
+        i32  convert() {
+                        static constexpr double GAIN[]{ 1/6.0, 1/5.0, 1/4.0, 1/3.0, 1/2.0, 1, 2, 4 };
+                        auto c = cfg();
+                        double ref = (c>>12) bitand 1 ? vdd/4 : 0.6;
+                        double v = in() * GAIN[ (c>>8) bitand 7 ] / ref * (1u << bits());
+                        i32 m = (1 << bits()) - 1;
+                        i32 k = v + 0.5;
+                        conversions++;
+                        return k < 0 ? 0 : k > m ? m : k;
+                    }
+        T64  next   () {
+                        T64 t = startAt;
+                        for( T64 v : { sampleAt, calAt, stopAt } ) if( v < t ) t = v;
+                        return t;
+                    }
+        void status (bool busy) { r( base+0x400 ) = busy; }
+        void process() {
+                        if( startAt <= now ){ startAt = NEVER; isStarted = true; fire( base+0x100 ); }
+                        if( calAt <= now ){ calAt = NEVER; calibrations++; fire( base+0x110 ); }
+                        if( stopAt <= now ){ stopAt = NEVER; fire( base+0x114 ); }
+                        if( sampleAt > now ) return;
+                        sampleAt = NEVER;
+                        u32 k = isBurst() ? want - n : 1;
+                        for( u32 j = 0; j < k; j++ ) acc += convert();
+                        n += k;
+                        status( false );
+                        fire( base+0x108 ); //DONE
+                        if( n < want ) return; //more SAMPLE tasks
+                        i16 v = (acc + (i32)want/2) / (i32)want;
+                        if( isStarted and R(0x630) ){
+                            memcpy( ram( R(0x62C) ), &v, 2 );
+                            r( base+0x634 ) = 1;
+                            fire( base+0x10C ); //RESULTDONE
+                            isStarted = false;
+                            fire( base+0x104 ); //END, buffer full (1 result)
+                        }
+                        n = 0; acc = 0;
+                    }
+        void write  (u32 o, u32 v) {
+                        auto& reg = r( base+o );
+                        switch( o ){
+                            case 0x000: reg = 0; if( v and isOn() ){ starts++; r( base+0x634 ) = 0; startAt = now + 1; } return;
+                            case 0x004: reg = 0;
+                                        if( not v or not isOn() or not isStarted or sampleAt != NEVER or ch() < 0 ) return;
+                                        samples++;
+                                        want = over();
+                                        status( true );
+                                        if( stall ) return;
+                                        sampleAt = now + sampleUs() * (isBurst() ? want - n : 1);
+                                        return;
+                            case 0x008: reg = 0; if( v ){ stops++; sampleAt = startAt = NEVER; isStarted = false; n = 0; acc = 0; status( false ); stopAt = now + 1; } return;
+                            case 0x00C: reg = 0; if( v and isOn() ) calAt = now + TCAL_US; return;
+                            case 0x300: inten = v; break;
+                            case 0x304: inten or_eq v; break;
+                            case 0x308: inten and_eq compl v; break;
+                        }
+                        if( o >= 0x300 and o <= 0x308 ){ r(base+0x300) = inten; r(base+0x304) = inten; r(base+0x308) = inten; }
+                    }
+        bool line   () {
+                        for( u8 k = 0; k < 6; k++ ) if( R(0x100+4*k) and (inten bitand (1u<<k)) ) return true;
+                        return false;
+                    }
+    };
+
+    inline Saadc saadc;
+
+//------------
+//  P0
+//------------
+
+    inline void Port::update() {
+                    u32 n = 0;
+                    for( u8 p = 0; p < 32; p++ ){
+                        u32 c = cnf( p );
+                        bool low = false;
+                        for( auto& t : twim ) if( t.sdaLow and t.sda() == p ) low = true;
+                        for( auto d : devices ) if( d and d->alertPin() == p and d->alertLow() ) low = true;
+                        bool hi = c bitand 1 ? bool(out() bitand (1u<<p)) : ((c>>2) bitand 3) == 3;
+                        if( low ) hi = false;
+                        if( (c bitand 2) and not (c bitand 1) ) hi = false; //input buffer off
+                        if( hi ) n or_eq 1u<<p;
+                    }
+                    in = n;
+                    r( 0x50000510 ) = in;
+                    bool d = false;
+                    for( u8 p = 0; p < 32; p++ ){
+                        u32 s = (cnf(p)>>16) bitand 3;
+                        if( (s == 2 and isHigh(p)) or (s == 3 and not isHigh(p)) ) d = true;
+                    }
+                    if( d and not detect ) fire( 0x4000617C ); //GPIOTE PORT
+                    detect = d;
+                    for( auto dv : devices ){
+                        if( not dv ) continue;
+                        bool on = drives( dv->pwrPin );
+                        if( on != dv->on ){
+                            dv->power( on );
+                            if( not on ) for( auto& t : twim ) if( Twim::busOf(dv) == t.base and t.sdaLow ){
+                                t.sdaLow = false;
+                                if( t.st == Twim::HUNG ){ t.st = Twim::IDLE; t.isOpen = false; t.dev = nullptr; }
+                            }
+                            update();
+                            return;
+                        }
+                    }
+                }
+
+    inline void Port::write(u32 o, u32 v) {
+                    u32 old = out();
+                    auto& reg = r( 0x50000000+o );
+                    switch( o ){
+                        case 0x508: reg = old bitor v; r(0x50000504) = old bitor v; r(0x5000050C) = old bitor v; break;
+                        case 0x50C: reg = old bitand compl v; r(0x50000504) = old bitand compl v; r(0x50000508) = old bitand compl v; break;
+                        case 0x504: r(0x50000508) = v; r(0x5000050C) = v; break;
+                        case 0x518: r(0x50000514) = r(0x50000514) bitor v; break;
+                        case 0x51C: r(0x50000514) = r(0x50000514) bitand compl v; break;
+                        case 0x520: reg = 0; break;
+                    }
+                    if( o >= 0x700 and o < 0x780 ){
+                        u8 p = (o-0x700)/4;
+                        u32 d = r(0x50000514);
+                        r(0x50000514) = (v bitand 1) ? d bitor (1u<<p) : d bitand compl (1u<<p);
+                    }
+                    //SCL clocked as a gpio (twim off), falling edges
+                    u32 now_ = out();
+                    for( auto& t : twim ){
+                        u32 b = 1u<<t.scl();
+                        if( not t.isOn() and isOut(t.scl()) and (old bitand b) and not (now_ bitand b) ){ sclClocks++; t.released(); }
+                    }
+                    update();
+                }
+
+//------------
+//  app_timer
+//------------
+
+    struct AppTimer { app_timer_timeout_handler_t h; int mode; bool on; T64 due; T64 period; void* ctx; };
+    inline AppTimer apptimers[32];
+    inline u8 apptimerN{ 0 };
+
+    inline T64 ticksUs(u32 ticks) { return ((T64)ticks * 1000000 + 16383) / 16384; }
+
+    inline bool rtcLine() {
+                    for( u8 k = 0; k < apptimerN; k++ ) if( apptimers[k].on and apptimers[k].due <= now ) return true;
+                    return false;
+                }
+
+    inline void rtcIsr() {
+                    for( u8 k = 0; k < apptimerN; k++ ){
+                        auto& t = apptimers[k];
+                        if( not t.on or t.due > now ) continue;
+                        if( t.mode == APP_TIMER_MODE_REPEATED ) t.due += t.period; else t.on = false;
+                        if( t.h ) t.h( t.ctx );
+                    }
+                }
+
+//------------
+//  test schedule
+//------------
+
+    struct At { T64 t; void (*f)(); };
+    inline At at_[16];
+
+                //f() at t (thread context, between irqs), a test event
+                inline void
+at              (T64 t, void (*f)()) {
+                    for( auto& a : at_ ) if( not a.f ){ a = { t, f }; return; }
+                }
+
+                //called after each register write (a test can make an
+                //irq pending here to preempt the writer)
+    inline void (*onWrite)(u32 addr, u32 v){ nullptr };
+
+//------------
+//  core
+//------------
+
+                //a firmware write
+                inline void
+apply           (u32 a, u32 v, u32 old) {
+                    writes++;
+                    u32 b = a bitand compl 0xFFFu, o = a bitand 0xFFF;
+                    if( b == 0x40003000 or b == 0x40004000 ){
+                        auto& t = twim[ b == 0x40004000 ];
+                        if( o == 0x4C4 ) t.errorsrc( old, v );
+                        else t.write( o, v );
+                    }
+                    else if( b == 0x40009000 ) timer1.write( o, v );
+                    else if( b == 0x4000A000 ) timer2.write( o, v );
+                    else if( b == 0x50000000 ) port.write( o, v );
+                    else if( b == 0x40007000 ) saadc.write( o, v );
+                    else if( b == 0x40006000 ){
+                        if( o == 0x304 ) port.gpioteInten or_eq v;
+                        if( o == 0x308 ) port.gpioteInten and_eq compl v;
+                        if( o == 0x304 or o == 0x308 ){ r(0x40006304) = port.gpioteInten; r(0x40006308) = port.gpioteInten; }
+                    }
+                }
+
+                inline void
+task            (u32 a) {
+                    u32 old = r( a );
+                    r( a ) = 1;
+                    apply( a, 1, old );
+                }
+
+    inline bool line(u8 n) {
+                    switch( n ){
+                        case TWIM0_IRQ:  return twim[0].line();
+                        case TWIM1_IRQ:  return twim[1].line();
+                        case GPIOTE_IRQ: return r(0x4000617C) and (port.gpioteInten bitand (1u<<31));
+                        case SAADC_IRQ:  return saadc.line();
+                        case TIMER1_IRQ: return timer1.line();
+                        case TIMER2_IRQ: return timer2.line();
+                        case RTC1_IRQ:   return rtcLine();
+                    }
+                    return false;
+                }
+
+                //level irqs pend, a new pend is a wakeup event (SEVONPEND)
+                inline void
+update          () {
+                    for( u8 n : { TWIM0_IRQ, TWIM1_IRQ, GPIOTE_IRQ, SAADC_IRQ, TIMER1_IRQ, TIMER2_IRQ, RTC1_IRQ } ){
+                        if( pend[n] or not line(n) ) continue;
+                        pend[n] = true;
+                        if( SCR bitand SEVONPEND ) event = true;
+                    }
+                }
+
+}
+
+//the firmware irq handlers (weak, a test may not have some of them)
+extern "C" {
+    [[gnu::weak]] void SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler(void);
+    [[gnu::weak]] void SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQHandler(void);
+    [[gnu::weak]] void GPIOTE_IRQHandler(void);
+    [[gnu::weak]] void SAADC_IRQHandler(void);
+    [[gnu::weak]] void TIMER1_IRQHandler(void);
+    [[gnu::weak]] void TIMER2_IRQHandler(void);
+}
+
+namespace emu {
+
+    inline void handler(u8 n) {
+                    void (*h)(void) = nullptr;
+                    switch( n ){
+                        case TWIM0_IRQ:  h = SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler; break;
+                        case TWIM1_IRQ:  h = SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQHandler; break;
+                        case GPIOTE_IRQ: h = GPIOTE_IRQHandler; break;
+                        case SAADC_IRQ:  h = SAADC_IRQHandler; break;
+                        case TIMER1_IRQ: h = TIMER1_IRQHandler; break;
+                        case TIMER2_IRQ: h = TIMER2_IRQHandler; break;
+                        case RTC1_IRQ:   h = rtcIsr; break;
+                    }
+                    if( h ) h();
+                }
+
+                //take pending enabled irqs, 1 level (all are priority 6)
+                inline void
+dispatch        () {
+                    if( inIrq or critical ) return;
+                    for( u32 guard = 0; ; guard++ ){
+                        if( guard > 100000 ){ fprintf( stderr, "emu: irq storm\n" ); abort(); }
+                        update();
+                        u8 n = 0;
+                        for( u8 k = 0; k < 32; k++ ) if( pend[k] and (en[k] or k == RTC1_IRQ) ){ n = k; break; }
+                        if( n == 0 ) return;
+                        pend[n] = false;
+                        inIrq = true;
+                        irqs[n]++;
+                        T64 t0 = now;
+                        handler( n );
+                        irqUs += now - t0;
+                        inIrq = false;
+                        event = true; //exception return
+                    }
+                }
+
+    inline T64 nextEvent() {
+                    T64 t = NEVER;
+                    auto m = [&](T64 v){ if( v < t ) t = v; };
+                    m( timer1.next() ); m( timer2.next() ); m( saadc.next() );
+                    for( auto& w : twim ) m( w.due );
+                    for( u8 k = 0; k < apptimerN; k++ ) if( apptimers[k].on ) m( apptimers[k].due );
+                    for( auto d : devices ) if( d ) m( d->next() );
+                    for( auto& a : at_ ) if( a.f ) m( a.t );
+                    return t;
+                }
+
+                //everything due at now
+                inline void
+process         () {
+                    timer1.check(); timer2.check();
+                    saadc.process();
+                    for( auto& w : twim ) w.process();
+                    for( auto d : devices ) if( d and d->next() <= now ) d->process();
+                    for( auto& a : at_ ){
+                        if( not a.f or a.t > now ) continue;
+                        auto f = a.f; a.f = nullptr;
+                        f();
+                    }
+                    port.update();
+                    update();
+                    dispatch();
+                }
+
+                //time moves to until (irqs run on the way)
+                inline void
+advance         (T64 until) {
+                    while( now < until ){
+                        T64 t = nextEvent();
+                        if( t > until ) t = until;
+                        if( t > now ) now = t;
+                        process();
+                    }
+                }
+
+                //test side waits (thread mode)
+                inline void
+wait            (T64 us) { advance( now + us ); }
+
+                template<typename F>
+                inline bool
+waitFor         (F done, T64 maxUs) {
+                    T64 end = now + maxUs;
+                    while( not done() ){
+                        if( now >= end ) return false;
+                        T64 t = nextEvent();
+                        advance( t < end ? t : end );
+                    }
+                    return true;
+                }
+
+//------------
+//  traps
+//------------
+
+    inline uintptr_t trapAddr[16];
+    inline u32       trapOld[16];
+    inline bool      trapRead[16];
+    inline int       trapDepth{ 0 };
+
+                //last read of each TWIM register (writes seen, time)
+    struct Poll { u32 writes; T64 at{ NEVER }; };
+    inline Poll polls[2][1024];
+
+                //a read that nothing changed since the last one is a poll
+                //loop, the cpu spins until the next event
+                inline void
+poll            (u32 a) {
+                    auto& s = polls[ (a >> 12) bitand 1 ][ (a bitand 0xFFF) >> 2 ];
+                    if( s.writes == writes and s.at == now ){
+                        T64 t = nextEvent();
+                        if( t != NEVER ) advance( t );
+                    }
+                    s = { writes, now };
+                }
+
+    inline void segv(int, siginfo_t* si, void* ctx) {
+                    auto a = (uintptr_t)si->si_addr;
+                    auto p = a < 0x100000000ull ? page( (u32)a ) : nullptr;
+                    if( not p or not p->trap or trapDepth >= 16 ){
+                        fprintf( stderr, "emu: segfault at %p\n", (void*)a );
+                        signal( SIGSEGV, SIG_DFL );
+                        return;
+                    }
+                    bool isRead = not (((ucontext_t*)ctx)->uc_mcontext.gregs[REG_ERR] bitand 2);
+                    //a read-modify-write faults again for the write
+                    if( trapDepth and trapRead[trapDepth-1] and trapAddr[trapDepth-1] == a ) trapDepth--;
+                    else if( isRead ) poll( (u32)a );
+                    trapRead[trapDepth] = isRead;
+                    trapAddr[trapDepth] = a;
+                    trapOld[trapDepth++] = r( (u32)a bitand compl 3u );
+                    mprotect( (void*)(uintptr_t)p->base, 4096, isRead ? PROT_READ : PROT_READ|PROT_WRITE );
+                    ((ucontext_t*)ctx)->uc_mcontext.gregs[REG_EFL] or_eq 0x100; //trap flag
+                }
+
+    inline void trap(int, siginfo_t*, void* ctx) {
+                    ((ucontext_t*)ctx)->uc_mcontext.gregs[REG_EFL] and_eq compl 0x100;
+                    if( trapDepth == 0 ) return;
+                    trapDepth--;
+                    u32 a = (u32)trapAddr[trapDepth] bitand compl 3u;
+                    u32 old = trapOld[trapDepth];
+                    auto p = page( a );
+                    mprotect( (void*)(uintptr_t)p->base, 4096, p->poll ? PROT_NONE : PROT_READ );
+                    if( trapRead[trapDepth] ) return;
+                    u32 v = r( a ); //as written (a task reads back 0 after apply)
+                    apply( a, v, old );
+                    if( onWrite ) onWrite( a, v );
+                    update();
+                    dispatch();
+                }
+
+    struct Init {
+        Init() {
+            for( auto& p : pages ){
+                int fd = memfd_create( "emu", 0 );
+                if( fd < 0 or ftruncate(fd, 4096) ) abort();
+                auto fw = mmap( (void*)(uintptr_t)p.base, 4096, p.poll ? PROT_NONE : p.trap ? PROT_READ : PROT_READ|PROT_WRITE,
+                                MAP_SHARED|MAP_FIXED_NOREPLACE, fd, 0 );
+                p.rw = (u8*)mmap( nullptr, 4096, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0 );
+                if( fw != (void*)(uintptr_t)p.base or p.rw == MAP_FAILED ){ fprintf( stderr, "emu: map %x\n", p.base ); abort(); }
+                close( fd );
+            }
+            //reset values
+            r( 0x40003524 ) = r( 0x40004524 ) = 0x04000000;   //TWIM FREQUENCY 250k
+            r( 0x40003508 ) = r( 0x4000350C ) = compl 0u;     //PSEL disconnected
+            r( 0x40004508 ) = r( 0x4000450C ) = compl 0u;
+            for( u8 p = 0; p < 32; p++ ) r( 0x50000700 + 4*p ) = 2; //input, buffer off
+            struct sigaction s{};
+            s.sa_flags = SA_SIGINFO | SA_NODEFER;
+            sigemptyset( &s.sa_mask );
+            s.sa_sigaction = segv;
+            sigaction( SIGSEGV, &s, nullptr );
+            s.sa_sigaction = trap;
+            sigaction( SIGTRAP, &s, nullptr );
+        }
+    };
+    inline Init init_;
+
+                //run body on a stack below 4GB (EasyDMA addresses are u32)
+                inline void
+run             (void (*body)()) {
+                    static ucontext_t main_, ctx;
+                    static void (*f)();
+                    f = body;
+                    size_t n = 1<<20;
+                    auto stk = mmap( nullptr, n, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_32BIT, -1, 0 );
+                    if( stk == MAP_FAILED ) abort();
+                    getcontext( &ctx );
+                    ctx.uc_stack.ss_sp = stk;
+                    ctx.uc_stack.ss_size = n;
+                    ctx.uc_link = &main_;
+                    makecontext( &ctx, []{ f(); }, 0 );
+                    swapcontext( &main_, &ctx );
+                    munmap( stk, n );
+                }
+
+//------------
+//  TMP117
+//------------
+
+    struct Tmp117 : Device {
+        i8      alert;
+        u16     config  { 0x0220 };
+        i16     limit[2]{ 0x6000, (i16)0x8000 };
+        i16     temp    { (i16)0x8000 };
+        u8      ptr     { 0 };
+        u8      wn      { 0 }, rn{ 0 };
+        u8      wb[2];
+        u16     rv      { 0 };
+        T64     readyAt { 0 };      //startup done
+        T64     convEnd { NEVER };
+        T64     cycleAt { 0 };      //start of the running cycle (continuous)
+        double  tempC   { 25.0 };
+        double  (*tempAt)(T64 us){ nullptr };   //test- temperature over time
+        double  noiseLsb{ 0 };      //test- rms noise of 1 conversion, /sqrt(averages)
+        std::mt19937 rng{ 117 };
+                //supply charge, 135uA while starting up or converting, 0.25uA
+                //otherwise (shutdown, standby between cycles), nC
+        double  chargeNc{ 0 };
+        T64     chargeAt{ 0 };
+        T64     actFrom { 0 }, actTo{ 0 };
+                //counters
+        u32     configReads{ 0 }, configWrites{ 0 }, tempReads{ 0 }, limitWrites{ 0 }, conversions{ 0 };
+
+        static constexpr u32 AVG_US[]  { 15500, 125000, 500000, 1000000 };
+        static constexpr u32 AVG_N[]   { 1, 8, 32, 64 };
+        static constexpr u32 CYCLE_US[]{ 15500, 125000, 250000, 500000, 1000000, 4000000, 8000000, 16000000 };
+        static constexpr u32 STARTUP_US{ 1500 };
+
+        Tmp117(u8 a = 0x48, i8 pwr = -1, i8 alertPin = -1) : Device(a, pwr), alert(alertPin) {}
+
+        u8   mode   () { return (config>>10) bitand 3; }
+        u32  convUs () { return AVG_US[ (config>>5) bitand 3 ]; }
+        u32  avgN   () { return AVG_N[ (config>>5) bitand 3 ]; }
+        u32  cycleUs() { u32 c = CYCLE_US[ (config>>7) bitand 7 ]; return c > convUs() ? c : convUs(); }
+        i16  raw    () {
+                        double c = tempAt ? tempAt( now ) : tempC;
+                        double v = c * 128.0;
+                        if( noiseLsb > 0 ) v += std::normal_distribution<double>( 0, noiseLsb/sqrt((double)avgN()) )( rng );
+                        v += v < 0 ? -0.5 : 0.5;
+                        return v > 32767 ? 32767 : v < -32768 ? -32768 : (i16)v;
+                    }
+                    //CONVMODE changed, or power on
+        void mode_  () {
+                        T64 from = now > readyAt ? now : readyAt;
+                        switch( mode() ){
+                            case 1: convEnd = NEVER; break;
+                            case 3: convEnd = from + convUs(); break;
+                            default: cycleAt = from; convEnd = from + convUs();
+                        }
+                        if( convEnd != NEVER ){ if( actTo <= now ) actFrom = from; actTo = convEnd; }
+                        else if( actTo > now ) actTo = from; //shutdown, a startup still counts
+                    }
+                    //charge up to now, called before any change of state
+        void charge () {
+                        if( on ){
+                            T64 a = actFrom > chargeAt ? actFrom : chargeAt;
+                            T64 b = actTo < now ? actTo : now;
+                            T64 act = b > a ? b - a : 0;
+                            chargeNc += (act * 135.0 + (now - chargeAt - act) * 0.25) / 1000;
+                        }
+                        chargeAt = now;
+                    }
+        void reset  () {
+                        config = 0x0220; limit[0] = 0x6000; limit[1] = (i16)0x8000; temp = (i16)0x8000;
+                        readyAt = now + STARTUP_US;
+                        mode_();
+                    }
+        void power  (bool o) override {
+                        charge();
+                        on = o;
+                        if( o ){ reset(); actFrom = now; } else { convEnd = NEVER; config = 0x0220; }
+                    }
+        bool start  (bool read) override {
+                        if( now < readyAt ){ return false; }
+                        wn = 0; rn = 0;
+                        (void)read;
+                        return true;
+                    }
+        bool write  (u8 b) override {
+                        if( wn == 0 ){ ptr = b bitand 0xF; wn++; return true; }
+                        if( wn <= 2 ) wb[wn-1] = b;
+                        if( ++wn == 3 ) store( ptr, (wb[0]<<8) bitor wb[1] );
+                        return true;
+                    }
+        u8   read   () override {
+                        if( rn++ == 0 ){ rv = load( ptr ); return rv>>8; }
+                        return rv;
+                    }
+        void store  (u8 reg, u16 v) {
+                        switch( reg ){
+                            case 1:
+                                charge();
+                                configWrites++;
+                                if( v bitand 2 ){ reset(); return; } //SOFTRESET
+                                config = (config bitand compl 0x0FFCu) bitor (v bitand 0x0FFC);
+                                mode_();
+                                return;
+                            case 2: case 3: limitWrites++; limit[reg-2] = v; return;
+                        }
+                    }
+        u16  load   (u8 reg) {
+                        switch( reg ){
+                            case 0: tempReads++; config and_eq compl (1u<<13); return temp;
+                            case 1: {
+                                configReads++;
+                                u16 v = config;
+                                config and_eq compl (1u<<13 bitor 1u<<14 bitor 1u<<15);
+                                return v;
+                            }
+                            case 2: case 3: return limit[reg-2];
+                            case 15: return 0x0117;
+                        }
+                        return 0;
+                    }
+        T64  next   () override { return on ? convEnd : NEVER; }
+        void process() override {
+                        if( not on or convEnd > now ) return;
+                        charge();
+                        temp = raw();
+                        conversions++;
+                        config or_eq 1u<<13; //DATAREADY
+                        if( not (config bitand (1u<<4)) ){ //alert mode, flags stay until a CONFIG read
+                            if( temp > limit[0] ) config or_eq 1u<<15;
+                            if( temp < limit[1] ) config or_eq 1u<<14;
+                        }
+                        if( mode() == 3 ){ config = (config bitand compl (3u<<10)) bitor (1u<<10); convEnd = NEVER; }
+                        else { cycleAt += cycleUs(); convEnd = cycleAt + convUs(); actFrom = cycleAt; actTo = convEnd; }
+                    }
+        i8   alertPin() override { return alert; }
+        bool alertLow() override {
+                        if( not on ) return false;
+                        bool active = config bitand (1u<<2) ? bool(config bitand (1u<<13)) : bool(config bitand (3u<<14));
+                        return active != bool(config bitand (1u<<3)); //POL 0 = active low
+                    }
+    };
+
+//------------
+//  Si7051
+//------------
+
+    struct Si7051 : Device {
+        u8      user    { 0x3A };   //user register 1, resolution bits 7,0
+        u8      cmd     { 0 };
+        u8      wn      { 0 }, rn{ 0 };
+        u16     code    { 0 };
+        T64     readyAt { 0 };      //power up (or reset) done
+        T64     convEnd { NEVER };
+        double  tempC   { 25.0 };
+        double  (*tempAt)(T64 us){ nullptr };   //test- temperature over time
+        double  convScale{ 1.0 };   //test- conversion time x (1 = datasheet max)
+                //supply charge, 120uA while powering up (or reset) or
+                //converting, 0.06uA standby, nC
+        double  chargeNc{ 0 };
+        T64     chargeAt{ 0 };
+        T64     actFrom { 0 }, actTo{ 0 };
+                //counters
+        u32     convStarts{ 0 }, pollNacks{ 0 }, userWrites{ 0 }, userReads{ 0 }, tempReads{ 0 };
+
+                //14, 12, 13, 11 bit (bits 7,0 of the user register)
+        static constexpr u32 CONV_US[]{ 10800, 3800, 6200, 2400 };
+        static constexpr u8  BITS[]   { 14, 12, 13, 11 };
+        static constexpr u32 POWERUP_US{ 25000 };
+        static constexpr u32 RESET_US  { 15000 };
+
+        Si7051(u8 a = 0x40, i8 pwr = -1) : Device(a, pwr) {}
+
+        u8   res    () { return ((user>>6) bitand 2) bitor (user bitand 1); }
+        u32  convUs () { return CONV_US[ res() ] * convScale; }
+        u16  value  () {
+                        double c = tempAt ? tempAt( now ) : tempC;
+                        double v = (c + 46.85) * 65536 / 175.72;
+                        v = v < 0 ? 0 : v > 65535 ? 65535 : v;
+                        return (u16)v bitand (0xFFFFu << (16 - BITS[res()]));
+                    }
+                    //charge up to now, called before any change of state
+        void charge () {
+                        if( on ){
+                            T64 a = actFrom > chargeAt ? actFrom : chargeAt;
+                            T64 b = actTo < now ? actTo : now;
+                            T64 act = b > a ? b - a : 0;
+                            chargeNc += (act * 120.0 + (now - chargeAt - act) * 0.06) / 1000;
+                        }
+                        chargeAt = now;
+                    }
+        void active (T64 to) { charge(); actFrom = now; actTo = to; }
+        void power  (bool o) override {
+                        charge();
+                        on = o;
+                        user = 0x3A; cmd = 0; convEnd = NEVER;
+                        readyAt = now + POWERUP_US;
+                        if( o ) active( readyAt );
+                    }
+        bool start  (bool read) override {
+                        if( now < readyAt ) return false;
+                        if( read and cmd == 0xF3 and now < convEnd ){ pollNacks++; return false; }
+                        wn = 0; rn = 0;
+                        return true;
+                    }
+        bool write  (u8 b) override {
+                        if( wn++ ){
+                            if( cmd == 0xE6 ){ user = (user bitand 0x7E) bitor (b bitand 0x81); userWrites++; }
+                            return true;
+                        }
+                        cmd = b;
+                        switch( b ){
+                            case 0xE3: case 0xF3: convStarts++; convEnd = now + convUs(); active( convEnd ); break;
+                            case 0xE7: userReads++; break;
+                            case 0xFE: user = 0x3A; convEnd = NEVER; readyAt = now + RESET_US; active( readyAt ); break;
+                        }
+                        return true;
+                    }
+        u8   read   () override {
+                        if( cmd == 0xE7 ) return user;
+                        if( cmd != 0xE3 and cmd != 0xF3 ) return 0xFF;
+                        if( rn++ == 0 ){ code = value(); tempReads++; return code>>8; }
+                        return rn == 2 ? code : 0; //crc not checked by the driver
+                    }
+                    //hold master, SCL held until the conversion is done
+        u32  stretch() override {
+                        if( cmd != 0xE3 or rn or now >= convEnd ) return 0;
+                        return convEnd - now;
+                    }
+    };
+
+}
+
+//------------
+//  sdk functions (replace the weak stubs)
+//------------
+
+void __WFE() {
+    using namespace emu;
+    if( event ){ event = false; return; }
+    auto t0 = now;
+    wfes++;
+    while( not event ){
+        auto t = nextEvent();
+        if( t == NEVER ){ fprintf( stderr, "emu: __WFE with nothing to wake it\n" ); abort(); }
+        if( t > now ) now = t;
+        process();
+    }
+    event = false;
+    asleepUs += now - t0;
+}
+void __SEV() { emu::event = true; }
+
+void nrf_delay_us(uint32_t us) { emu::wait( us ); }
+void nrf_delay_ms(uint32_t ms) { emu::wait( (emu::T64)ms * 1000 ); }
+
+uint32_t sd_nvic_EnableIRQ(IRQn_Type n) { emu::en[n] = true; emu::update(); emu::dispatch(); return 0; }
+uint32_t sd_nvic_DisableIRQ(IRQn_Type n) { emu::en[n] = false; return 0; }
+uint32_t sd_nvic_SetPriority(IRQn_Type, uint32_t p) { return p == 6 ? 0 : 1; }
+uint32_t sd_nvic_ClearPendingIRQ(IRQn_Type n) { emu::pend[n] = false; emu::update(); return 0; }
+                //irqs wait until the outer region is left
+uint32_t sd_nvic_critical_region_enter(uint8_t* n) { *n = emu::critical; emu::critical = 1; return 0; }
+uint32_t sd_nvic_critical_region_exit(uint8_t n) {
+    emu::critical = n;
+    if( not n ){ emu::update(); emu::dispatch(); }
+    return 0;
+}
+
+uint32_t sd_ppi_channel_assign(uint8_t ch, const volatile void* e, const volatile void* t) {
+    if( ch >= 20 or ((1u<<ch) bitand NRF_SOC_SD_PPI_CHANNELS_SD_ENABLED_MSK) ) return 1;
+    emu::ppi[ch] = { (u32)(uintptr_t)e, (u32)(uintptr_t)t };
+    return 0;
+}
+uint32_t sd_ppi_channel_enable_set(uint32_t m) {
+    if( m bitand NRF_SOC_SD_PPI_CHANNELS_SD_ENABLED_MSK ) return 1;
+    emu::ppiEn or_eq m;
+    return 0;
+}
+uint32_t sd_ppi_channel_enable_clr(uint32_t m) { emu::ppiEn and_eq compl m; return 0; }
+
+uint32_t app_timer_init() { return 0; }
+uint32_t app_timer_create(const app_timer_id_t* id, int mode, app_timer_timeout_handler_t h) {
+    using namespace emu;
+    if( apptimerN >= 32 ) return 4;
+    (*id)->d[0] = ++apptimerN;
+    apptimers[apptimerN-1] = { h, mode, false, 0, 0, nullptr };
+    return 0;
+}
+uint32_t app_timer_start(app_timer_id_t id, uint32_t ticks, void* ctx) {
+    using namespace emu;
+    if( id->d[0] == 0 or ticks < 5 ) return 7; //NRF_ERROR_INVALID_PARAM (min 5 ticks)
+    auto& t = apptimers[ id->d[0]-1 ];
+    t.period = ticksUs( ticks );
+    t.due = now + t.period;
+    t.ctx = ctx;
+    t.on = true;
+    return 0;
+}
+uint32_t app_timer_stop(app_timer_id_t id) {
+    if( id->d[0] ) emu::apptimers[ id->d[0]-1 ].on = false;
+    return 0;
+}
+uint32_t app_timer_cnt_get() { return (uint32_t)(emu::now * 16384 / 1000000) bitand 0xFFFFFF; }
+
+inline int32_t emuTempQ{ 100 }; //sd_temp_get, 0.25C units
+uint32_t sd_temp_get(int32_t* t) { *t = emuTempQ; return 0; }
@@ -0,0 +1,89 @@
+/*------------------------------------------------------------------------------
+    filter - [user-009] step response and ram of the filter policies
+
+    each policy starts at 0 and gets a step to 1000 (Fx10), the samples
+    until the output reaches 63% and 100% are checked, a single spike is
+    checked for Median, that Decimate only updates every R_ adds, and sizeof
+    each policy against the ram table in Filter.hpp
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "Filter.hpp"
+#include <initializer_list>
+
+struct Step { int to63; int to100; };
+
+//samples after the step until the output is >= 630, == 1000
+template<typename F> Step
+step            ()
+                {
+                F f;
+                f.add( 0 );
+                Step s{ -1, -1 };
+                for( int n = 1; n <= 200; n++ ){
+                    f.add( 1000 );
+                    if( s.to63 < 0 and f.value() >= 630 ) s.to63 = n;
+                    if( s.to100 < 0 and f.value() == 1000 ){ s.to100 = n; break; }
+                }
+                return s;
+                }
+
+template<typename F> void
+show            (const char* name, Step s)
+                { printf( "  %-18s 63%% %3d  100%% %3d  %2u bytes\n", name, s.to63, s.to100, (unsigned)sizeof(F) ); }
+
+int main(){
+
+    auto nf = step<NoFilter>();
+    auto bx = step<Boxcar<8>>();
+    auto e2 = step<Ema<2>>();
+    auto e3 = step<Ema<3>>();
+    auto m3 = step<Median<3>>();
+    auto m5 = step<Median<5>>();
+    auto d4 = step<Decimate<4>>();
+    show<NoFilter>( "NoFilter", nf );
+    show<Boxcar<8>>( "Boxcar<8>", bx );
+    show<Ema<2>>( "Ema<2>", e2 );
+    show<Ema<3>>( "Ema<3>", e3 );
+    show<Median<3>>( "Median<3>", m3 );
+    show<Median<5>>( "Median<5>", m5 );
+    show<Decimate<4>>( "Decimate<4>", d4 );
+
+    CHECK( nf.to63 == 1 and nf.to100 == 1 );
+    CHECK( bx.to63 == 6 and bx.to100 == 8 );
+    CHECK( e2.to63 >= 3 and e2.to63 <= 5 and e2.to100 > 0 );   //~2^Shift_
+    CHECK( e3.to63 >= 7 and e3.to63 <= 9 and e3.to100 > 0 );
+    CHECK( m3.to100 == 2 and m5.to100 == 3 );
+    CHECK( d4.to100 > 0 and d4.to100 < 2*4 );
+
+    //Decimate output only changes every R_ adds
+    Decimate<4> d;
+    u32 changes = 0;
+    i16 last = 0;
+    d.add( 0 );
+    for( int i = 1; i <= 40; i++ ){ d.add( i*10 ); if( d.value() != last ){ changes++; last = d.value(); } }
+    CHECK( changes == 10 );
+
+    //spike rejection
+    Median<3> m;
+    for( i16 v : { 700, 700, 1500, 700, 700 } ){ m.add( v ); CHECK( m.value() == 700 ); }
+    Median<5> m5s;
+    for( i16 v : { 700, 1500, 1500, 700, 700 } ){ m5s.add( v ); CHECK( m5s.value() == 700 ); }
+
+    //negative values round to nearest
+    Ema<3> en;
+    en.add( -400 );
+    CHECK( en.value() == -400 );
+    for( int i = 0; i < 200; i++ ) en.add( -401 );
+    CHECK( en.value() == -401 );
+
+    //ram table in Filter.hpp (the same sizes on the nRF52)
+    CHECK( sizeof(NoFilter) == 2 );
+    CHECK( sizeof(Ema<3>) == 2 );
+    CHECK( sizeof(Median<3>) == 2*3 + 2 and sizeof(Median<5>) == 2*5 + 2 );
+    CHECK( sizeof(Decimate<4, Ema<3>>) == ((6 + sizeof(Ema<3>) + 3) bitand ~3u) );
+    CHECK( sizeof(Decimate<4, Median<5>>) == ((6 + sizeof(Median<5>) + 3) bitand ~3u) );
+    CHECK( sizeof(Boxcar<64>) >= 2*64 and sizeof(Boxcar<64>) <= 2*64 + 32 );
+
+    return Test::result( "filter" );
+}
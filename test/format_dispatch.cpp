@@ -0,0 +1,84 @@
+/*------------------------------------------------------------------------------
+    format_dispatch - [user-002] FormatT static dispatch vs the virtual Format
+
+    the same call sites as Temperature.hpp (raw/F line) and Advertising.hpp
+    (packet dump) go to a FormatT device and to a Format (virtual) device,
+    output must be identical, the FormatT devices must have no vtable,
+    the time per line of each is printed (the make target also prints the
+    code size of both sites<> instantiations from the symbol table)
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include <chrono>
+#include <string>
+#include <type_traits>
+
+//fixed buffer devices, so the timing is the formatting and not std::string
+struct StaticDev : FormatT<StaticDev> {
+                char buf[256]; unsigned n{ 0 };
+                bool
+put             (const char c){ if( n < sizeof buf ) buf[n++] = c; return true; }
+                unsigned
+write           (const char* s, unsigned len){ for( unsigned i = 0; i < len; i++ ) put( s[i] ); return len; }
+};
+
+struct VirtualDev : Format {
+                char buf[256]; unsigned n{ 0 };
+                bool
+put             (const char c) override { if( n < sizeof buf ) buf[n++] = c; return true; }
+                unsigned
+write           (const char* s, unsigned len) override { for( unsigned i = 0; i < len; i++ ) put( s[i] ); return len; }
+};
+
+static const u8 buffer_[]{ 2,1,6, 3,0xFF,0x34,0x12, 11,9,'2','5','.','3','F',' ','N','o','N','a','m' };
+
+template<typename D> [[gnu::noinline]] void
+sites           (D& d, i16 t)
+                {
+                d.n = 0;
+                //Temperature.hpp
+                auto f = t * 9 / 8 + 320; //F*10 (approx, only the formatting matters)
+                auto f10 = f / 10, f1 = f < 0 ? -f % 10 : f % 10;
+                d << "  Tmp117 raw: " << t << "  F: " << setwf(2,'0') << f10 << "." << f1 << endl;
+                //Advertising.hpp
+                for( u32 i = 0; i < sizeof buffer_; ){
+                    u8 len = buffer_[i++];
+                    u8 typ = buffer_[i++];
+                    d << reset << "  len: " << setwf(2,' ') << len--
+                      << "  type: " << Hex << setwf(2,'0') << typ << "  data: ";
+                    if( typ == 9 ) d << setwmax(len) << (char*)&buffer_[i] << ' ' << setwmax(0);
+                    else for( u8 j = 0; j < len; j++ ) d << setwf(2,'0') << Hex << buffer_[i+j] << ' ';
+                    i += len;
+                    d << endl;
+                }
+                }
+
+template<typename D> double
+nsPerCall       (D& d)
+                {
+                using namespace std::chrono;
+                constexpr int N = 200000;
+                auto t0 = steady_clock::now();
+                for( int i = 0; i < N; i++ ) sites( d, (i16)(i & 0x3FFF) );
+                return duration<double, std::nano>( steady_clock::now() - t0 ).count() / N;
+                }
+
+int main(){
+
+    CHECK( not std::is_polymorphic_v<StaticDev> );
+    CHECK( not std::is_polymorphic_v<DevRtt<0>> );
+    CHECK( not std::is_polymorphic_v<BufFormat<32>> );
+    CHECK( not std::is_polymorphic_v<NullFormat> );
+    CHECK( std::is_polymorphic_v<Format> );
+
+    StaticDev s; VirtualDev v;
+    for( i16 t : { (i16)0, (i16)3240, (i16)-1000, (i16)32767, (i16)-32768 } ){
+        sites( s, t ); sites( v, t );
+        CHECK( std::string(s.buf, s.n) == std::string(v.buf, v.n) );
+    }
+
+    auto ns = nsPerCall( s ), nv = nsPerCall( v );
+    printf( "  FormatT %.1f ns, Format (virtual) %.1f ns per call\n", ns, nv );
+
+    return Test::result( "format_dispatch" );
+}
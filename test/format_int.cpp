@@ -0,0 +1,121 @@
+/*------------------------------------------------------------------------------
+    format_int - [user-003] integer formatting without runtime division
+
+    div100_ is checked against v/100 for every u32, the formatted output
+    is checked against snprintf digits (binary by hand) plus the Format
+    rules for sign/showbase/fill, for every option combination on a set
+    of edge and random values, and all digits-only values up to 2^24,
+    then prints the throughput next to snprintf
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+struct Dev : FormatT<Dev> {
+                char buf[160]; unsigned n{ 0 };
+                bool
+put             (const char c){ buf[n++] = c; return true; }
+                unsigned
+write           (const char* s, unsigned len){ __builtin_memcpy( &buf[n], s, len ); n += len; return len; }
+                auto
+str             (){ return std::string( buf, n ); }
+                static auto
+div100          (u32 v){ return div100_( v ); }
+};
+
+struct Opt { int base; bool uc, sb, pos; char fill; int w; };
+
+//what Format produces, digits from snprintf
+static std::string
+expect          (u32 v, bool neg, const Opt& o)
+                {
+                char d[40];
+                if( o.base == 10 ) snprintf( d, sizeof d, "%u", v );
+                else if( o.base == 16 ) snprintf( d, sizeof d, o.uc ? "%X" : "%x", v );
+                else if( o.base == 8 ) snprintf( d, sizeof d, "%o", v );
+                else { int i = 0; u32 m = v; do{ i++; m >>= 1; } while( m );
+                       d[i] = 0; m = v; while( i-- ){ d[i] = '0' + (m bitand 1); m >>= 1; } }
+                std::string x;
+                if( o.base == 10 ){ if( neg ) x = "-"; else if( o.pos ) x = "+"; }
+                else if( o.sb and not (o.base == 8 and v == 0) ) x = o.base == 16 ? "0x" : o.base == 2 ? "0b" : "0";
+                char fc = o.fill ? o.fill : ' ';
+                std::string s = d;
+                //'0' fill goes between the sign/base and the digits, else in front of both
+                if( fc == '0' ){ while( (int)s.size() < o.w ) s = fc + s; return x + s; }
+                s = x + s;
+                while( (int)s.size() < o.w ) s = fc + s;
+                return s;
+                }
+
+static std::string
+format          (Dev& d, u32 v, bool neg, const Opt& o)
+                {
+                d.n = 0;
+                d.reset().base( o.base ).uppercase( o.uc ).showbase( o.sb )
+                 .positive( o.pos ).fill( o.fill ).width( o.w );
+                if( neg ) d << (i32)(0 - v); else d << v;
+                return d.str();
+                }
+
+int main(){
+
+    //reciprocal divide, every u32
+    u32 bad = 0, v = 0;
+    do{ if( Dev::div100(v) != v/100 ) bad++; } while( ++v );
+    CHECK( bad == 0 );
+
+    //value set- edges around every power of the bases, and random
+    std::vector<u32> vals{ 0, 1, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF };
+    for( u64 p = 1; p <= 0xFFFFFFFFu; p *= 10 ) for( int k = -2; k <= 2; k++ ) vals.push_back( (u32)(p + k) );
+    for( int b = 0; b < 32; b++ ) for( int k = -1; k <= 1; k++ ) vals.push_back( (1u<<b) + k );
+    std::mt19937 rng( 1 );
+    for( int i = 0; i < 2000; i++ ) vals.push_back( rng() >> (rng() % 32) );
+
+    Dev d;
+    u32 mismatches = 0, total = 0;
+    for( int base : { 2, 8, 10, 16 } )
+    for( bool uc : { false, true } )
+    for( bool sb : { false, true } )
+    for( bool pos : { false, true } )
+    for( char fill : { '\0', ' ', '0', '*' } )
+    for( int w : { 0, 1, 3, 11, 40 } )
+    for( auto x : vals )
+    for( bool neg : { false, true } ){
+        if( neg and (base != 10 or x == 0 or x > 0x80000000) ) continue;
+        Opt o{ base, uc, sb, pos, fill, w };
+        total++;
+        if( format(d, x, neg, o) == expect(x, neg, o) ) continue;
+        if( mismatches++ < 5 ) printf( "  %u base %d: \"%s\" != \"%s\"\n", x, base,
+                                       format(d, x, neg, o).c_str(), expect(x, neg, o).c_str() );
+    }
+    CHECK( mismatches == 0 );
+
+    //digits only, every value to 2^24
+    mismatches = 0;
+    for( int base : { 10, 16 } ){
+        Opt o{ base, false, false, false, 0, 0 };
+        for( u32 x = 0; x < (1u<<24); x++ ) if( format(d, x, false, o) != expect(x, false, o) ) mismatches++;
+    }
+    CHECK( mismatches == 0 );
+    printf( "  %u option/value combinations, 2x 2^24 digits-only\n", total );
+
+    //throughput
+    using namespace std::chrono;
+    constexpr u32 N = 2000000;
+    volatile u32 sink = 0;
+    auto t0 = steady_clock::now();
+    for( u32 i = 0; i < N; i++ ){ d.n = 0; d << (i * 2654435761u); sink = sink + d.n; }
+    auto t1 = steady_clock::now();
+    for( u32 i = 0; i < N; i++ ){ d.n = 0; d << hex << (i * 2654435761u) << dec; sink = sink + d.n; }
+    auto t2 = steady_clock::now();
+    char sbuf[16];
+    for( u32 i = 0; i < N; i++ ) sink = sink + snprintf( sbuf, sizeof sbuf, "%u", i * 2654435761u );
+    auto t3 = steady_clock::now();
+    auto ns = [](auto a, auto b){ return duration<double, std::nano>( b - a ).count() / N; };
+    printf( "  dec %.1f ns, hex %.1f ns, snprintf %%u %.1f ns per u32\n", ns(t0,t1), ns(t1,t2), ns(t2,t3) );
+
+    return Test::result( "format_int" );
+}
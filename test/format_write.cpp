@@ -0,0 +1,95 @@
+/*------------------------------------------------------------------------------
+    format_write - [user-001] block write path in Format
+
+    a debug dump like Advertising::update and a debugHeader style line go
+    to a device with a block write and to a put-only device, the output
+    must be the same, the write device must see 1 call per token instead
+    of 1 per char, and DevRtt must make 1 SEGGER_RTT_Write per token
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include <string>
+
+using namespace fmt;
+
+//put only (FormatT default write, 1 char at a time through put)
+struct PutDev : FormatT<PutDev> {
+                std::string out;
+                unsigned puts{ 0 };
+                bool
+put             (const char c){ out += c; puts++; return true; }
+};
+
+//put + block write
+struct WriteDev : FormatT<WriteDev> {
+                std::string out;
+                unsigned puts{ 0 }, writes{ 0 };
+                bool
+put             (const char c){ out += c; puts++; return true; }
+                unsigned
+write           (const char* buf, unsigned len){ out.append( buf, len ); writes++; return len; }
+};
+
+//type-erased version, same counts through the virtual write
+struct VWriteDev : Format {
+                std::string out;
+                unsigned puts{ 0 }, writes{ 0 };
+                bool
+put             (const char c) override { out += c; puts++; return true; }
+                unsigned
+write           (const char* buf, unsigned len) override { out.append( buf, len ); writes++; return len; }
+};
+
+static unsigned rttCalls, rttBytes;
+unsigned SEGGER_RTT_Write(unsigned, const void*, unsigned n){ rttCalls++; rttBytes += n; return n; }
+
+//Advertising::update style dump (21 byte adv data), debugHeader style line
+template<typename D> D&
+dump            (D& d)
+                {
+                static const u8 adv[]{ 2,1,6, 3,0xFF,0x34,0x12, 11,9,'T','e','m','p','e','r','a','t','u','r' };
+                d << reset << FG SEA_GREEN << setfill('0')
+                  << '[' << setw(4) << 1234u << '.' << setw(6) << 567890u << ']'
+                  << '[' << "Advertising.hpp" << ':' << 212u << " ::" << "update" << ']'
+                  << endl << ANSI_NORMAL << reset;
+                d << "  adv data [" << dec << (u32)sizeof adv << "]:" << hex << setfill('0');
+                for( auto b : adv ) d << ' ' << setw(2) << b;
+                d << dec << endl << "  temp: " << setw(8) << setfill(' ') << -2537 << endl;
+                return d;
+                }
+
+int main(){
+
+    PutDev p;    dump( p );
+    WriteDev w;  dump( w );
+    VWriteDev v; dump( v );
+
+    CHECK( w.out == p.out );
+    CHECK( v.out == p.out );
+    CHECK( w.count() == p.count() ); //count since the last reset
+    CHECK( w.errors() == 0 );
+
+    //every char went through put for the put-only device, the write
+    //device only gets put for single chars, and far fewer calls overall
+    auto wcalls = w.puts + w.writes;
+    CHECK( p.puts == p.out.size() );
+    CHECK( wcalls * 2 < p.puts );
+    CHECK( v.puts == w.puts and v.writes == w.writes );
+
+    //DevRtt, 1 lock per call
+    DevRtt<0> rtt;
+    rttCalls = rttBytes = 0;
+    dump( rtt );
+    CHECK( rttBytes == p.out.size() );
+    CHECK( rttCalls == wcalls );
+    printf( "  %u chars: put-only %u calls, DevRtt %u SEGGER_RTT_Write\n",
+            (unsigned)p.out.size(), p.puts, rttCalls );
+
+    //BufFormat write, truncated to capacity but same prefix
+    BufFormat<32> b;
+    dump( b );
+    CHECK( std::string(b.buf()) == p.out.substr(0, b.length()) );
+    CHECK( b.length() == 31 );
+
+    return Test::result( "format_write" );
+}
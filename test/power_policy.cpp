@@ -0,0 +1,129 @@
+/*------------------------------------------------------------------------------
+    power_policy - [user-017] PowerGated vs PowerKeep across sample intervals
+
+    Tmp117Async (Tmp117Avg8) and Si7051Async read on the emulated ics at
+    1s to 5min, gated and kept on, the charge per sample is the ic supply
+    (emu models) + 0.3uC for each rail power up (~0.1uF at 3V) + 0.15uC for
+    each irq (wakeup), printed as the average current with the i2c traffic
+    and time per read, the policy PowerFor picks for an interval is checked
+    to be the lower one (or within 10% near the crossover)
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Tmp117.hpp"
+#include "Si7051.hpp"
+#include "Timer.hpp"
+
+using TmpIc  = Tmp117<decltype(board)::tmp117Twi>;
+using SiIc   = Si7051<decltype(board)::si7051Twi>;
+
+template<typename Power>
+using Tmp    = Tmp117Async<TmpIc, Timer, Tmp117NoAlert, Tmp117Avg8, Power>;
+template<typename Power>
+using Si     = Si7051Async<SiIc, Timer, Si7051Res::RES_12BIT, Power>;
+
+SCA N        { 20 };
+SCA RAIL_NC  { 300 };
+SCA WAKE_NC  { 150 };
+
+                //counts the power ups
+template<typename Ic>
+struct Rail : Ic {
+    using Ic::Ic;
+    u32 powerUps{ 0 };
+    void power(bool o) override { if( o and not this->on ) powerUps++; Ic::power( o ); }
+};
+
+static Rail<emu::Tmp117> tmp{ 0x48, P0_17 };
+static Rail<emu::Si7051> si{ 0x40, P0_17 };
+static bool done;
+
+struct Result { double ua; double xfers; double ms; };
+
+static u32
+wakeups         ()
+                {
+                u32 n = 0;
+                for( auto v : emu::irqs ) n += v;
+                return n;
+                }
+
+template<typename R>
+static bool
+read            ()
+                {
+                done = false;
+                if( not R::start( [](void*){ done = true; } ) ) return false;
+                emu::waitFor( []{ return done; }, 2000000 );
+                return R::status() == R::OK;
+                }
+
+                //N reads IntervalMs apart, after a first read (a kept ic is
+                //on from there), a failed read at the end powers off
+template<typename R, typename Ic>
+static Result
+run             (Ic& ic, u32 intervalMs)
+                {
+                u32 bad = 0;
+                if( not read<R>() ) bad++;
+                emu::wait( intervalMs*1000ull );
+                ic.charge();
+                auto c0 = ic.chargeNc;
+                auto p0 = ic.powerUps, w0 = wakeups(), x0 = ic.xfers;
+                double ms = 0;
+                for( int k = 0; k < N; k++ ){
+                    auto t0 = emu::now;
+                    if( not read<R>() ) bad++;
+                    ms += (emu::now - t0) / 1000.0;
+                    emu::wait( t0 + intervalMs*1000ull - emu::now );
+                }
+                ic.charge();
+                double nc = ic.chargeNc - c0 + RAIL_NC*(ic.powerUps - p0) + WAKE_NC*(wakeups() - w0);
+                CHECK( bad == 0 );
+                ic.nack = true; read<R>(); ic.nack = false;
+                CHECK( not ic.on );
+                return { nc / N / intervalMs, double(ic.xfers - x0) / N, ms / N };
+                }
+
+template<template<typename> class R, typename Pick, typename Ic>
+static void
+compare         (const char* name, Ic& ic, u32 intervalMs)
+                {
+                auto g = run<R<PowerGated>>( ic, intervalMs );
+                auto k = run<R<PowerKeep>>( ic, intervalMs );
+                printf( "  %-7s %4us  gated %6.3fuA %4.1f xfers %6.1fms   keep %6.3fuA %4.1f xfers %6.1fms   PowerFor %s\n",
+                        name, intervalMs/1000, g.ua, g.xfers, g.ms, k.ua, k.xfers, k.ms, Pick::KEEP ? "keep" : "gated" );
+                auto picked = Pick::KEEP ? k.ua : g.ua;
+                auto other = Pick::KEEP ? g.ua : k.ua;
+                CHECK( picked <= other * 1.10 );
+                //kept on- no startup/power up, less i2c traffic
+                CHECK( k.ms < g.ms and k.xfers < g.xfers );
+                }
+
+template<u32... Ms>
+static void
+sweep           ()
+                {
+                ( compare<Tmp, Tmp117PowerFor<Tmp117Avg8, Ms>>( "TMP117", tmp, Ms ), ... );
+                ( compare<Si, Si7051PowerFor<Ms>>( "Si7051", si, Ms ), ... );
+                }
+
+static void
+body            ()
+                {
+                emu::attach( tmp );
+                emu::attach( si );
+                tmp.tempC = 20.0;
+                si.tempC = 20.05;
+                sweep<1_sec, 2_sec, 5_sec, 10_sec, 20_sec, 60_sec, 120_sec, 300_sec>();
+
+                //the configured (adv) interval- TMP117 gated, Si7051 kept on
+                CHECK( not (Tmp117PowerFor<Tmp117Avg8, 20_sec>::KEEP) );
+                CHECK( (Si7051PowerFor<20_sec>::KEEP) );
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "power_policy" );
+}
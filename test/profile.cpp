@@ -0,0 +1,63 @@
+/*------------------------------------------------------------------------------
+    profile - [user-007] ProfileT table logic with host clocks
+
+    a manual clock gives exact count/min/max/total (also across a counter
+    wrap) and an exact report, steady_clock (the HostClock from the
+    Profile.hpp doc) times real sleeps and nested scopes
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "Profile.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+
+static std::string out;
+unsigned SEGGER_RTT_Write(unsigned, const void* b, unsigned len){ out.append( (const char*)b, len ); return len; }
+
+//1MHz, set by the test
+struct ManualClock {
+    static inline u32 t;
+    static void init(){}
+    static u32 now(){ return t; }
+    static constexpr auto HZ{ 1000000 };
+};
+
+struct HostClock {
+    static void init(){}
+    static u32 now(){ return std::chrono::steady_clock::now().time_since_epoch().count(); }
+    static constexpr auto HZ{ 1000000000 };
+};
+
+int main(){
+
+    using P = ProfileT<ManualClock>;
+    using S = ProfileScopeT<ManualClock>;
+    P::init();
+    ManualClock::t = 0xFFFFFF00; //first region wraps the counter
+    for( u32 us : { 500u, 100u, 300u } ){ S s{ PROF_TWIM_WRITEREAD }; ManualClock::t += us; }
+    auto& e = P::entry( PROF_TWIM_WRITEREAD );
+    CHECK( e.count == 3 and e.min == 100 and e.max == 500 and e.total == 900 );
+    CHECK( P::entry(PROF_FLASH_SAVENAME).count == 0 );
+
+    P::report( DebugRtt );
+    CHECK( out.find("Twim::writeRead              900       3     100     300     500") != std::string::npos );
+    CHECK( out.find("Flash::saveName                -") != std::string::npos );
+
+    P::clear();
+    CHECK( e.count == 0 and e.min == 0xFFFFFFFF and e.total == 0 );
+
+    //steady_clock, ns
+    using H = ProfileT<HostClock>;
+    using HS = ProfileScopeT<HostClock>;
+    using namespace std::chrono;
+    H::init();
+    for( int i = 1; i <= 3; i++ ){ HS s{ PROF_TWIM_WRITEREAD }; std::this_thread::sleep_for( milliseconds(i*2) ); }
+    { HS a{ PROF_ADV_UPDATE }; { HS t{ PROF_TEMP_UPDATE }; std::this_thread::sleep_for( milliseconds(1) ); } }
+    auto& h = H::entry( PROF_TWIM_WRITEREAD );
+    CHECK( h.count == 3 and h.min >= 2000000 and h.max >= 6000000 and h.min < h.max );
+    CHECK( h.total >= (u64)h.min + h.max );
+    CHECK( H::entry(PROF_ADV_UPDATE).total >= H::entry(PROF_TEMP_UPDATE).total );
+
+    return Test::result( "profile" );
+}
@@ -0,0 +1,75 @@
+/*------------------------------------------------------------------------------
+    rtt_bin - [user-004] DevRttBin records decoded by tools/rttdecode
+
+    the same random sequence of strings (flash and ram), numbers, chars and
+    options goes to DevRtt (channel 0, text) and DevRttBin (channel 1,
+    records), the records are decoded by rttdecode using this test's own
+    elf and must match the text byte for byte (this is a non-pie build,
+    so the rodata addresses fit the 4 byte STR record)
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include <cstdlib>
+#include <string>
+
+static std::string chan[2];
+unsigned SEGGER_RTT_Write(unsigned n, const void* b, unsigned len){ chan[n].append( (const char*)b, len ); return len; }
+unsigned SEGGER_RTT_WriteString(unsigned n, const char* s){ return SEGGER_RTT_Write( n, s, __builtin_strlen(s) ); }
+
+static char ram[32] = "ram string";
+
+template<typename D> void
+run             (D& d, unsigned seed)
+                {
+                srand( seed );
+                const char* strs[]{ "", "a", "hello", "a longer string here", FG SEA_GREEN, ram };
+                for( int k = 0; k < 300; k++ ){
+                    if( rand()%3 == 0 ) d << setw( rand()%45 );
+                    if( rand()%3 == 0 ) d << setfill( "0 x*"[rand()%4] );
+                    if( rand()%6 == 0 ) d << setwmax( rand()%12 );
+                    if( rand()%4 == 0 ) d << (rand()%2 ? left : right);
+                    if( rand()%4 == 0 ) d << (BASE_fmt)(int[]){ 2,8,10,16 }[rand()%4];
+                    if( rand()%4 == 0 ) d << (rand()%2 ? showbase : noshowbase);
+                    if( rand()%4 == 0 ) d << (rand()%2 ? showpos : noshowpos);
+                    if( rand()%4 == 0 ) d << (rand()%2 ? uppercase : nouppercase);
+                    switch( rand()%11 ){
+                        case 0:  d << strs[rand()%6]; break;
+                        case 1:  d << (u32)rand() * (u32)rand(); break;
+                        case 2:  d << (i32)(rand() - RAND_MAX/2); break;
+                        case 3:  d << (i16)rand(); break;
+                        case 4:  d << (u8)rand(); break;
+                        case 5:  d << endl; break;
+                        case 6:  d << (char)('a' + rand()%26); break;
+                        case 7:  d << (u32)0; break;
+                        case 8:  d << (i32)(-2147483647-1); break;
+                        case 9:  d << reset; break;
+                        case 10: d << ram; break;
+                    }
+                }
+                }
+
+int main(int, char** argv){
+
+    u32 txt = 0, bin = 0, bad = 0;
+    for( unsigned seed = 1; seed <= 20; seed++ ){
+        chan[0].clear(); chan[1].clear();
+        DevRtt<0> t; DevRttBin<1> b;
+        run( t, seed ); run( b, seed );
+        auto fp = fopen( "_build/rtt_bin.bin", "wb" );
+        fwrite( chan[1].data(), 1, chan[1].size(), fp );
+        fclose( fp );
+        std::string cmd = std::string("./_build/rttdecode ") + argv[0] + " _build/rtt_bin.bin";
+        std::string dec;
+        auto p = popen( cmd.c_str(), "r" );
+        int c;
+        while( (c = fgetc(p)) != EOF ) dec += (char)c;
+        pclose( p );
+        if( dec != chan[0] ){ if( not bad++ ) printf( "  seed %u differs\n", seed ); }
+        txt += chan[0].size(); bin += chan[1].size();
+    }
+    CHECK( bad == 0 );
+    CHECK( bin < txt );
+    printf( "  text %u bytes, records %u bytes\n", txt, bin );
+
+    return Test::result( "rtt_bin" );
+}
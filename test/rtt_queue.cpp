@@ -0,0 +1,109 @@
+/*------------------------------------------------------------------------------
+    rtt_queue - [user-006] DevRttQueue stress with nested irq writers
+
+    thread mode writes records and flushes, two signals are the irqs
+    (SIGUSR2 can nest in SIGUSR1, like a higher priority irq), both write
+    records into the same queue, RTT takes a random amount per flush
+
+    every record that comes out must be whole and in order per writer,
+    and bytes produced = bytes out + dropped = bytes out + reported drops
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <string>
+#include <unistd.h>
+
+static std::string out;
+static unsigned rnd{ 1 };
+unsigned SEGGER_RTT_GetAvailWriteSpace(unsigned){ rnd = rnd*1103515245 + 12345; return (rnd>>16) % 300; }
+unsigned SEGGER_RTT_Write(unsigned, const void* b, unsigned len){ out.append( (const char*)b, len ); return len; }
+
+static DevRttQueue<0, 256> q;
+static volatile u32 produced[3], seqs[3];
+static volatile int depth, maxDepth;
+static std::atomic<bool> done{ false };
+
+//"id:seq:payload:sum\n", payload length varies
+static void
+produce         (int id)
+                {
+                char rec[48];
+                u32 s = seqs[id]++;
+                int len = 5 + (s*7 + id) % 20;
+                int n = snprintf( rec, sizeof rec, "%d:%06u:", id, s );
+                unsigned sum = 0;
+                for( int i = 0; i < len; i++ ){ rec[n+i] = 'a' + (s+i) % 26; sum += rec[n+i]; }
+                n += len;
+                n += snprintf( rec+n, sizeof rec - n, ":%02x\n", sum bitand 0xFF );
+                produced[id] += n;
+                if( ++depth > maxDepth ) maxDepth = depth;
+                q.write( rec, n );
+                depth--;
+                }
+
+static void irq1(int){ for( int i = 0; i < 8; i++ ) produce( 1 ); }
+static void irq2(int){ produce( 2 ); }
+
+int main(){
+
+    struct sigaction a{}; a.sa_handler = irq1; sigemptyset( &a.sa_mask );
+    sigaction( SIGUSR1, &a, nullptr );
+    struct sigaction b{}; b.sa_handler = irq2; sigemptyset( &b.sa_mask ); sigaddset( &b.sa_mask, SIGUSR1 );
+    sigaction( SIGUSR2, &b, nullptr );
+
+    auto self = pthread_self();
+    pthread_t t1, t2;
+    pthread_create( &t1, nullptr, [](void* p)->void*{
+        auto m = *(pthread_t*)p; unsigned r = 7;
+        while( not done ){
+            r = r*1103515245 + 12345;
+            pthread_kill( m, (r>>16) bitand 1 ? SIGUSR1 : SIGUSR2 );
+            if( ((r>>8) bitand 7) == 0 ) usleep( 1 );
+        }
+        return nullptr; }, &self );
+    pthread_create( &t2, nullptr, [](void* p)->void*{
+        auto m = *(pthread_t*)p;
+        while( not done ) pthread_kill( m, SIGUSR2 );
+        return nullptr; }, &self );
+
+    for( int i = 0; i < 300000; i++ ){
+        produce( 0 );
+        if( i % 3 == 0 ) q.flush();
+    }
+    done = true;
+    pthread_join( t1, nullptr ); pthread_join( t2, nullptr );
+    for( int i = 0; i < 200; i++ ) q.flush();
+
+    u32 last[3]{}; bool first[3]{ true, true, true };
+    size_t got = 0, bad = 0, recs = 0, reported = 0, pos = 0;
+    while( pos < out.size() ){
+        auto e = out.find( '\n', pos );
+        if( e == std::string::npos ){ bad++; break; }
+        auto l = out.substr( pos, e - pos + 1 );
+        pos = e + 1;
+        if( l == "\r\n" ) continue;
+        if( l.rfind("[dropped ", 0) == 0 ){ reported += atoi( l.c_str() + 9 ); continue; }
+        int id; unsigned s, sum; char pay[48];
+        if( sscanf(l.c_str(), "%d:%u:%47[a-z]:%x", &id, &s, pay, &sum) != 4 or id < 0 or id > 2 ){ bad++; continue; }
+        unsigned cs = 0;
+        for( char* c = pay; *c; c++ ) cs += *c;
+        if( (cs bitand 0xFF) != sum or (int)strlen(pay) != 5 + (int)(s*7 + id) % 20 ){ bad++; continue; }
+        if( not first[id] and s <= last[id] ) bad++;
+        first[id] = false; last[id] = s; got += l.size(); recs++;
+    }
+    size_t prod = produced[0] + produced[1] + produced[2];
+
+    CHECK( bad == 0 );
+    CHECK( seqs[1] > 0 and seqs[2] > 0 );
+    CHECK( got + q.dropped() == prod );
+    CHECK( reported == q.dropped() );
+    printf( "  %zu records (irq1 %u, irq2 %u), max nesting %d, %zu bytes, %u dropped\n",
+            recs, seqs[1], seqs[2], maxDepth, prod, q.dropped() );
+
+    return Test::result( "rtt_queue" );
+}
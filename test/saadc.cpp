@@ -0,0 +1,124 @@
+/*------------------------------------------------------------------------------
+    saadc - [user-025] SaadcChan on the emulated SAADC
+
+    an 8x oversampled VDD read is 1 SAMPLE task (burst, 8 conversions) and
+    the cpu sleeps (__WFE) through it with no saadc irq entered, settings
+    are restored and the channel released after, readAsync returns at once
+    and calls back from the saadc irq (STARTED, END) with the result in v,
+    a read or calibrate while it runs is refused, a stalled conversion
+    returns false at the 20ms deadline (STOP issued) instead of hanging,
+    a stalled readAsync calls back false at the deadline (Deadline ch 3),
+    and Battery calibrates on the first read and then every 24th read
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Saadc.hpp"
+#include "Battery.hpp"
+
+static auto& adc = emu::saadc;
+
+                //VDD x1000 from a RES10 result (gain 1/6, 0.6V)
+static i32
+mv              (i16 v)
+                {
+                return (i32)v * 3600 / 1024;
+                }
+
+static void
+body            ()
+                {
+                SaadcChan vdd{ SaadcChan::VDD };
+                adc.vdd = 3.0;
+                i16 v = 0;
+
+                //8x, 1 SAMPLE task does the burst, asleep for it
+                Saadc::resolution( Saadc::RES12 );
+                auto a0 = emu::asleepUs;
+                auto w0 = emu::wfes;
+                auto t0 = emu::now;
+                CHECK( vdd.read( v, vdd.RES10, vdd.OVER8X ) );
+                auto us = emu::now - t0;
+                CHECK( adc.samples == 1 and adc.conversions == 8 );
+                CHECK( mv(v) >= 2995 and mv(v) <= 3005 );
+                CHECK( us >= 8*12 and us < 8*12 + 20 );                 //10us tacq + 2us each
+                CHECK( emu::wfes > w0 and emu::asleepUs - a0 >= 8*12 - 5 );
+                CHECK( emu::irqs[emu::SAADC_IRQ] == 0 );
+                printf( "  VDD 8x: %d (%d mV), %llu us, %llu us asleep, %u SAMPLE task\n",
+                        v, mv(v), us, emu::asleepUs - a0, adc.samples );
+                //settings restored, channel released, off
+                CHECK( Saadc::resolution() == Saadc::RES12 and Saadc::overSample() == Saadc::OVEROFF );
+                CHECK( not Saadc::isChannelUsed( Saadc::CH0 ) and not Saadc::isEnabled() );
+
+                //no oversampling, 1 conversion
+                adc.vdd = 2.4;
+                adc.samples = adc.conversions = 0;
+                CHECK( vdd.read( v, vdd.RES10 ) );
+                CHECK( adc.samples == 1 and adc.conversions == 1 and mv(v) >= 2395 and mv(v) <= 2405 );
+
+                //async, cb from the irq with the result in v
+                static int cbs;
+                static bool cbOk;
+                static i16 av;
+                adc.vdd = 3.3;
+                adc.samples = 0;
+                cbs = 0;
+                auto i0 = emu::irqs[emu::SAADC_IRQ];
+                CHECK( vdd.readAsync( av, vdd.RES10, vdd.OVER4X, [](bool ok){ cbs++; cbOk = ok; } ) );
+                CHECK( cbs == 0 and SaadcChan::isAsync() );
+                CHECK( not vdd.read( v, vdd.RES10 ) and not Saadc::calibrate() ); //in use
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                CHECK( cbs == 1 and cbOk and not SaadcChan::isAsync() and mv(av) >= 3295 and mv(av) <= 3305 );
+                CHECK( not Deadline::isOn( 3 ) );
+                CHECK( emu::irqs[emu::SAADC_IRQ] - i0 == 2 and adc.samples == 1 and adc.conversions == 1 + 4 );
+                CHECK( Saadc::resolution() == Saadc::RES12 and not Saadc::isEnabled() );
+
+                //stalled, false at the deadline, STOP issued, then works again
+                adc.stall = true;
+                adc.stops = 0;
+                t0 = emu::now;
+                CHECK( not vdd.read( v, vdd.RES10, vdd.OVER8X ) );
+                us = emu::now - t0;
+                CHECK( us >= Saadc::TIMEOUT_US and us < Saadc::TIMEOUT_US + 200 and adc.stops == 1 );
+                adc.stall = false;
+                CHECK( vdd.read( v, vdd.RES10, vdd.OVER8X ) and mv(v) >= 3295 );
+                printf( "  stalled: false after %llu us\n", us );
+
+                //stalled async, cb(false) at the deadline, STOP issued, free again
+                adc.stall = true;
+                adc.stops = 0;
+                cbs = 0;
+                t0 = emu::now;
+                CHECK( vdd.readAsync( av, vdd.RES10, vdd.OVER8X, [](bool ok){ cbs++; cbOk = ok; } ) );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                us = emu::now - t0;
+                CHECK( cbs == 1 and not cbOk and not SaadcChan::isAsync() and adc.stops == 1 );
+                CHECK( us >= Saadc::TIMEOUT_US and us < Saadc::TIMEOUT_US + 200 );
+                CHECK( Saadc::resolution() == Saadc::RES12 and not Saadc::isEnabled() and not Deadline::isOn( 3 ) );
+                adc.stall = false;
+                CHECK( vdd.read( v, vdd.RES10 ) and mv(v) >= 3295 );
+                printf( "  stalled async: cb(false) after %llu us\n", us );
+
+                //calibrate sleeps until done
+                auto c0 = adc.calibrations;
+                CHECK( Saadc::calibrate() and adc.calibrations == c0 + 1 );
+
+                //Battery- a read every 60 calls, calibrated on the 1st and every 24th
+                adc.vdd = 2.9;
+                c0 = adc.calibrations;
+                adc.samples = 0;
+                i16 mvB = 0;
+                for( u32 k = 0; k < 60*25; k++ ) mvB = battery.read();
+                CHECK( adc.samples == 25 and adc.calibrations == c0 + 2 );
+                CHECK( mvB >= 2895 and mvB <= 2905 and battery.isOk() );
+                printf( "  Battery: %d mV, %u reads, %u calibrations\n", mvB, adc.samples, adc.calibrations - c0 );
+                //a stalled read keeps the last value
+                adc.stall = true;
+                CHECK( battery.read() == mvB ); //count 0, a read
+                adc.stall = false;
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "saadc" );
+}
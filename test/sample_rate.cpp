@@ -0,0 +1,104 @@
+/*------------------------------------------------------------------------------
+    sample_rate - [user-016] SampleRate against a fixed 20s update
+
+    24h traces (1s steps, Fx10 like the sensor reports) replayed through
+    Temperature<NoFilter> and the rate policy the same way MyTemperatureAD
+    and Advertising use them (next(value) after each read, a non zero
+    interval replaces the timer interval), the samples taken and the max
+    error of the advertised value against the trace are printed next to a
+    fixed 20s update, the traces-
+        office      day/night 6F swing, hvac cycling 1F every 20 min
+        freezer     compressor 0.6F every 40 min, defrost +10F every 8h
+        door        room, +8F steps for 10 min every 2h
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "Temperature.hpp"
+#include <cmath>
+
+SCA DAY      { 24*3600 };
+
+static double
+office          (int s)
+                {
+                return 700 + 30*sin( 2*M_PI*s/DAY ) + 5*sin( 2*M_PI*s/1200 );
+                }
+
+static double
+freezer         (int s)
+                {
+                double f = -4 + 3*sin( 2*M_PI*s/2400 );
+                int d = s % (8*3600);
+                if( d < 1200 ) f += 100*sin( M_PI*d/1200 );
+                return f;
+                }
+
+static double
+door            (int s)
+                {
+                return 700 + ((s % 7200) < 600 ? 80 : 0);
+                }
+
+struct Run { u32 samples; i16 maxErr; u32 maxMs; };
+
+                //sensor 0.1F, reported value held until the next sample
+template<typename Rate>
+static Run
+replay          (double (*trace)(int))
+                {
+                Temperature<NoFilter> tempH;
+                Rate rate;
+                u32 interval = 20_sec;
+                Run r{ 0, 0, 0 };
+                i16 shown = -999;
+                int next = 0;
+                for( int s = 0; s < DAY; s++ ){
+                    i16 f = lround( trace(s) );
+                    if( s >= next ){
+                        tempH.add( f );
+                        shown = tempH.value();
+                        if( auto ms = rate.next( shown ) ) interval = ms;
+                        if( interval > r.maxMs ) r.maxMs = interval;
+                        next = s + interval/1000;
+                        r.samples++;
+                    }
+                    i16 e = __builtin_abs( shown - f );
+                    if( e > r.maxErr ) r.maxErr = e;
+                }
+                return r;
+                }
+
+using Adaptive = SampleRate<20_sec, 320_sec, 3>;
+
+static void
+compare         (const char* name, double (*trace)(int), u32 maxSamplesPct, i16 maxErr)
+                {
+                auto fx = replay<FixedRate>( trace );
+                auto ad = replay<Adaptive>( trace );
+                printf( "  %-8s fixed 20s %5u samples, max error %2d.%dF   adaptive %5u samples (%2u%%), max error %2d.%dF, longest %us\n",
+                        name, fx.samples, fx.maxErr/10, fx.maxErr%10,
+                        ad.samples, ad.samples*100/fx.samples, ad.maxErr/10, ad.maxErr%10, ad.maxMs/1000 );
+                CHECK( fx.samples == DAY/20 );
+                CHECK( ad.samples*100 <= fx.samples*maxSamplesPct );
+                CHECK( ad.maxErr <= maxErr );
+                CHECK( ad.maxMs == 320_sec );
+                }
+
+int main(){
+
+    compare( "office",  office,  40, 12 );
+    compare( "freezer", freezer, 60, 60 );
+    compare( "door",    door,    20, 80 );
+
+    //a change outside of the deadband goes back to the min right away,
+    //small changes keep doubling
+    Adaptive a;
+    CHECK( a.next(700) == 20_sec );
+    CHECK( a.next(702) == 40_sec and a.next(697) == 80_sec and a.next(703) == 160_sec );
+    CHECK( a.next(700) == 320_sec and a.next(700) == 320_sec );
+    CHECK( a.next(704) == 20_sec );    //outside, reference moves to 70.4
+    CHECK( a.next(706) == 40_sec );    //within 0.3F of 70.4
+    CHECK( a.next(-999) == 20_sec );   //failed read, try again soon
+
+    return Test::result( "sample_rate" );
+}
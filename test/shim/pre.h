@@ -0,0 +1,6 @@
+//included before everything (-include), the firmware's u64 is the arm
+//uint64_t (unsigned long long), on a 64bit pc it is unsigned long, which
+//the user defined literals (operator "" _u8(u64)) do not accept
+#include <cstdint>
+#define uint64_t unsigned long long
+#define int64_t long long
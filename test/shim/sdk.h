@@ -0,0 +1,116 @@
+#pragma once
+
+/*------------------------------------------------------------------------------
+    sdk.h - the parts of the nRF5 sdk/softdevice/cmsis the firmware uses,
+    so the headers build on a pc (every sdk header in shim/ includes this)
+
+    functions are only declared, stubs.cpp has weak do-nothing versions,
+    a test (or emu/Emu.hpp) defines its own to replace any of them
+------------------------------------------------------------------------------*/
+#include <cstdint>
+#include <cstddef>
+
+//app_timer
+typedef struct { uint32_t d[8]; } app_timer_t;
+typedef app_timer_t* app_timer_id_t;
+typedef void (*app_timer_timeout_handler_t)(void*);
+enum { APP_TIMER_MODE_SINGLE_SHOT, APP_TIMER_MODE_REPEATED };
+#define APP_TIMER_CONFIG_RTC_FREQUENCY 1
+#define APP_TIMER_CONFIG_IRQ_PRIORITY 6
+#define APP_TIMER_TICKS(ms) ((uint32_t)(ms)*16)
+uint32_t app_timer_init();
+uint32_t app_timer_create(const app_timer_id_t*, int, app_timer_timeout_handler_t);
+uint32_t app_timer_start(app_timer_id_t, uint32_t, void*);
+uint32_t app_timer_stop(app_timer_id_t);
+uint32_t app_timer_cnt_get();
+inline uint32_t app_timer_cnt_diff_compute(uint32_t a, uint32_t b){ return (a-b) & 0xFFFFFF; }
+
+//rtt
+unsigned SEGGER_RTT_Write(unsigned, const void*, unsigned);
+unsigned SEGGER_RTT_WriteString(unsigned, const char*);
+unsigned SEGGER_RTT_WriteNoLock(unsigned, const void*, unsigned);
+unsigned SEGGER_RTT_GetAvailWriteSpace(unsigned);
+
+//nrf_delay
+void nrf_delay_ms(uint32_t);
+void nrf_delay_us(uint32_t);
+
+//softdevice soc
+uint32_t sd_temp_get(int32_t*);
+uint32_t sd_nvic_SystemReset();
+uint32_t sd_flash_page_erase(uint32_t);
+uint32_t sd_flash_write(uint32_t*, const uint32_t*, uint32_t);
+uint32_t sd_ppi_channel_assign(uint8_t, const volatile void*, const volatile void*);
+uint32_t sd_ppi_channel_enable_set(uint32_t);
+uint32_t sd_ppi_channel_enable_clr(uint32_t);
+#define NRF_SOC_SD_PPI_CHANNELS_SD_ENABLED_MSK 0xFFFE0000
+#define NRF_SOC_SD_PPI_GROUPS_SD_ENABLED_MSK 0xC
+typedef struct { void (*handler)(uint32_t, void*); void* ctx; } nrf_sdh_soc_evt_observer_t;
+enum { NRF_EVT_FLASH_OPERATION_SUCCESS, NRF_EVT_FLASH_OPERATION_ERROR, NRF_SUCCESS = 0 };
+
+//softdevice nvic
+typedef int IRQn_Type;
+uint32_t sd_nvic_EnableIRQ(IRQn_Type);
+uint32_t sd_nvic_DisableIRQ(IRQn_Type);
+uint32_t sd_nvic_SetPriority(IRQn_Type, uint32_t);
+uint32_t sd_nvic_ClearPendingIRQ(IRQn_Type);
+uint32_t sd_nvic_critical_region_enter(uint8_t*);
+uint32_t sd_nvic_critical_region_exit(uint8_t);
+
+//sdh, power management
+bool nrf_sdh_is_enabled();
+uint32_t nrf_sdh_enable_request();
+uint32_t nrf_sdh_ble_default_cfg_set(int, uint32_t*);
+uint32_t nrf_sdh_ble_enable(uint32_t*);
+uint32_t nrf_pwr_mgmt_init();
+void nrf_pwr_mgmt_run();
+void nrf_power_dcdcen_set(bool);
+
+//ble
+struct ble_evt_hdr_t { uint16_t evt_id; };
+struct ble_uuid_t { uint16_t uuid; };
+struct ble_gatts_evt_write_t { ble_uuid_t uuid; };
+struct ble_evt_t { ble_evt_hdr_t header; struct { struct { struct { ble_gatts_evt_write_t write; } params; } gatts_evt; struct { uint16_t conn_handle; } gap_evt; } evt; };
+enum { BLE_GATTS_EVT_WRITE = 1, BLE_GAP_EVT_CONNECTED, BLE_GAP_EVT_DISCONNECTED, BLE_GAP_EVT_PHY_UPDATE_REQUEST,
+       BLE_UUID_GAP_CHARACTERISTIC_DEVICE_NAME, BLE_GAP_PHY_AUTO };
+struct ble_gap_phys_t { uint8_t tx, rx; };
+uint32_t sd_ble_gap_phy_update(uint16_t, const ble_gap_phys_t*);
+uint32_t sd_ble_gap_device_name_get(uint8_t*, uint16_t*);
+#define NRF_SDH_BLE_OBSERVER(a,b,c,d) (void)c
+#define BLE_CONN_CFG_TAG_DEFAULT 1
+struct ble_data_t { uint8_t* p_data; uint16_t len; };
+struct ble_gap_adv_data_t { ble_data_t adv_data; ble_data_t scan_rsp_data; };
+struct ble_gap_adv_params_t { struct { uint8_t type; } properties; uint32_t interval; };
+enum { BLE_GAP_ADV_SET_HANDLE_NOT_SET = 0xFF, BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED = 4, BLE_GAP_TX_POWER_ROLE_ADV = 1,
+       BLE_GAP_ADV_TYPE_CONNECTABLE_SCANNABLE_UNDIRECTED = 1, BLE_GAP_ADV_TYPE_NONCONNECTABLE_NONSCANNABLE_UNDIRECTED = 2 };
+uint32_t sd_ble_gap_tx_power_set(int, uint8_t, int8_t);
+uint32_t sd_ble_gap_adv_set_configure(uint8_t*, const ble_gap_adv_data_t*, const ble_gap_adv_params_t*);
+uint32_t sd_ble_gap_adv_start(uint8_t, int);
+uint32_t sd_ble_gap_adv_stop(uint8_t);
+struct ble_gap_conn_params_t { uint16_t min_conn_interval, max_conn_interval, slave_latency, conn_sup_timeout; };
+struct ble_gap_conn_sec_mode_t { uint8_t sm, lv; };
+#define BLE_GAP_CONN_SEC_MODE_SET_OPEN(p) ((void)p)
+#define MSEC_TO_UNITS(a,b) (a)
+uint32_t sd_ble_gap_device_name_set(const ble_gap_conn_sec_mode_t*, const uint8_t*, uint16_t);
+uint32_t sd_ble_gap_ppcp_set(const ble_gap_conn_params_t*);
+struct ble_conn_params_init_t { uint32_t first_conn_params_update_delay, next_conn_params_update_delay;
+                                uint8_t max_conn_params_update_count; bool disconnect_on_fail; };
+uint32_t ble_conn_params_init(const ble_conn_params_init_t*);
+uint32_t ble_conn_params_stop();
+
+//cmsis
+void __WFE();
+void __SEV();
+inline void __DSB(){}
+inline void __ISB(){}
+inline void __NOP(){}
+inline uint32_t __get_IPSR(){ return 0; }
+inline uint32_t __get_PRIMASK(){ return 0; }
+inline void __disable_irq(){}
+inline void __enable_irq(){}
+#define APP_IRQ_PRIORITY_HIGHEST 2
+#define APP_IRQ_PRIORITY_HIGH 2
+#define APP_IRQ_PRIORITY_MID 3
+#define APP_IRQ_PRIORITY_LOW_MID 5
+#define APP_IRQ_PRIORITY_LOW 6
+#define APP_IRQ_PRIORITY_LOWEST 7
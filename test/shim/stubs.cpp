@@ -0,0 +1,58 @@
+/*------------------------------------------------------------------------------
+    stubs.cpp - weak do-nothing sdk functions (sdk.h), linked into every
+    test, a test or emu/Emu.hpp replaces any of them with its own
+------------------------------------------------------------------------------*/
+#include "sdk.h"
+
+#define W __attribute__((weak))
+
+W uint32_t app_timer_init(){ return 0; }
+W uint32_t app_timer_create(const app_timer_id_t*, int, app_timer_timeout_handler_t){ return 0; }
+W uint32_t app_timer_start(app_timer_id_t, uint32_t, void*){ return 0; }
+W uint32_t app_timer_stop(app_timer_id_t){ return 0; }
+W uint32_t app_timer_cnt_get(){ return 0; }
+
+W unsigned SEGGER_RTT_Write(unsigned, const void*, unsigned n){ return n; }
+W unsigned SEGGER_RTT_WriteString(unsigned, const char* s){ return __builtin_strlen(s); }
+W unsigned SEGGER_RTT_WriteNoLock(unsigned, const void*, unsigned n){ return n; }
+W unsigned SEGGER_RTT_GetAvailWriteSpace(unsigned){ return 1024; }
+
+W void nrf_delay_ms(uint32_t){}
+W void nrf_delay_us(uint32_t){}
+
+W uint32_t sd_temp_get(int32_t* t){ *t = 100; return 0; } //25C (0.25C units)
+W uint32_t sd_nvic_SystemReset(){ return 0; }
+W uint32_t sd_flash_page_erase(uint32_t){ return 0; }
+W uint32_t sd_flash_write(uint32_t*, const uint32_t*, uint32_t){ return 0; }
+W uint32_t sd_ppi_channel_assign(uint8_t, const volatile void*, const volatile void*){ return 0; }
+W uint32_t sd_ppi_channel_enable_set(uint32_t){ return 0; }
+W uint32_t sd_ppi_channel_enable_clr(uint32_t){ return 0; }
+
+W uint32_t sd_nvic_EnableIRQ(IRQn_Type){ return 0; }
+W uint32_t sd_nvic_DisableIRQ(IRQn_Type){ return 0; }
+W uint32_t sd_nvic_SetPriority(IRQn_Type, uint32_t){ return 0; }
+W uint32_t sd_nvic_ClearPendingIRQ(IRQn_Type){ return 0; }
+W uint32_t sd_nvic_critical_region_enter(uint8_t* n){ *n = 0; return 0; }
+W uint32_t sd_nvic_critical_region_exit(uint8_t){ return 0; }
+
+W bool nrf_sdh_is_enabled(){ return true; }
+W uint32_t nrf_sdh_enable_request(){ return 0; }
+W uint32_t nrf_sdh_ble_default_cfg_set(int, uint32_t*){ return 0; }
+W uint32_t nrf_sdh_ble_enable(uint32_t*){ return 0; }
+W uint32_t nrf_pwr_mgmt_init(){ return 0; }
+W void nrf_pwr_mgmt_run(){}
+W void nrf_power_dcdcen_set(bool){}
+
+W uint32_t sd_ble_gap_phy_update(uint16_t, const ble_gap_phys_t*){ return 0; }
+W uint32_t sd_ble_gap_device_name_get(uint8_t*, uint16_t* n){ *n = 0; return 0; }
+W uint32_t sd_ble_gap_tx_power_set(int, uint8_t, int8_t){ return 0; }
+W uint32_t sd_ble_gap_adv_set_configure(uint8_t*, const ble_gap_adv_data_t*, const ble_gap_adv_params_t*){ return 0; }
+W uint32_t sd_ble_gap_adv_start(uint8_t, int){ return 0; }
+W uint32_t sd_ble_gap_adv_stop(uint8_t){ return 0; }
+W uint32_t sd_ble_gap_device_name_set(const ble_gap_conn_sec_mode_t*, const uint8_t*, uint16_t){ return 0; }
+W uint32_t sd_ble_gap_ppcp_set(const ble_gap_conn_params_t*){ return 0; }
+W uint32_t ble_conn_params_init(const ble_conn_params_init_t*){ return 0; }
+W uint32_t ble_conn_params_stop(){ return 0; }
+
+W void __WFE(){}
+W void __SEV(){}
@@ -0,0 +1,110 @@
+/*------------------------------------------------------------------------------
+    si7051_async - [user-014] Si7051Async on the emulated TWIM/Si7051
+
+    no hold conversion, the poll timer is sized to the resolution so the
+    first read after the conversion gets the value (no nack polls), the cpu
+    is awake (in an irq handler, twim busy) only for the transfers- compared
+    with the hold master tempWait, which holds the bus for the conversion,
+    stable readings drop to 12bit (shorter conversion) and a change goes
+    back to 14bit, a slow ic is polled every 1ms, no ic is a TIMEOUT
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Si7051.hpp"
+#include "Timer.hpp"
+
+using Twi    = decltype(board)::si7051Twi;
+using Ic     = Si7051<Twi>;
+using Gated  = Si7051Async<Ic, Timer>;
+using Keep   = Si7051Async<Ic, Timer, Si7051Res::RES_12BIT, PowerKeep>;
+
+static emu::Si7051 si{ 0x40, P0_17 };
+static int cbs;
+static emu::T64 cbAt;
+
+struct Read { emu::T64 us; emu::T64 awakeUs; };
+
+template<typename R>
+static Read
+read            ()
+                {
+                cbs = 0;
+                auto t0 = emu::now;
+                auto a0 = emu::irqUs;
+                CHECK( R::start( [](void*){ cbs++; cbAt = emu::now; } ) );
+                emu::waitFor( []{ return cbs != 0; }, 2000000 );
+                CHECK( cbs == 1 );
+                return { cbAt - t0, emu::irqUs - a0 };
+                }
+
+static void
+body            ()
+                {
+                emu::attach( si );
+                si.tempC = 21.05;   //the code truncates, 21.0 could be 20.99
+
+                //hold master, blocking- the bus (and the caller) for the conversion
+                Ic::init( false );
+                emu::wait( 25000 );
+                u16 v;
+                auto t0 = emu::now;
+                CHECK( Ic::tempWait(v) and Ic::x10C(v) == 210 );
+                auto holdUs = emu::now - t0;
+                Ic::deinit();
+                CHECK( holdUs >= 10800 );
+
+                //power up, 14bit (power on default, no user register write)
+                auto r = read<Gated>();
+                CHECK( Gated::status() == Gated::OK and Ic::x10C(Gated::raw()) == 210 );
+                CHECK( Gated::res() == Si7051Res::RES_14BIT and si.userWrites == 0 );
+                CHECK( r.us >= 25000 + 10800 and r.us < 25000 + 11000 + 500 );
+                CHECK( si.pollNacks == 0 );         //first poll after the conversion
+                CHECK( r.awakeUs < 500 );           //2 short transfers
+                CHECK( not si.on );
+                printf( "  hold master: %llu us blocked, no hold: %llu us awake of %llu us\n", holdUs, r.awakeUs, r.us );
+
+                //stable- 12bit after STABLE_N reads within 0.1C
+                for( int k = 0; k < Gated::STABLE_N; k++ ) read<Gated>();
+                r = read<Gated>();
+                CHECK( Gated::res() == Si7051Res::RES_12BIT and si.userWrites == 1 );
+                CHECK( r.us >= 25000 + 3800 and r.us < 25000 + 4000 + 500 );
+                CHECK( si.pollNacks == 0 );
+                printf( "  12bit: %llu us, %llu us awake\n", r.us, r.awakeUs );
+
+                //a change, the read that sees it is at 12bit, the next at 14bit
+                si.tempC = 23.05;
+                read<Gated>();
+                CHECK( Gated::res() == Si7051Res::RES_12BIT and Ic::x10C(Gated::raw()) == 230 );
+                auto w = si.userWrites;
+                r = read<Gated>();
+                CHECK( Gated::res() == Si7051Res::RES_14BIT and si.userWrites == w ); //14bit is the power on default
+                CHECK( r.us >= 25000 + 10800 and r.us < 25000 + 11000 + 500 );
+
+                //slow ic (conversion 20% over the max), polled every 1ms
+                si.convScale = 1.2;
+                r = read<Gated>();
+                CHECK( Gated::status() == Gated::OK and si.pollNacks == 2 );
+                CHECK( r.us >= 25000 + 12960 and r.us < 25000 + 11000 + 3000 );
+                si.convScale = 1.0;
+
+                //no ic, power up retries to 80ms
+                si.nack = true;
+                r = read<Gated>();
+                CHECK( Gated::status() == Gated::TIMEOUT );
+                CHECK( r.us >= 80000 and r.us < 90000 );
+                si.nack = false;
+
+                //kept on (standby), no power up after the first read
+                read<Keep>();
+                CHECK( Keep::status() == Keep::OK and si.on );
+                r = read<Keep>();
+                CHECK( Keep::status() == Keep::OK );
+                CHECK( r.us >= 10800 and r.us < 11000 + 500 );
+                printf( "  kept on: %llu us, %llu us awake\n", r.us, r.awakeUs );
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "si7051_async" );
+}
@@ -0,0 +1,122 @@
+/*------------------------------------------------------------------------------
+    temp_group - [user-015] TemperatureGroup on the shared i2c power rail
+
+    the emulated TMP117 and Si7051 are both on P0_17 (BL651), read one
+    after the other the rail is on for the sum of their conversions, read
+    as a group it is powered once and on for the longest one, the internal
+    temperature is read while the rail is on, a group with a source busy
+    reading for someone else refuses (nothing started, that read keeps
+    its cb), and a transfer refused as busy leaves ADDRESS (the transfer
+    in flight) alone
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Temperature.hpp"
+
+using Tmp    = TemperatureTmp117<NoFilter, Tmp117Avg8>;
+using Si     = TemperatureSi7051<NoFilter>;
+using Int    = TemperatureInternal<NoFilter>;
+using Group  = TemperatureGroup<Tmp, Si, Int>;
+using Twi    = decltype(board)::tmp117Twi;
+
+                //the TMP117 on the rail, times the rail
+struct RailTmp117 : emu::Tmp117 {
+    using emu::Tmp117::Tmp117;
+    emu::T64 onAt{ 0 }, onUs{ 0 };
+    u32 powerUps{ 0 };
+    void power(bool o) override {
+        if( o and not on ){ onAt = emu::now; powerUps++; }
+        if( not o and on ) onUs += emu::now - onAt;
+        emu::Tmp117::power( o );
+    }
+};
+
+static RailTmp117 ic{ 0x48, P0_17 };
+static emu::Si7051 si{ 0x40, P0_17 };
+static bool done;
+
+template<typename T>
+static void
+readOne         ()
+                {
+                done = false;
+                CHECK( T::start( [](void*){ done = true; } ) );
+                emu::waitFor( []{ return done; }, 2000000 );
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                emu::attach( si );
+                ic.tempC = 20.0;
+                si.tempC = 20.05;
+                emuTempQ = 80; //20C
+
+                //one after the other
+                auto t0 = emu::now;
+                readOne<Tmp>();
+                readOne<Si>();
+                readOne<Int>();
+                auto seqUs = emu::now - t0;
+                auto seqRail = ic.onUs;
+                CHECK( Tmp::last() == 680 and Si::last() == 680 and Int::last() == 680 );
+                CHECK( ic.powerUps == 2 );
+                printf( "  one at a time: %llu us, rail on %llu us\n", seqUs, seqRail );
+
+                //as a group, 1 power up, the Si7051 inside the TMP117 conversion
+                ic.tempC = 25.0;
+                si.tempC = 25.05;
+                emuTempQ = 100;
+                ic.onUs = 0; ic.powerUps = 0;
+                done = false;
+                t0 = emu::now;
+                CHECK( Group::start( [](void*){ done = true; } ) );
+                CHECK( ic.on and Int::last() == 770 ); //internal read with the rail on
+                CHECK( not Group::start() );           //busy
+                emu::waitFor( []{ return done; }, 2000000 );
+                auto grpUs = emu::now - t0;
+                CHECK( done and not Group::isBusy() );
+                CHECK( Tmp::last() == 770 and Si::last() == 770 );
+                CHECK( ic.powerUps == 1 and not ic.on );
+                CHECK( ic.onUs < seqRail * 85 / 100 );
+                CHECK( ic.onUs >= 2000 + 125000 and ic.onUs < 2000 + 125000 + 5000 ); //the TMP117, the longest
+                printf( "  group: %llu us, rail on %llu us\n", grpUs, ic.onUs );
+
+                //a Tmp read in flight (adv's), the group refuses, adv keeps its cb
+                static int advCbs, grpCbs;
+                advCbs = grpCbs = 0;
+                ic.tempC = 26.0;
+                auto sx0 = si.xfers;
+                CHECK( Tmp::start( [](void*){ advCbs++; } ) );
+                CHECK( not Group::start( [](void*){ grpCbs++; } ) and not Group::isBusy() );
+                CHECK( not Si::isBusy() and si.xfers == sx0 );  //nothing started
+                emu::waitFor( []{ return advCbs != 0; }, 2000000 );
+                emu::wait( 200000 );
+                CHECK( advCbs == 1 and grpCbs == 0 and Tmp::last() == 788 );
+                //and works again once it is done
+                done = false;
+                CHECK( Group::start( [](void*){ done = true; } ) );
+                emu::waitFor( []{ return done; }, 2000000 );
+                CHECK( done and advCbs == 1 );
+
+                //a transfer refused as busy leaves ADDRESS alone
+                Twi::init();
+                emu::wait( 25000 );
+                static u8 tx[1]{ 0 }, rx[2];
+                static bool ok;
+                done = false;
+                auto x0 = ic.xfers, s0 = si.xfers;
+                CHECK( Twi::writeReadAsync( 0x48, tx, rx, [](bool o){ ok = o; done = true; } ) );
+                CHECK( not Si7051<Twi>::reset() );     //blocking, busy
+                CHECK( emu::r( 0x40003588 ) == 0x48 );
+                emu::waitFor( []{ return done; }, 100000 );
+                CHECK( ok and ic.xfers == x0 + 2 and si.xfers == s0 ); //write, read (repeated start)
+                Twi::deinit();
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "temp_group" );
+}
@@ -0,0 +1,101 @@
+/*------------------------------------------------------------------------------
+    tmp117_alert - [user-011] Tmp117Async with ALERT as data ready (GPIOTE)
+
+    the emulated ic pulls P0_16 low when a conversion is done, the PORT
+    event wakes the cpu and the read is 1 TEMP transaction- no CONFIG
+    polling, the cb comes right at the end of the conversion (not at the
+    next poll), the pin is back to default (disconnected) after a read, and
+    an ALERT that is not connected is a TIMEOUT
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Tmp117.hpp"
+#include "Gpiote.hpp"
+#include "Timer.hpp"
+
+using Twi    = decltype(board)::tmp117Twi;
+using Ic     = Tmp117<Twi>;
+using Alert  = GpiotePin<decltype(board.tmp117Alert)>;
+using Gated  = Tmp117Async<Ic, Timer, Alert>;                       //power on conversion
+using Avg8   = Tmp117Async<Ic, Timer, Alert, Tmp117Avg8>;           //one-shot, 8 averages
+using Keep   = Tmp117Async<Ic, Timer, Alert, Tmp117Avg1, PowerKeep>;
+
+static emu::Tmp117 ic{ 0x48, P0_17, P0_16 };
+static int cbs;
+static emu::T64 cbAt;
+
+template<typename R>
+static bool
+read            (emu::T64& us)
+                {
+                cbs = 0;
+                auto t0 = emu::now;
+                auto ok = R::start( [](void*){ cbs++; cbAt = emu::now; } );
+                emu::waitFor( []{ return cbs != 0; }, 2000000 );
+                us = cbAt - t0;
+                return ok and cbs == 1;
+                }
+
+static void
+clear           ()
+                {
+                ic.configReads = ic.configWrites = ic.tempReads = 0;
+                for( auto& n : emu::irqs ) n = 0;
+                Twi::statsClear();
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                emu::T64 us;
+
+                //power on conversion, the ALERT pin ends the wait
+                ic.tempC = 22.25;
+                clear();
+                CHECK( read<Gated>(us) );
+                CHECK( Gated::status() == Gated::OK and Gated::raw() == 22.25*128 );
+                //the CONFIG write (ALERT mode) restarts the conversion, cb
+                //right when it is done (no poll interval)
+                CHECK( us >= 2000 + 125000 and us < 2000 + 125000 + 500 );
+                //no CONFIG polling, the 1 CONFIG read is the read-modify-write
+                //after power on (shadow not valid yet)
+                CHECK( ic.tempReads == 1 and ic.configReads == 1 );
+                CHECK( Twi::stats().transfers == 3 );                       //CONFIG r/w (ALERT mode), TEMP
+                CHECK( emu::irqs[emu::GPIOTE_IRQ] == 1 and emu::irqs[emu::RTC1_IRQ] == 1 ); //startup timer only
+                CHECK( not ic.on and emu::port.cnf(P0_16) == 2 );           //pin disconnected, rail off
+                printf( "  power on: %llu us, %u twim transfers\n", us, Twi::stats().transfers );
+
+                //one-shot 8 averages, ALERT set before the conversion starts
+                ic.tempC = -7.5;
+                clear();
+                CHECK( read<Avg8>(us) );
+                CHECK( Avg8::status() == Avg8::OK and Avg8::raw() == -7.5*128 );
+                CHECK( us >= 2000 + 125000 and us < 2000 + 125000 + 500 );
+                CHECK( ic.tempReads == 1 and ic.configReads == 1 );
+                CHECK( emu::irqs[emu::GPIOTE_IRQ] == 1 );
+
+                //ALERT not connected, the timer is a timeout
+                ic.alert = -1;
+                CHECK( read<Avg8>(us) );
+                CHECK( Avg8::status() == Avg8::TIMEOUT );
+                CHECK( us >= 2000 + 125000 + 20000 and us < 2000 + 125000 + 20000 + 500 );
+                ic.alert = P0_16;
+
+                //kept on, ALERT stays in data ready mode (1 CONFIG write, the
+                //one-shot), 1 TEMP read per sample
+                CHECK( read<Keep>(us) and Keep::status() == Keep::OK );
+                clear();
+                ic.tempC = 31.5;
+                CHECK( read<Keep>(us) and Keep::raw() == 31.5*128 );
+                CHECK( us >= 15500 and us < 15500 + 500 );
+                CHECK( ic.configWrites == 1 and ic.configReads == 0 and ic.tempReads == 1 );
+                CHECK( Twi::stats().transfers == 2 );
+                printf( "  kept on: %llu us, %u twim transfers\n", us, Twi::stats().transfers );
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "tmp117_alert" );
+}
@@ -0,0 +1,152 @@
+/*------------------------------------------------------------------------------
+    tmp117_async - [user-010] Tmp117Async on the emulated TWIM/TMP117
+
+    start returns right away, the cpu sleeps (__WFE) through the startup
+    and the conversion, cb comes from the app_timer irq with the value the
+    ic converted and the rail is off after a gated read, a second start
+    while busy is refused, a missing ic is a TIMEOUT, and
+    MyTemperatureAD::sample returns false (cb is called with the last
+    value) when a read is already in progress, a read that completes after
+    a connect only updates the packet (no advertising start while connected)
+    and the rate policy sees each reading once (not each packet update), a
+    new interval while connected does not start the update timer
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Advertising.hpp"
+
+using Twi    = decltype(board)::tmp117Twi;
+using Ic     = Tmp117<Twi>;
+using Gated  = Tmp117Async<Ic, Timer>;                              //power on conversion
+using Avg8   = Tmp117Async<Ic, Timer, Tmp117NoAlert, Tmp117Avg8>;   //one-shot, 8 averages
+using Keep   = Tmp117Async<Ic, Timer, Tmp117NoAlert, Tmp117Avg1, PowerKeep>;
+
+using Adv    = Advertising< MyTemperatureAD<TemperatureTmp117<NoFilter>>, 3000, 20_sec >;
+using Rated  = MyTemperatureAD< TemperatureTmp117<NoFilter>, SampleRate<20_sec, 320_sec, 3> >;
+using AdvR   = Advertising< Rated, 3000, 20_sec >;
+
+static emu::Tmp117 ic{ 0x48, P0_17 };
+
+//S112 refuses to advertise while connected (error.check would reset)
+static bool isConnected;
+static int  advStarts, advRefused;
+uint32_t sd_ble_gap_adv_start(uint8_t, int){ (isConnected ? advRefused : advStarts)++; return 0; }
+static int cbs;
+static emu::T64 cbAt;
+
+template<typename R>
+static bool
+read            (emu::T64& us)
+                {
+                cbs = 0;
+                auto t0 = emu::now;
+                auto ok = R::start( [](void*){ cbs++; cbAt = emu::now; } );
+                CHECK( emu::now - t0 < 500 );   //returns right away (at most 1 config write)
+                CHECK( not R::start() );    //busy
+                emu::waitFor( []{ return cbs != 0; }, 2000000 );
+                us = cbAt - t0;
+                return ok and cbs == 1;
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                ic.tempC = 21.5;
+                emu::T64 us;
+
+                //power on conversion, gated, the TEMP value from the ic
+                CHECK( read<Gated>(us) );
+                CHECK( Gated::status() == Gated::OK and Gated::raw() == 21.5*128 );
+                CHECK( us >= 2000 + 125000 and us < 2000 + 125000 + 3000 );
+                CHECK( emu::irqs[emu::RTC1_IRQ] == 2 );  //startup and conversion timers, no polling
+                CHECK( not ic.on and not emu::port.drives(P0_17) );
+                CHECK( Twi::stats().transfers == 2 ); //CONFIG (data ready), TEMP
+                printf( "  power on: %llu us, %u wakeups, %u twim transfers\n", us, emu::wfes, Twi::stats().transfers );
+
+                //one-shot 8 averages
+                ic.tempC = -3.25;
+                Twi::statsClear();
+                CHECK( read<Avg8>(us) );
+                CHECK( Avg8::status() == Avg8::OK and Avg8::raw() == -3.25*128 );
+                CHECK( us >= 2000 + 125000 and us < 2000 + 125000 + 3000 );
+                CHECK( ic.conversions >= 2 );
+
+                //no ic- every transfer nacks, TIMEOUT after the polls
+                ic.nack = true;
+                CHECK( read<Gated>(us) );
+                CHECK( Gated::status() == Gated::TIMEOUT );
+                CHECK( us >= 2000 + 125000 + 9*2000 ); //10 polls, 2ms apart
+                ic.nack = false;
+
+                //MyTemperatureAD::sample, a busy driver still calls cb (last value)
+                using AD = MyTemperatureAD< TemperatureTmp117<NoFilter> >;
+                static int n1, n2;
+                CHECK( AD::sample( [](void*){ n1++; } ) );
+                CHECK( not AD::sample( [](void*){ n2++; } ) );
+                CHECK( n1 == 0 and n2 == 1 );
+                emu::waitFor( []{ return n1 != 0; }, 2000000 );
+                CHECK( n1 == 1 and n2 == 1 );
+
+                //connected while a read is in flight, the late completion only
+                //updates the packet, the disconnect starts advertising
+                Adv::sample();
+                isConnected = true;
+                Adv::connected( true );
+                emu::waitFor( []{ return not TemperatureTmp117<NoFilter>::isBusy(); }, 2000000 );
+                CHECK( advStarts == 0 and advRefused == 0 );
+                isConnected = false;
+                Adv::connected( false );
+                Adv::update();
+                CHECK( advStarts == 1 and advRefused == 0 );
+
+                //the rate policy steps once per reading, packet updates
+                //(the disconnect, the heartbeat) do not move it
+                static int rd;
+                u8 buf[31];
+                Rated::sample( [](void*){ rd++; } );
+                emu::waitFor( []{ return rd == 1; }, 2000000 );
+                CHECK( Rated::interval() == 20_sec );
+                for( int i = 0; i < 3; i++ ) Rated::update( buf );
+                CHECK( Rated::interval() == 20_sec );
+                Rated::sample( [](void*){ rd++; } );
+                emu::waitFor( []{ return rd == 2; }, 2000000 );
+                CHECK( Rated::interval() == 40_sec );
+
+                //a read in flight at the connect, its new interval is kept
+                //for the disconnect, the update timer stays off until then
+                auto updateTimers = []( emu::T64 minUs = 20000000 ){ //on, an adv update interval
+                    int n = 0;
+                    for( u8 k = 0; k < emu::apptimerN; k++ ) n += emu::apptimers[k].on and emu::apptimers[k].period >= minUs;
+                    return n;
+                };
+                AdvR::timerOn();
+                CHECK( updateTimers() == 1 );
+                AdvR::sample();
+                isConnected = true;
+                AdvR::timerOff();
+                AdvR::connected( true );
+                emu::waitFor( []{ return not TemperatureTmp117<NoFilter>::isBusy(); }, 2000000 );
+                CHECK( Rated::interval() == 80_sec and updateTimers() == 0 );
+                isConnected = false;
+                AdvR::connected( false );
+                AdvR::update();
+                AdvR::timerOn();
+                CHECK( updateTimers() == 1 and updateTimers(80000000) == 1 );
+                AdvR::timerOff();
+
+                //kept on, the second read has no startup and no CONFIG read
+                CHECK( read<Keep>(us) and Keep::status() == Keep::OK );
+                CHECK( ic.on );
+                auto w = ic.configWrites, r = ic.configReads;
+                ic.tempC = 30;
+                CHECK( read<Keep>(us) and Keep::raw() == 30*128 );
+                CHECK( us >= 16000 and us < 16000 + 3000 );
+                CHECK( ic.configWrites == w + 1 and ic.configReads == r + 1 );
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "tmp117_async" );
+}
@@ -0,0 +1,144 @@
+/*------------------------------------------------------------------------------
+    tmp117_auto - [user-020] Tmp117Auto, PPI sequenced reads
+
+    the emulated TMP117 converts every 4s (cycle 5) with ALERT = data ready,
+    ALERT low (PORT event) starts the twim TEMP read through PPI, each
+    STOPPED counts in TIMER1 (PPI), the cpu wakes once every 5 samples with
+    them in order in the ring- no twim, gpiote or app_timer irq in between,
+    the PPI allocator never hands out the softdevice channels (17-19) and
+    gets all back on stop, a nack leaves its slot -32768 and stalls the
+    sequence (ALERT stays low) until check() restarts it, a wakeup while
+    connected only updates the advertising packet (no advertising start)
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Tmp117.hpp"
+#include "Boards.hpp"
+#include "Advertising.hpp"
+
+using Twi    = decltype(board)::tmp117Twi;
+using Ic     = Tmp117<Twi>;
+using Auto   = Tmp117Auto<Ic, decltype(board.tmp117Alert), 5, 5>;
+using Temp   = TemperatureTmp117Auto<NoFilter>;
+using Adv    = Advertising< MyTemperatureAD<Temp>, 3000, 30*60_sec >;
+
+SCA CYCLE_US { 4000000ull };
+
+                //each conversion result, in order
+struct SeqTmp117 : emu::Tmp117 {
+    using emu::Tmp117::Tmp117;
+    i16 seq[64];
+    u32 n{ 0 };
+    void process() override {
+        auto c = conversions;
+        emu::Tmp117::process();
+        if( conversions != c and n < 64 ) seq[n++] = temp;
+    }
+};
+
+static SeqTmp117 ic{ 0x48, P0_17, P0_16 };
+static u32 wakes;
+
+//S112 refuses to advertise while connected (error.check would reset)
+static bool isConnected;
+static int  advStarts, advRefused;
+uint32_t sd_ble_gap_adv_start(uint8_t, int){ (isConnected ? advRefused : advStarts)++; return 0; }
+
+static double
+ramp            (emu::T64 us)
+                {
+                return 20.0 + us/1e6 * 0.01; //0.01C/s, each sample differs
+                }
+
+static u32
+cpuIrqs         ()
+                {
+                return emu::irqs[emu::TWIM0_IRQ] + emu::irqs[emu::GPIOTE_IRQ] + emu::irqs[emu::RTC1_IRQ];
+                }
+
+static void
+body            ()
+                {
+                ic.tempAt = ramp;
+                emu::attach( ic );
+
+                //allocator- softdevice channels are never handed out
+                auto avail = Ppi::available();
+                CHECK( avail == 17 );
+                i8 got[20];
+                u8 n = 0;
+                for( i8 c; (c = Ppi::alloc()) >= 0; ) got[n++] = c;
+                CHECK( n == 17 and Ppi::available() == 0 );
+                bool sd = false;
+                for( u8 k = 0; k < n; k++ ) if( got[k] >= 17 ) sd = true;
+                CHECK( not sd );
+                //not enough channels, nothing left on
+                CHECK( not Auto::start() );
+                CHECK( not Auto::isOn() and not ic.on and not Twi::isBusy() );
+                for( u8 k = 0; k < n; k++ ) Ppi::free( got[k] );
+                CHECK( Ppi::available() == avail );
+
+                //5 samples per wakeup, no other cpu irq
+                CHECK( Auto::start( [](void*){ wakes++; } ) );
+                CHECK( Ppi::available() == avail - 3 and (emu::ppiEn bitand NRF_SOC_SD_PPI_CHANNELS_SD_ENABLED_MSK) == 0 );
+                CHECK( Twi::isBusy() ); //reserved
+                auto i0 = cpuIrqs(), t0 = emu::irqs[emu::TIMER1_IRQ];
+                auto s0 = ic.n, r0 = ic.tempReads;
+                emu::wait( 19*CYCLE_US + CYCLE_US/2 ); //first conversion 127ms after start
+                CHECK( wakes == 4 and emu::irqs[emu::TIMER1_IRQ] - t0 == 4 );
+                CHECK( cpuIrqs() == i0 );
+                CHECK( ic.tempReads - r0 == 20 and ic.n - s0 >= 20 );
+                bool inOrder = true;
+                for( u8 k = 0; k < 5; k++ ) if( Auto::raw(k) != ic.seq[s0 + 15 + k] ) inOrder = false;
+                CHECK( inOrder and Auto::raw(0) < Auto::raw(4) );
+                CHECK( not ic.alertLow() ); //TEMP read released it
+                CHECK( Auto::check() );
+                printf( "  %u samples, %u cpu wakeups, last %d..%d raw\n", ic.tempReads - r0, wakes, Auto::raw(0), Auto::raw(4) );
+
+                //a nack- its slot -32768, ALERT stays low, stalled
+                auto w0 = wakes;
+                emu::wait( 4*CYCLE_US );         //4 of the next 5
+                ic.nack = true;
+                emu::wait( CYCLE_US );
+                ic.nack = false;
+                CHECK( wakes == w0 + 1 and Auto::raw(4) == -32768 and Auto::raw(3) != -32768 );
+                CHECK( ic.alertLow() );
+                CHECK( Auto::check() );          //the wakeup with the failed slot
+                emu::wait( 10*CYCLE_US );
+                CHECK( wakes == w0 + 1 );        //no more PORT events
+                CHECK( not Auto::check() );      //none since, restarted
+                CHECK( Auto::isOn() and Ppi::available() == avail - 3 );
+                emu::wait( 5*CYCLE_US + CYCLE_US/2 );
+                CHECK( wakes == w0 + 2 and Auto::raw(4) != -32768 );
+
+                //all back on stop
+                Auto::stop();
+                CHECK( not Auto::isOn() and Ppi::available() == avail and emu::ppiEn == 0 );
+                CHECK( not Twi::isBusy() and not ic.on );
+
+                //advertised, the first wakeup starts advertising
+                Adv::init();
+                emu::wait( 5*CYCLE_US + CYCLE_US/2 );
+                CHECK( advStarts == 1 );
+                //connected, the next wakeup has newer samples, no start
+                isConnected = true;
+                Adv::timerOff();
+                Adv::connected( true );
+                auto last = Temp::last();
+                emu::wait( 5*CYCLE_US );
+                CHECK( Temp::last() > last );
+                CHECK( advStarts == 1 and advRefused == 0 );
+                //disconnected, started with the current packet
+                isConnected = false;
+                Adv::connected( false );
+                Adv::update();
+                Adv::timerOn();
+                CHECK( advStarts == 2 and advRefused == 0 );
+                Temp::stop();
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "tmp117_auto" );
+}
@@ -0,0 +1,95 @@
+/*------------------------------------------------------------------------------
+    tmp117_profiles - [user-013] charge and noise per sample, each profile
+
+    the emulated TMP117 integrates its supply current (135uA starting up or
+    converting, 0.25uA otherwise) and adds 3 lsb rms noise per conversion
+    (/sqrt(averages)), 100 Tmp117Async reads 20s apart per profile give the
+    ic charge per reported sample and the rms noise, both are checked
+    against the CHARGE_NC/NOISE_LSB10 table in Tmp117.hpp and printed
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Tmp117.hpp"
+#include "Timer.hpp"
+#include <cmath>
+
+using Twi    = decltype(board)::tmp117Twi;
+using Ic     = Tmp117<Twi>;
+
+SCA N        { 100 };
+SCA INTERVAL { 20ull*1000000 };
+
+static emu::Tmp117 ic{ 0x48, P0_17 };
+
+struct Result { double nc; double noise; double ms; };
+
+template<typename P, typename Power = PowerGated>
+static Result
+run             ()
+                {
+                using R = Tmp117Async<Ic, Timer, Tmp117NoAlert, P, Power>;
+                static bool done;
+                double s = 0, ss = 0, ms = 0;
+                u32 bad = 0;
+                ic.charge();
+                auto c0 = ic.chargeNc;
+                for( int k = 0; k < N; k++ ){
+                    auto t0 = emu::now;
+                    done = false;
+                    if( not R::start( [](void*){ done = true; } ) ) bad++;
+                    emu::waitFor( []{ return done; }, 2000000 );
+                    if( R::status() != R::OK ) bad++;
+                    double v = R::raw() - 20.0*128;
+                    s += v; ss += v*v;
+                    ms += (emu::now - t0) / 1000.0;
+                    emu::wait( t0 + INTERVAL - emu::now );
+                }
+                CHECK( bad == 0 );
+                ic.charge();
+                double m = s/N;
+                return { (ic.chargeNc - c0)/N, sqrt( ss/N - m*m ), ms/N };
+                }
+
+template<typename P>
+static void
+measure         (const char* name)
+                {
+                auto r = run<P>();
+                printf( "  %-14s %4u %7.1fms %7.2fuC (table %6.2fuC) %5.2f lsb (table %4.1f)\n",
+                        name, emu::Tmp117::AVG_N[P::AVG], r.ms, r.nc/1000, P::CHARGE_NC/1000.0,
+                        r.noise, P::NOISE_LSB10/10.0 );
+                CHECK( r.nc > P::CHARGE_NC*0.85 and r.nc < P::CHARGE_NC*1.15 );
+                CHECK( r.noise < P::NOISE_LSB10/10.0*1.3 );
+                CHECK( r.ms >= P::CONV_MS and r.ms < P::STARTUP_MS + P::CONV_MS + 25 ); //no polling past data ready
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                ic.tempC = 20.0;
+                ic.noiseLsb = 3.0;
+                printf( "  profile         avg    time    ic charge/sample            noise rms\n" );
+                measure<Tmp117PowerOn>( "Tmp117PowerOn" );
+                measure<Tmp117Avg1>( "Tmp117Avg1" );
+                measure<Tmp117Avg8>( "Tmp117Avg8" );
+                measure<Tmp117Avg32>( "Tmp117Avg32" );
+                measure<Tmp117Avg64>( "Tmp117Avg64" );
+
+                //averaging in the ic- more averages, less noise
+                CHECK( Tmp117Avg1::NOISE_LSB10 > Tmp117Avg8::NOISE_LSB10 );
+
+                //at 20s, keep (shutdown current all the time) costs more than
+                //the startup of a gated read, which Tmp117PowerFor agrees with
+                auto g = run<Tmp117Avg8>().nc;
+                auto k = run<Tmp117Avg8, PowerKeep>().nc;
+                printf( "  Tmp117Avg8 20s: gated %.2fuC, keep %.2fuC per sample\n", g/1000, k/1000 );
+                CHECK( not (Tmp117PowerFor<Tmp117Avg8, 20_sec>::KEEP) );
+                CHECK( k > g );
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "tmp117_profiles" );
+}
@@ -0,0 +1,158 @@
+/*------------------------------------------------------------------------------
+    tmp117_shadow - [user-023] write-through shadow of CONFIG and the limits
+
+    the emulated TMP117 counts its register reads and writes- after the
+    first read a CONFIG field change is 1 write (no read), a change to what
+    the ic already has is no transfer (a one-shot is always written), the
+    status bits still come from the ic, the limits are written once, the
+    shadow is read again after init, deinit, reset and a failed write, a
+    random field sequence leaves CONFIG as a read-modify-write each time
+    would, and a kept on driver read is 2 transfers
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Tmp117.hpp"
+#include "Gpiote.hpp"
+#include "Timer.hpp"
+#include "Boards.hpp"
+#include <random>
+
+using Twi    = decltype(board)::tmp117Twi;
+using Ic     = Tmp117<Twi>;
+using Alert  = GpiotePin<decltype(board.tmp117Alert)>;
+using Keep   = Tmp117Async<Ic, Timer, Alert, Tmp117Avg1, PowerKeep>;
+
+static emu::Tmp117 ic{ 0x48, P0_17, P0_16 };
+
+                //a CONFIG field change, as the driver functions
+struct Op { bool (*f)(); u16 bm; u16 nvm; };
+static const Op ops[]{
+    { Ic::continuous,     3<<10,              0<<10 },
+    { Ic::shutdown,       3<<10,              1<<10 },
+    { Ic::oneShot1,       3<<10|3<<5,         3<<10|0<<5 },
+    { Ic::oneShot8,       3<<10|3<<5,         3<<10|1<<5 },
+    { Ic::averageOff,     3<<5,               0<<5 },
+    { Ic::average8,       3<<5,               1<<5 },
+    { Ic::average32,      3<<5,               2<<5 },
+    { []{ return Ic::cycle(3); }, 3<<10|7<<7|3<<5, 0<<10|3<<7|1<<5 },
+    { []{ return Ic::cycle(5); }, 3<<10|7<<7|3<<5, 0<<10|5<<7|1<<5 },
+    { Ic::alertDataReady, 1<<2|1<<3,          1<<2 },
+    { Ic::alertLimits,    1<<2|1<<3|1<<4,     0 },
+};
+
+static u32
+xfers           ()
+                {
+                return Twi::stats().transfers;
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                Ic::init();
+                emu::wait( 200000 ); //power on conversion
+
+                //first change reads CONFIG, the next ones only write
+                auto r0 = ic.configReads, w0 = ic.configWrites, x0 = xfers();
+                CHECK( Ic::average32() );
+                CHECK( ic.configReads == r0 + 1 and ic.configWrites == w0 + 1 and xfers() == x0 + 2 );
+                CHECK( Ic::shutdown() and Ic::averageOff() );
+                CHECK( ic.configReads == r0 + 1 and ic.configWrites == w0 + 3 and xfers() == x0 + 4 );
+                //no change, no transfer
+                x0 = xfers();
+                CHECK( Ic::shutdown() and Ic::averageOff() and Ic::alertLimits() );
+                CHECK( xfers() == x0 );
+                //a one-shot is always written, then back to shutdown (no write)
+                CHECK( Ic::oneShot1() and Ic::oneShot1() );
+                CHECK( xfers() == x0 + 2 and ic.configReads == r0 + 1 );
+                emu::wait( 20000 );
+                CHECK( ic.mode() == 1 and Ic::shutdown() and xfers() == x0 + 2 );
+
+                //status bits are still read from the ic
+                u16 s;
+                CHECK( Ic::status( s ) and Ic::oneShot1() );
+                CHECK( not Ic::isDataReady() );
+                emu::wait( 20000 );
+                x0 = xfers();
+                CHECK( Ic::isDataReady() and not Ic::isDataReady() ); //cleared by the read
+                CHECK( xfers() == x0 + 2 );
+
+                //limits once each, a change is written
+                auto l0 = ic.limitWrites;
+                CHECK( Ic::highLimit( 30*128 ) and Ic::lowLimit( 10*128 ) );
+                CHECK( Ic::highLimit( 30*128 ) and Ic::lowLimit( 10*128 ) );
+                CHECK( ic.limitWrites == l0 + 2 );
+                CHECK( Ic::highLimit( 31*128 ) and ic.limitWrites == l0 + 3 );
+                CHECK( ic.limit[0] == 31*128 and ic.limit[1] == 10*128 );
+
+                //reset- the ic has its defaults, the next change reads again
+                Ic::reset();
+                emu::wait( 2000 );
+                r0 = ic.configReads; l0 = ic.limitWrites;
+                CHECK( Ic::average8() and ic.configReads == r0 + 1 );
+                CHECK( Ic::highLimit( 31*128 ) and ic.limitWrites == l0 + 1 and ic.limit[0] == 31*128 );
+                CHECK( (ic.config bitand 0x0FFC) == ((0x0220 bitand compl (3<<5)) bitor 1<<5) );
+
+                //a failed write, the next change reads again
+                ic.nack = true;
+                CHECK( not Ic::average32() );
+                ic.nack = false;
+                r0 = ic.configReads;
+                CHECK( Ic::average32() and ic.configReads == r0 + 1 and ((ic.config>>5) bitand 3) == 2 );
+
+                //deinit (rail off), init- the ic is back to its defaults
+                Ic::deinit();
+                emu::wait( 10000 );
+                Ic::init();
+                emu::wait( 200000 );
+                r0 = ic.configReads;
+                CHECK( Ic::shutdown() and ic.configReads == r0 + 1 );
+                CHECK( (ic.config bitand 0x0FFC) == ((0x0220 bitand compl (3<<10)) bitor 1<<10) );
+
+                //random sequence, CONFIG as a read-modify-write would leave it
+                std::mt19937 rng{ 23 };
+                u16 want = ic.config bitand 0x0FFC;
+                u32 n = 0, writes = 0, bad = 0;
+                x0 = xfers();
+                for( int k = 0; k < 400; k++ ){
+                    auto& op = ops[ rng() % (sizeof ops / sizeof ops[0]) ];
+                    u16 v = (want bitand compl op.bm) bitor op.nvm;
+                    bool oneShot = ((v >> 10) bitand 3) == 3;
+                    if( v != want or oneShot ) writes++;
+                    auto x = xfers();
+                    if( not op.f() ) bad++;
+                    if( xfers() - x != ((v != want or oneShot) ? 1u : 0u) ) bad++;
+                    want = v;
+                    if( oneShot ){ //let it finish, back to shutdown
+                        emu::wait( 600000 );
+                        want = (want bitand compl (3<<10)) bitor 1<<10;
+                    }
+                    if( (ic.config bitand 0x0FFC) != want ) bad++;
+                    n++;
+                }
+                CHECK( bad == 0 and xfers() - x0 == writes );
+                printf( "  %u field changes, %u transfers (read-modify-write %u)\n", n, writes, 2*n );
+
+                //kept on (ALERT = data ready), 10 reads, a one-shot write and
+                //a TEMP read each, the first also sets up ALERT (CONFIG read)
+                Ic::deinit();
+                static int cbs;
+                x0 = xfers();
+                for( int k = 0; k < 10; k++ ){
+                    cbs = 0;
+                    CHECK( Keep::start( [](void*){ cbs++; } ) );
+                    emu::waitFor( []{ return cbs != 0; }, 2000000 );
+                    CHECK( cbs == 1 and Keep::status() == Keep::OK );
+                }
+                auto x = xfers() - x0;
+                printf( "  kept on, 10 reads: %u transfers\n", x );
+                CHECK( x == 2*10 + 2 );
+                Ic::deinit();
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "tmp117_shadow" );
+}
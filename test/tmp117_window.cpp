@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------------
+    tmp117_window - [user-012] TemperatureTmp117Window on a temperature trace
+
+    the emulated TMP117 converts every 16s (cycle 7) from a freezer trace-
+    compressor cycling, a door opening, then a slow drift- and the mcu only
+    wakes when ALERT shows the value left the +/-0.5F window, the wakeups
+    per hour are printed next to the 180 of a 20s sample timer, and every
+    reported value is checked against the ic (never more than the deadband
+    away once the alert is handled), the CONFIG,TEMP read and the limit
+    writes are async (no irq handler waits on a transfer), an event while
+    connected only updates the advertising packet (no advertising start
+    while connected)
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Advertising.hpp"
+#include <cmath>
+
+using Temp   = TemperatureTmp117Window<NoFilter>;
+using Ic     = Tmp117< decltype(board)::tmp117Twi >;
+using Adv    = Advertising< MyTemperatureAD<Temp>, 3000, 30*60_sec >;
+
+SCA DEADBAND { Ic::rawX10F(5) - Ic::rawX10F(0) };
+SCA HOUR     { 3600ull*1000000 };
+
+static emu::Tmp117 ic{ 0x48, P0_17, P0_16 };
+static u32 events;
+static i16 reported;
+
+//S112 refuses to advertise while connected (error.check would reset)
+static bool isConnected;
+static int  advStarts, advRefused;
+uint32_t sd_ble_gap_adv_start(uint8_t, int){ (isConnected ? advRefused : advStarts)++; return 0; }
+
+                //-18C, compressor +/-0.15C every 40min, door open at 2h
+                //(+3C in 1 min, back in ~5min), drift +1C over hour 4
+static double
+freezer         (emu::T64 us)
+                {
+                double s = us / 1e6;
+                double c = -18.0 + 0.15*sin( 2*M_PI*s/2400 );
+                double d = s - 2*3600.0;
+                if( d > 0 ) c += d < 60 ? 3.0*d/60 : 3.0*exp( -(d-60)/300 );
+                if( s > 3*3600.0 ) c += (s - 3*3600.0)/3600;
+                return c;
+                }
+
+static void
+body            ()
+                {
+                ic.tempAt = freezer;
+                emu::attach( ic );
+                CHECK( Temp::start( [](void*){ events++; reported = Ic::rawX10F(Temp::last()); } ) );
+
+                emu::wait( 100000 ); //startup (limits, cycle) from the timer irq
+                auto irqUs0 = emu::irqUs;
+                u32 worst = 0;
+                for( int h = 0; h < 4; h++ ){
+                    auto e0 = events;
+                    auto w0 = emu::irqs[emu::GPIOTE_IRQ] + emu::irqs[emu::RTC1_IRQ];
+                    for( int s = 0; s < 3600; s++ ){
+                        emu::wait( 1000000 );
+                        if( events == 0 ) continue;
+                        u32 err = __builtin_abs( ic.temp - reported );
+                        if( err > worst ) worst = err;
+                    }
+                    auto w = emu::irqs[emu::GPIOTE_IRQ] + emu::irqs[emu::RTC1_IRQ] - w0;
+                    printf( "  hour %d: %2u events, %2u wakeups (20s timer: 180)\n", h+1, events - e0, w );
+                    if( h == 0 ) CHECK( w <= 8 );   //steady, a few per hour
+                    if( h == 1 ) CHECK( w <= 6 );
+                    if( h == 2 ) CHECK( w >= 10 and w <= 40 ); //door, follows it
+                    if( h == 3 ) CHECK( w >= 2 and w <= 6 );   //1.8F drift, 0.5F steps
+                    CHECK( w < 60 );
+                }
+                //F x10 rounding in the report, a few raw counts over the window
+                CHECK( worst <= DEADBAND + 8 );
+                CHECK( ic.on and ic.conversions >= 4*3600/16 - 1 );
+                CHECK( ic.configReads == events + 1 ); //1 per alert (clears the pin), 1 setup
+                CHECK( ic.limitWrites == 2*events + 2 );
+                CHECK( emu::irqUs == irqUs0 ); //read and limit writes async, no wait in an irq
+                printf( "  %u conversions, %u events, worst %u raw (window %d)\n",
+                        ic.conversions, events, worst, (int)DEADBAND );
+                Temp::stop();
+                CHECK( not ic.on );
+
+                //advertised, the first conversion alerts and starts advertising
+                ic.tempAt = []( emu::T64 ){ return -18.0; };
+                Adv::init();
+                emu::wait( 20000000 );
+                CHECK( advStarts == 1 and Temp::last() == Ic::x10F(-18*128) );
+                //connected, a 1C step alerts, the packet has it, no start
+                isConnected = true;
+                Adv::timerOff();
+                Adv::connected( true );
+                ic.tempAt = []( emu::T64 ){ return -17.0; };
+                emu::wait( 20000000 );
+                CHECK( Temp::last() == Ic::x10F(-17*128) );
+                CHECK( advStarts == 1 and advRefused == 0 );
+                //disconnected, started with the current packet
+                isConnected = false;
+                Adv::connected( false );
+                Adv::update();
+                Adv::timerOn();
+                CHECK( advStarts == 2 and advRefused == 0 );
+                Temp::stop();
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "tmp117_window" );
+}
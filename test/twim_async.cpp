@@ -0,0 +1,111 @@
+/*------------------------------------------------------------------------------
+    twim_async - [user-018] blocking and async transfers on the emulated TWIM
+
+    a blocking transfer sleeps (__WFE) until STOPPED, the twim irq is not
+    entered, an async transfer returns at once and calls back from the twim
+    irq, a STOPPED left set by a blocking transfer does not complete the
+    next async one early, a second transfer is refused while one is in
+    flight, a nack is a false result, a Si7051 hold master read (SCL
+    stretched for the conversion) is slept through, and a stretch past the
+    deadline is a timeout (both ways) after which the bus still works
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Twim.hpp"
+#include "Boards.hpp"
+
+using Twi    = decltype(board)::tmp117Twi;
+
+static emu::Tmp117 ic{ 0x48, P0_17 };
+static emu::Si7051 si{ 0x40, P0_17 };
+
+static u8 idReg[1]{ 15 }, hold[1]{ 0xE3 }, rx[2];
+static int cbs;
+static bool ok;
+static emu::T64 cbAt;
+
+static void
+cb              (bool o)
+                {
+                cbs++; ok = o; cbAt = emu::now;
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                emu::attach( si );
+                Twi::init();
+                emu::wait( 25000 );
+
+                //blocking, asleep for the transfer, no twim irq
+                auto a0 = emu::asleepUs;
+                auto w0 = emu::wfes;
+                CHECK( Twi::writeRead( 0x48, idReg, rx ) and rx[0] == 0x01 and rx[1] == 0x17 );
+                CHECK( emu::wfes > w0 and emu::asleepUs - a0 > 50 );
+                CHECK( emu::irqs[emu::TWIM0_IRQ] == 0 );
+
+                //async right after, STOPPED is still set from the blocking one
+                rx[0] = rx[1] = 0;
+                cbs = 0;
+                auto t0 = emu::now;
+                CHECK( Twi::writeReadAsync( 0x48, idReg, rx, cb ) );
+                CHECK( cbs == 0 );
+                CHECK( not Twi::writeRead( 0x48, idReg, rx ) );        //busy
+                CHECK( not Twi::readAsync( 0x48, rx, cb ) );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                CHECK( cbs == 1 and ok and rx[0] == 0x01 and rx[1] == 0x17 );
+                CHECK( cbAt - t0 > 50 and emu::irqs[emu::TWIM0_IRQ] == 1 );
+                CHECK( not Twi::isBusy() );
+
+                //nack, no slave at 0x50
+                auto n0 = Twi::stats().nacks;
+                CHECK( not Twi::writeRead( 0x50, idReg, rx ) );
+                cbs = 0;
+                CHECK( Twi::writeReadAsync( 0x50, idReg, rx, cb ) );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                CHECK( cbs == 1 and not ok );
+                CHECK( Twi::stats().nacks == n0 + 2 );
+
+                //Si7051 hold master, SCL stretched for the conversion, asleep
+                a0 = emu::asleepUs;
+                t0 = emu::now;
+                CHECK( Twi::writeRead( 0x40, hold, rx ) );
+                auto us = emu::now - t0;
+                CHECK( us >= 10800 and us < 10800 + 500 );
+                CHECK( emu::asleepUs - a0 > us - 100 );
+                printf( "  hold master read: %llu us, %llu us asleep\n", us, emu::asleepUs - a0 );
+                cbs = 0;
+                auto i0 = emu::irqUs;
+                t0 = emu::now;
+                CHECK( Twi::writeReadAsync( 0x40, hold, rx, cb ) );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                CHECK( ok and cbAt - t0 >= 10800 and emu::irqUs - i0 < 100 );
+
+                //stretched past the deadline (20ms)
+                si.convScale = 3.0;
+                auto to0 = Twi::stats().timeouts;
+                t0 = emu::now;
+                CHECK( not Twi::writeRead( 0x40, hold, rx ) );
+                us = emu::now - t0;
+                CHECK( us >= 20000 and us < 20000 + 500 );
+                emu::wait( 40000 ); //conversion done, SCL let go
+                cbs = 0;
+                t0 = emu::now;
+                CHECK( Twi::writeReadAsync( 0x40, hold, rx, cb ) );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                CHECK( cbs == 1 and not ok and cbAt - t0 >= 20000 and cbAt - t0 < 20000 + 500 );
+                CHECK( Twi::stats().timeouts == to0 + 2 );
+                si.convScale = 1.0;
+                emu::wait( 40000 );
+
+                //the bus still works
+                CHECK( Twi::writeRead( 0x48, idReg, rx ) and rx[0] == 0x01 and rx[1] == 0x17 );
+                Twi::deinit();
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "twim_async" );
+}
@@ -0,0 +1,165 @@
+/*------------------------------------------------------------------------------
+    twim_dual - [user-024] async transfers on TWIM0 and TWIM1 at once
+
+    built for the nRF52840 (Twim1), a TMP117 on TWIM0 and a Si7051 on
+    TWIM1 (same power pin)- a Si7051 hold master read on TWIM1 is in
+    flight while TWIM0 completes a chain of reads (callbacks interleave,
+    each from its own twim irq), both in parallel take about as long as
+    the longer one, a blocking TWIM0 read (Deadline ch 0) leaves the TWIM1
+    deadline alone, two stalled buses time out at their own deadlines,
+    deinit of one bus leaves the shared power pin on, and a TIMER2 irq
+    that comes in while a deadline is armed (from the register write
+    inside arm_) runs after it, so the timer keeps running for the wait
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Twim.hpp"
+
+using Twi0   = Twim0<P0_13, P0_15, P0_17>;
+using Twi1   = Twim1<P0_3, P0_4, P0_17>;
+
+SCA TIMER2   { 0x4000A000u };
+
+static emu::Tmp117 ic{ 0x48, P0_17 };
+static emu::Si7051 si{ 0x40, P0_17 };
+
+static u8 idReg[1]{ 15 }, hold[1]{ 0xE3 }, rx0[2], rx1[2];
+
+                //completions, in order (bus 0/1, ok, time)
+struct Done { u8 bus; bool ok; emu::T64 at; };
+static Done log_[16];
+static u8 n_;
+
+static void
+done            (u8 bus, bool ok)
+                {
+                if( n_ < 16 ) log_[n_++] = { bus, ok, emu::now };
+                }
+
+static u8 chain_;
+
+static void
+cb0             (bool ok)
+                {
+                done( 0, ok );
+                if( ok and --chain_ ) Twi0::writeReadAsync( 0x48, idReg, rx0, cb0 ); //from the irq
+                }
+
+static void
+cb1             (bool ok)
+                {
+                done( 1, ok );
+                }
+
+static u32
+count           (u8 bus)
+                {
+                u32 n = 0;
+                for( u8 k = 0; k < n_; k++ ) if( log_[k].bus == bus ) n++;
+                return n;
+                }
+
+                //a TIMER2 compare (ch 2) at the ch 0 capture task write, which
+                //is in arm_ (the running ch 2 makes it read the count)
+static bool armed_;
+
+static void
+preempt         (u32 a, u32 v)
+                {
+                if( not armed_ or a != TIMER2+0x040 or not v ) return;
+                armed_ = false;
+                emu::timer2.compare( 2 );
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                emu::attach( si, 0x40004000 );
+                Twi0::init();
+                Twi1::init();
+                emu::wait( 25000 );
+
+                //TWIM1 hold master read, 5 TWIM0 reads while it is in flight
+                n_ = 0; chain_ = 5;
+                auto t0 = emu::now;
+                CHECK( Twi1::writeReadAsync( 0x40, hold, rx1, cb1 ) );
+                CHECK( Twi0::writeReadAsync( 0x48, idReg, rx0, cb0 ) );
+                emu::waitFor( []{ return count(1) != 0; }, 100000 );
+                auto us = emu::now - t0;
+                CHECK( n_ == 6 and count(0) == 5 and log_[5].bus == 1 );
+                bool allOk = true;
+                for( u8 k = 0; k < n_; k++ ) if( not log_[k].ok ) allOk = false;
+                CHECK( allOk and rx0[0] == 0x01 and rx0[1] == 0x17 );
+                CHECK( log_[4].at - t0 < 1000 and us >= 10800 and us < 10800 + 500 );
+                CHECK( emu::irqs[emu::TWIM0_IRQ] == 5 and emu::irqs[emu::TWIM1_IRQ] == 1 );
+                printf( "  5 TWIM0 reads done in %llu us, TWIM1 hold read %llu us, in parallel\n", log_[4].at - t0, us );
+
+                //TWIM0 first, then TWIM1 started from its callback
+                n_ = 0; chain_ = 1;
+                CHECK( Twi0::writeReadAsync( 0x48, idReg, rx0, [](bool ok){ done( 0, ok ); Twi1::writeReadAsync( 0x40, hold, rx1, cb1 ); } ) );
+                emu::waitFor( []{ return count(1) != 0; }, 100000 );
+                CHECK( n_ == 2 and log_[0].bus == 0 and log_[1].bus == 1 and log_[1].ok );
+
+                //a blocking TWIM0 read while TWIM1 is in flight, its deadline kept
+                n_ = 0;
+                auto to1 = Twi1::stats().timeouts;
+                CHECK( Twi1::writeReadAsync( 0x40, hold, rx1, cb1 ) );
+                t0 = emu::now;
+                for( int k = 0; k < 3; k++ ) CHECK( Twi0::writeRead( 0x48, idReg, rx0 ) );
+                CHECK( emu::now - t0 < 1000 and Deadline::isOn( 2 ) and n_ == 0 );
+                emu::waitFor( []{ return n_ != 0; }, 100000 );
+                CHECK( n_ == 1 and log_[0].ok and Twi1::stats().timeouts == to1 );
+
+                //both stalled (SDA held), each times out at its own deadline
+                Twi0::timeout( 5000 );
+                Twi1::timeout( 8000 );
+                emu::twim[0].hangAt = 1; emu::twim[0].releaseClocks = 2;
+                emu::twim[1].hangAt = 1; emu::twim[1].releaseClocks = 2;
+                n_ = 0; chain_ = 1;
+                t0 = emu::now;
+                CHECK( Twi1::writeReadAsync( 0x40, hold, rx1, cb1 ) );
+                CHECK( Twi0::writeReadAsync( 0x48, idReg, rx0, cb0 ) );
+                emu::waitFor( []{ return n_ == 2; }, 100000 );
+                CHECK( n_ == 2 and log_[0].bus == 0 and log_[1].bus == 1 and not log_[0].ok and not log_[1].ok );
+                CHECK( log_[0].at - t0 >= 5000 and log_[0].at - t0 < 5200 );
+                CHECK( log_[1].at - t0 >= 8000 and log_[1].at - t0 < 8200 );
+                CHECK( not Twi0::isStuck() and not Twi1::isStuck() );
+                Twi0::timeout( 20000 );
+                Twi1::timeout( 20000 );
+
+                //TIMER2 irq in the middle of arm_ (blocking TWIM0 read, TWIM1
+                //deadline on)- it runs after the arm, the timer keeps running
+                n_ = 0;
+                CHECK( Twi1::writeReadAsync( 0x40, hold, rx1, cb1 ) );
+                emu::wait( 1000 );
+                Twi0::statsClear();
+                emu::onWrite = preempt;
+                armed_ = true;
+                CHECK( Twi0::writeRead( 0x48, idReg, rx0 ) );
+                emu::onWrite = nullptr;
+                CHECK( not armed_ and n_ == 1 and log_[0].bus == 1 and not log_[0].ok );
+                CHECK( Twi0::stats().maxUs > 50 and Twi0::stats().maxUs < 500 ); //the wait was timed
+                if( not CHECK( not Deadline::isOn( 0 ) and not Deadline::isOn( 2 ) and not emu::timer2.running ) ) return;
+                //ch 0 still fires with nothing else on
+                emu::twim[0].hangAt = 1; emu::twim[0].releaseClocks = 2;
+                t0 = emu::now;
+                CHECK( not Twi0::writeRead( 0x48, idReg, rx0 ) );
+                CHECK( emu::now - t0 >= 20000 and emu::now - t0 < 20200 );
+
+                //deinit of TWIM0, the shared power pin stays on for TWIM1
+                Twi0::deinit();
+                CHECK( si.on and emu::port.drives( P0_17 ) );
+                n_ = 0;
+                CHECK( Twi1::writeReadAsync( 0x40, hold, rx1, cb1 ) );
+                emu::waitFor( []{ return n_ != 0; }, 100000 );
+                CHECK( n_ == 1 and log_[0].ok );
+                Twi1::deinit();
+                CHECK( not si.on and not ic.on );
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "twim_dual" );
+}
@@ -0,0 +1,167 @@
+/*------------------------------------------------------------------------------
+    twim_queue - [user-019] TwimQueue batches on the emulated TWIM
+
+    the register writes are logged (onWrite)- each transfer of a batch is
+    started only after the STOPPED of the one before (from the twim irq,
+    the first from run), an ArrayList entry sets up its buffers once and
+    each element after is only a start task, a failure ends the batch (cb
+    false, the rest not started), a running batch refuses more, a batch
+    whose first transfer does not start (bus stuck) is cleared, and
+    Tmp117::statusTempAsync (Tmp117Window) is 1 batch for CONFIG and TEMP
+    on a queue of its own (not Q, same bus)
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Tmp117.hpp"
+#include "TwimQueue.hpp"
+#include "Boards.hpp"
+
+using Twi    = decltype(board)::tmp117Twi;
+using Q      = TwimQueue<Twi, 4>;
+using Ic     = Tmp117<Twi>;
+
+SCA TWIM     { 0x40003000u };
+
+static emu::Tmp117 ic{ 0x48, P0_17 };
+
+                //start tasks and EasyDMA pointer writes, in order
+struct Log { u32 starts; u32 ptrs; bool inIrq[8]; u32 irqs[8]; emu::T64 at[8]; };
+static Log lg;
+static u32 stoppedIrqs;
+
+static void
+logWrite        (u32 a, u32 v)
+                {
+                if( a == TWIM+0x534 or a == TWIM+0x544 ) lg.ptrs++;
+                if( (a != TWIM+0x000 and a != TWIM+0x008) or not v or lg.starts >= 8 ) return;
+                lg.inIrq[lg.starts] = emu::inIrq;
+                lg.irqs[lg.starts] = emu::irqs[emu::TWIM0_IRQ];
+                lg.at[lg.starts] = emu::now;
+                lg.starts++;
+                }
+
+static int cbs;
+static bool ok;
+
+static void
+cb              (bool o)
+                {
+                cbs++; ok = o;
+                }
+
+                //run, sleep until cb
+static bool
+run             ()
+                {
+                lg = {};
+                cbs = 0;
+                stoppedIrqs = emu::irqs[emu::TWIM0_IRQ];
+                if( not Q::run( cb ) ) return false;
+                CHECK( cbs == 0 and Q::isBusy() );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                stoppedIrqs = emu::irqs[emu::TWIM0_IRQ] - stoppedIrqs;
+                return cbs == 1;
+                }
+
+                //start k (k > 0) is in the twim irq of the STOPPED before it
+static bool
+chained         ()
+                {
+                if( lg.starts == 0 or lg.inIrq[0] ) return false;
+                for( u32 k = 1; k < lg.starts; k++ ){
+                    if( not lg.inIrq[k] or lg.irqs[k] != lg.irqs[k-1] + 1 or lg.at[k] <= lg.at[k-1] ) return false;
+                }
+                return true;
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                ic.tempC = 25.0;
+                Twi::init();
+                emu::wait( 25000 );
+                emu::onWrite = logWrite;
+
+                //3 transfers, 3 starts, each after the STOPPED before it
+                static u8 cfgT[1]{ 1 }, tmpT[1]{ 0 }, limT[3]{ 2, 0x0C, 0x80 }, cfg[2], tmp[2];
+                emu::wait( 200000 ); //power on conversion
+                CHECK( Q::add( 0x48, cfgT, cfg ) and Q::add( 0x48, tmpT, tmp ) and Q::add( 0x48, limT ) );
+                CHECK( run() and ok and Q::done() == 3 );
+                CHECK( lg.starts == 3 and chained() and stoppedIrqs == 3 );
+                CHECK( lg.ptrs == 2 + 1 + 1 + 1 );  //tx,rx  tx,rx  tx (write only)
+                CHECK( (tmp[0]<<8 bitor tmp[1]) == 25*128 and ic.limit[0] == 0x0C80 );
+                CHECK( (cfg[0] bitand 0x02) == 0x02 ); //0x0220 power on CONFIG
+
+                //ArrayList- 3 register reads, buffers set up once
+                static const u8 regs[3]{ 1, 0, 15 };
+                static u8 rx[3][2];
+                auto c0 = ic.configReads, t0 = ic.tempReads;
+                CHECK( Q::addList( 0x48, regs, rx ) );
+                CHECK( run() and ok and Q::done() == 3 );
+                CHECK( lg.starts == 3 and chained() );
+                CHECK( lg.ptrs == 2 );                  //TXD.PTR, RXD.PTR once
+                CHECK( (rx[1][0]<<8 bitor rx[1][1]) == 25*128 and rx[2][0] == 0x01 and rx[2][1] == 0x17 );
+                CHECK( ic.configReads == c0 + 1 and ic.tempReads == t0 + 1 );
+                CHECK( emu::r( TWIM+0x540 ) == 0 and emu::r( TWIM+0x550 ) == 0 ); //list off when done
+
+                //a nack ends the batch, the rest is not started
+                static u8 none[2];
+                t0 = ic.tempReads;
+                CHECK( Q::add( 0x48, cfgT, cfg ) and Q::add( 0x50, cfgT, none ) and Q::add( 0x48, tmpT, tmp ) );
+                CHECK( run() and not ok and Q::done() == 1 );
+                CHECK( lg.starts == 2 and chained() and ic.tempReads == t0 );
+                CHECK( not Twi::isBusy() and not Q::isBusy() );
+
+                //running, more is refused, cleared when done
+                CHECK( Q::add( 0x48, tmpT, tmp ) and Q::run( cb ) );
+                CHECK( not Q::add( 0x48, cfgT, cfg ) and not Q::run( cb ) );
+                CHECK( not Twi::writeRead( 0x48, cfgT, cfg ) );
+                emu::waitFor( []{ return not Q::isBusy(); }, 100000 );
+                CHECK( not Q::run( cb ) ); //empty
+
+                //bus stuck (SDA held for good), the first start fails, the
+                //batch is cleared, not run later after the power cycle
+                auto& bus = emu::twim[0];
+                bus.hangAt = 1;
+                bus.releaseClocks = 0xFF;
+                CHECK( not Twi::writeRead( 0x48, tmpT, tmp ) and Twi::isStuck() );
+                cbs = 0;
+                CHECK( Q::add( 0x48, cfgT, cfg ) and not Q::run( cb ) );
+                CHECK( cbs == 0 and not Q::isBusy() );
+                Twi::deinit();
+                emu::wait( 10000 );
+                Twi::init();
+                emu::wait( 25000 + 125000 ); //startup, first conversion (TEMP)
+                CHECK( not Twi::isStuck() and not Q::run( cb ) ); //empty
+                CHECK( Q::add( 0x48, tmpT, tmp ) and run() and ok and Q::done() == 1 );
+
+                //CONFIG and TEMP as 1 batch (Tmp117Window)
+                c0 = ic.configReads; t0 = ic.tempReads;
+                cbs = 0; lg = {};
+                CHECK( Ic::statusTempAsync( cb ) );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                u16 c; i16 t;
+                Ic::statusTemp( c, t );
+                CHECK( ok and t == 25*128 and (c bitand 0x0FFC) == (ic.config bitand 0x0FFC) );
+                CHECK( lg.starts == 2 and lg.ptrs == 2 );
+                CHECK( ic.configReads == c0 + 1 and ic.tempReads == t0 + 1 );
+                //twim busy, refused, the queue is left empty for the next
+                static u8 idT[1]{ 15 }, id[2];
+                CHECK( Twi::writeReadAsync( 0x48, idT, id, cb ) );
+                CHECK( not Ic::statusTempAsync( cb ) );
+                emu::waitFor( []{ return not Twi::isBusy(); }, 100000 );
+                cbs = 0;
+                CHECK( Ic::statusTempAsync( cb ) );
+                emu::waitFor( []{ return cbs != 0; }, 100000 );
+                CHECK( ok );
+
+                emu::onWrite = nullptr;
+                Twi::deinit();
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "twim_queue" );
+}
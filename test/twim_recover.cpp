@@ -0,0 +1,125 @@
+/*------------------------------------------------------------------------------
+    twim_recover - [user-022] deadline and bus recovery, SDA stuck low
+
+    the emulated slave holds SDA low in the middle of a transfer (as after
+    a brownout or reset mid-byte)- the transfer ends at the deadline (no
+    STOPPED), SCL is clocked until SDA is let go and the next transfer
+    works, a slave that never lets go marks the bus stuck, later transfers
+    are refused after a ~100us recovery try (no deadline wait) until the
+    slave lets go (the next try recovers, stuck cleared) or a power cycle,
+    the same for an async transfer (cb false at the deadline),
+    every call returns within timeoutUs + 200us, stats and p99 are checked
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Twim.hpp"
+#include "Boards.hpp"
+
+using Twi    = decltype(board)::tmp117Twi;
+
+SCA TIMEOUT_US { 20000 };
+
+static emu::Tmp117 ic{ 0x48, P0_17 };
+static auto& bus = emu::twim[0];
+static u8 idReg[1]{ 15 }, rx[2];
+static emu::T64 worstUs;
+
+                //blocking id read, its time
+static bool
+readId          ()
+                {
+                auto t0 = emu::now;
+                rx[0] = rx[1] = 0;
+                auto ok = Twi::writeRead( 0x48, idReg, rx ) and rx[0] == 0x01 and rx[1] == 0x17;
+                if( emu::now - t0 > worstUs ) worstUs = emu::now - t0;
+                return ok;
+                }
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                Twi::init();
+                Twi::timeout( TIMEOUT_US );
+                emu::wait( 25000 );
+                Twi::statsClear();
+                for( int k = 0; k < 100; k++ ) CHECK( readId() );
+                auto p99 = Twi::p99Us();
+                CHECK( p99 > 0 and p99 <= 256 and Twi::stats().transfers == 100 );
+
+                //SDA held in the 2nd byte, let go after 3 clocks
+                bus.hangAt = 2;
+                bus.releaseClocks = 3;
+                auto t0 = emu::now;
+                CHECK( not readId() );
+                auto us = emu::now - t0;
+                CHECK( us >= TIMEOUT_US and us < TIMEOUT_US + 200 );
+                CHECK( not bus.sdaLow and not Twi::isStuck() );
+                CHECK( Twi::stats().timeouts == 1 and Twi::stats().recoveries == 1 );
+                CHECK( readId() );
+                printf( "  stuck mid byte: %llu us, recovered\n", us );
+
+                //held at the address, let go after 9 clocks (the most tried)
+                bus.hangAt = 0;
+                bus.releaseClocks = 9;
+                CHECK( not readId() );
+                CHECK( not Twi::isStuck() and Twi::stats().recoveries == 2 );
+                CHECK( readId() );
+
+                //never let go- stuck, later transfers refused quickly
+                bus.hangAt = 1;
+                bus.releaseClocks = 0xFF;
+                CHECK( not readId() );
+                CHECK( Twi::isStuck() and Twi::stats().timeouts == 3 );
+                t0 = emu::now;
+                CHECK( not readId() );
+                us = emu::now - t0;
+                CHECK( us < 200 and Twi::stats().stuck == 1 and Twi::stats().timeouts == 3 );
+                static bool cbOk, cbDone;
+                CHECK( not Twi::writeReadAsync( 0x48, idReg, rx, [](bool o){ cbOk = o; cbDone = true; } ) );
+                CHECK( Twi::stats().stuck == 2 );
+                printf( "  stuck for good: refused in %llu us\n", us );
+
+                //the slave lets go by itself, the next try recovers, not stuck
+                bus.releaseClocks = 3;
+                auto r0 = Twi::stats().recoveries;
+                CHECK( readId() );
+                CHECK( not Twi::isStuck() and not bus.sdaLow and Twi::stats().recoveries == r0 + 1 );
+                CHECK( readId() and Twi::stats().stuck == 2 );
+                //stuck again for the power cycle below
+                bus.hangAt = 1;
+                bus.releaseClocks = 0xFF;
+                CHECK( not readId() and Twi::isStuck() );
+
+                //power cycle, the slave resets
+                Twi::deinit();
+                emu::wait( 10000 );
+                CHECK( not bus.sdaLow );
+                Twi::init();
+                Twi::timeout( TIMEOUT_US );
+                emu::wait( 25000 );
+                CHECK( not Twi::isStuck() and readId() );
+
+                //async, cb false at the deadline, bus recovered
+                bus.hangAt = 2;
+                bus.releaseClocks = 2;
+                cbDone = false;
+                t0 = emu::now;
+                CHECK( Twi::writeReadAsync( 0x48, idReg, rx, [](bool o){ cbOk = o; cbDone = true; } ) );
+                emu::waitFor( []{ return cbDone; }, 100000 );
+                us = emu::now - t0;
+                CHECK( cbDone and not cbOk and us >= TIMEOUT_US and us < TIMEOUT_US + 200 );
+                CHECK( not Twi::isBusy() and not Twi::isStuck() and Twi::stats().timeouts == 5 );
+                CHECK( readId() );
+
+                CHECK( worstUs < TIMEOUT_US + 200 );
+                printf( "  p99 %u us, worst %llu us (deadline %u us)\n", p99, worstUs, TIMEOUT_US );
+                Twi::statsReport();
+                Twi::deinit();
+                }
+
+int main(){
+    emu::run( body );
+    return Test::result( "twim_recover" );
+}
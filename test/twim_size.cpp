@@ -0,0 +1,102 @@
+/*------------------------------------------------------------------------------
+    twim_size - [user-021] one TwimCore for every Twim<...>
+
+    the Tmp117 + Si7051 usage (blocking and async drivers, the board twim)
+    plus a Si7051 on a second Twim0<> (other pins), each read once on the
+    emulated ics, then the symbol table of this binary (nm) is read back-
+    every TwimCore function is there once, the array reference wrappers
+    (per buffer size) have no copy of their own, only the pin code
+    (busRecover) is per Twim<>, sizes are printed next to what an engine
+    per Twim<> would be (host code sizes, x86-64, only the split matters)
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "emu/Emu.hpp"
+#include "Tmp117.hpp"
+#include "Si7051.hpp"
+#include "Timer.hpp"
+#include <cstring>
+#include <cstdio>
+#include <map>
+#include <string>
+
+using Twi    = decltype(board)::tmp117Twi;
+using Twi2   = Twim0<P0_3, P0_4>;
+using Tmp    = Tmp117<Twi>;
+using Si     = Si7051<Twi>;
+using Si2    = Si7051<Twi2>;
+using TmpA   = Tmp117Async<Tmp, Timer>;
+using SiA    = Si7051Async<Si, Timer>;
+
+static emu::Tmp117 ic{ 0x48, P0_17 };
+static emu::Si7051 si{ 0x40, P0_17 };
+static bool done;
+
+struct Sym { u32 n; u32 bytes; };
+
+static void
+body            ()
+                {
+                emu::attach( ic );
+                emu::attach( si );
+
+                done = false;
+                CHECK( TmpA::start( [](void*){ done = true; } ) );
+                emu::waitFor( []{ return done; }, 2000000 );
+                CHECK( TmpA::status() == TmpA::OK );
+                done = false;
+                CHECK( SiA::start( [](void*){ done = true; } ) );
+                emu::waitFor( []{ return done; }, 2000000 );
+                CHECK( SiA::status() == SiA::OK );
+
+                //same bus, other pins (si is on the rail, power it)
+                Tmp::init();
+                emu::wait( 25000 );
+                u16 v;
+                Si2::init( false );
+                CHECK( Si2::tempWait(v) );
+                Si2::deinit();
+                Tmp::deinit();
+                }
+
+int main(int, char** argv){
+    emu::run( body );
+
+    //the symbol table, function -> copies, bytes
+    std::map<std::string, Sym> core, twim;
+    auto f = popen( (std::string{ "nm -C -S " } + argv[0]).c_str(), "r" );
+    CHECK( f );
+    char line[1024];
+    while( f and fgets( line, sizeof line, f ) ){
+        unsigned long long a, sz;
+        char t;
+        int k = 0;
+        if( sscanf( line, "%llx %llx %c %n", &a, &sz, &t, &k ) != 3 or not k ) continue;
+        if( strchr( "TtWw", t ) == nullptr ) continue; //code only
+        std::string name{ line + k };
+        name.erase( name.find_last_not_of( "\n" ) + 1 );
+        auto& m = name.rfind( "TwimCore::", 0 ) == 0 ? core : twim;
+        if( &m == &twim and name.rfind( "Twim<", 0 ) != 0 ) continue;
+        m[name].n++;
+        m[name].bytes += sz;
+    }
+    if( f ) pclose( f );
+
+    u32 coreBytes = 0, dup = 0, twimBytes = 0, xfer = 0;
+    for( auto& [n, s] : core ){ coreBytes += s.bytes; if( s.n != 1 ) dup++; }
+    for( auto& [n, s] : twim ){
+        twimBytes += s.bytes;
+        printf( "    %5u  %s\n", s.bytes, n.c_str() );
+        if( n.find( "::writeRead" ) != std::string::npos or n.find( "::write(" ) != std::string::npos or
+            n.find( "::read(" ) != std::string::npos ) xfer++;
+    }
+    printf( "  TwimCore %u functions %u bytes (1 copy), Twim<> (2 pin sets) %u functions %u bytes\n",
+            (u32)core.size(), coreBytes, (u32)twim.size(), twimBytes );
+    printf( "  an engine per Twim<> would be %u bytes\n", 2*coreBytes + twimBytes );
+    CHECK( core.size() >= 10 and dup == 0 );    //1 copy of each
+    CHECK( core.count( "TwimCore::transfer(TwimCore::Bus&, unsigned char, unsigned int, unsigned short, unsigned int, unsigned short)" ) == 1 );
+    CHECK( xfer == 0 );                         //array wrappers inlined (no copy per size)
+    CHECK( twimBytes < coreBytes / 2 );         //only the pin code per Twim<>
+
+    return Test::result( "twim_size" );
+}
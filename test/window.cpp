@@ -0,0 +1,73 @@
+/*------------------------------------------------------------------------------
+    window - [user-008] Window against a brute force model
+
+    random values (including the i16 extremes) for several sizes, every
+    add checks mean/min/max/variance/[] against a plain history array,
+    2 instances of the same size stay independent, and the time of a
+    Window<288> add+query is printed next to the old O(N) loop
+------------------------------------------------------------------------------*/
+#include "Test.hpp"
+#include "nRFconfig.hpp"
+#include "Window.hpp"
+#include <chrono>
+#include <deque>
+#include <random>
+
+template<u16 N> void
+compare         (u32 seed, i16 lo, i16 hi)
+                {
+                Window<N, true> w;
+                std::deque<i16> ref;
+                std::mt19937 rng( seed );
+                u32 bad = 0;
+                for( int k = 0; k < 5000; k++ ){
+                    i16 v = lo + (i32)(rng() % ((i32)hi - lo + 1));
+                    if( ref.empty() ) ref.assign( N, v ); else { ref.pop_front(); ref.push_back( v ); }
+                    w.add( v );
+                    i64 s = 0, ss = 0; i16 mn = ref[0], mx = ref[0];
+                    for( auto x : ref ){ s += x; ss += (i64)x*x; if( x < mn ) mn = x; if( x > mx ) mx = x; }
+                    if( w.sum() != s or w.mean() != (i16)(s/N) or w.min() != mn or w.max() != mx ) bad++;
+                    if( w.variance() != (i32)((ss*N - s*s) / ((i64)N*N)) ) bad++;
+                    if( w[0] != v or w[N-1] != ref.front() ) bad++;
+                }
+                CHECK( bad == 0 );
+                }
+
+//the loop Window replaced (Temperature::average, i32 sum so it is a fair time)
+template<u16 N> struct OldHist {
+    i16 hist[N]{}; u16 idx{0};
+    void add(i16 v){ hist[idx] = v; idx = idx+1 < N ? idx+1 : 0; }
+    i16 average(){ i32 s = 0; for( auto x : hist ) s += x; return s / N; }
+};
+
+int main(){
+
+    compare<1>( 1, -100, 100 );
+    compare<2>( 2, -100, 100 );
+    compare<5>( 3, -32768, 32767 );
+    compare<18>( 4, 1700, 1900 );      //180F*10, overflowed the old i16 sum
+    compare<288>( 5, -32768, 32767 );
+
+    //per instance
+    Window<8> a, b;
+    a.add( 100 ); b.add( -100 );
+    for( int i = 0; i < 3; i++ ) a.add( 200 );
+    CHECK( b.mean() == -100 and b.min() == -100 and b.max() == -100 );
+    CHECK( a.mean() == (5*100 + 3*200)/8 );
+
+    //add + mean/min/max, vs add + the old loop
+    using namespace std::chrono;
+    constexpr int M = 1000000;
+    Window<288> w; OldHist<288> o;
+    volatile i32 sink = 0;
+    auto t0 = steady_clock::now();
+    for( int i = 0; i < M; i++ ){ w.add( (i16)(i*7919) ); sink = sink + w.mean() + w.min() + w.max(); }
+    auto t1 = steady_clock::now();
+    for( int i = 0; i < M; i++ ){ o.add( (i16)(i*7919) ); sink = sink + o.average(); }
+    auto t2 = steady_clock::now();
+    auto ns = [](auto a, auto b){ return duration<double, std::nano>( b - a ).count() / M; };
+    printf( "  288 samples: Window %.1f ns (mean/min/max), loop %.1f ns (mean only)\n", ns(t0,t1), ns(t1,t2) );
+    CHECK( sizeof(Window<288,false,false>) < sizeof(Window<288>) );
+
+    return Test::result( "window" );
+}
@@ -0,0 +1,188 @@
+/*------------------------------------------------------------------------------
+    rttdecode - pc side decoder for DevRttBin (Print.hpp)
+
+    strings are sent by the mcu as a flash address, the text is read from
+    the loaded sections of the .elf (must be the .elf of the running firmware)
+
+        $ g++ -O2 -std=c++17 -o rttdecode tools/rttdecode.cpp
+        $ ./rttdecode firmware.elf [rtt.bin]      (no file, reads stdin)
+        $ telnet localhost 19021 | ./rttdecode _build/nrf52810_xxaa.out
+
+    record format is documented at DevRttBin in Print.hpp
+------------------------------------------------------------------------------*/
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using u8 = uint8_t;
+using u32 = uint32_t;
+using u64 = uint64_t;
+
+/*------------------------------------------------------------------------------
+    Elf - loaded (alloc) progbits sections of an elf32/elf64 file
+------------------------------------------------------------------------------*/
+struct Elf {
+
+                struct Section { u64 addr; u64 size; u64 offset; };
+
+                bool
+load            (const char* fname)
+                {
+                auto fp = fopen( fname, "rb" );
+                if( not fp ) return false;
+                int c;
+                while( (c = fgetc(fp)) != EOF ) data_.push_back( c );
+                fclose( fp );
+                if( data_.size() < 52 or memcmp(data_.data(), "\177ELF", 4) ) return false;
+                bool is64 = data_[4] == 2;
+                le_ = data_[5] == 1;
+                u64 shoff   = is64 ? get_(0x28, 8) : get_(0x20, 4);
+                u32 shentsz = is64 ? get_(0x3A, 2) : get_(0x2E, 2);
+                u32 shnum   = is64 ? get_(0x3C, 2) : get_(0x30, 2);
+                for( u32 i = 0; i < shnum; i++ ){
+                    u64 sh = shoff + i*shentsz;
+                    if( sh + shentsz > data_.size() ) return false;
+                    u32 type = get_(sh+4, 4);
+                    u64 flags = is64 ? get_(sh+8, 8) : get_(sh+8, 4);
+                    if( type != 1 or not (flags & 2) ) continue; //SHT_PROGBITS, SHF_ALLOC
+                    Section s;
+                    s.addr   = is64 ? get_(sh+0x10, 8) : get_(sh+0x0C, 4);
+                    s.offset = is64 ? get_(sh+0x18, 8) : get_(sh+0x10, 4);
+                    s.size   = is64 ? get_(sh+0x20, 8) : get_(sh+0x14, 4);
+                    if( s.offset + s.size <= data_.size() ) sections_.push_back( s );
+                    }
+                return not sections_.empty();
+                }
+
+                //string at a target address, nullptr if not in a loaded section
+                const char*
+string          (u64 addr)
+                {
+                for( auto& s : sections_ ){
+                    if( addr < s.addr or addr >= s.addr + s.size ) continue;
+                    auto p = (const char*)&data_[s.offset + addr - s.addr];
+                    //make sure there is a 0 before the section ends
+                    if( not memchr(p, 0, s.addr + s.size - addr) ) return nullptr;
+                    return p;
+                    }
+                return nullptr;
+                }
+
+private:
+
+                u64
+get_            (u64 offset, unsigned n)
+                {
+                u64 v = 0;
+                for( unsigned i = 0; i < n; i++ ){
+                    u64 b = data_[offset + (le_ ? i : n-1-i)];
+                    v |= b << (i*8);
+                    }
+                return v;
+                }
+
+                std::vector<u8> data_;
+                std::vector<Section> sections_;
+                bool le_{ true };
+
+};
+
+/*------------------------------------------------------------------------------
+    number - same output as FormatT number_ (Print.hpp)
+------------------------------------------------------------------------------*/
+static std::string
+number          (u64 v, u8 flags, u8 width, char fill)
+                {
+                static const u8 bases[]{ 2, 8, 10, 16 };
+                auto div = bases[flags & 3];
+                bool uc  = flags & (1<<2);
+                bool sb  = flags & (1<<3);
+                bool neg = flags & (1<<4);
+                bool pos = flags & (1<<5);
+                auto fc = fill ? fill : ' ';
+                if( div == 8 and v == 0 ) sb = false; //oct 0 does not need showbase
+                auto tbl = uc ? "0123456789ABCDEF" : "0123456789abcdef";
+                std::string s; //built in reverse
+                do{ s += tbl[v % div]; v /= div; } while( v );
+                auto fillw = [&]{ while( s.size() < width ) s += fc; };
+                auto xtras = [&]{
+                    if( div == 10 ){
+                        if( neg ) s += '-';
+                        else if( pos ) s += '+';
+                        }
+                    else if( sb ){
+                        if( div == 16 ) s += 'x';
+                        else if( div == 2 ) s += 'b';
+                        s += '0';
+                        }
+                };
+                if( fc == '0' ){ fillw(); xtras(); } else { xtras(); fillw(); }
+                return { s.rbegin(), s.rend() };
+                }
+
+/*------------------------------------------------------------------------------
+    main - decode records from file/stdin to stdout
+------------------------------------------------------------------------------*/
+int
+main            (int argc, char** argv)
+                {
+                if( argc < 2 ){
+                    fprintf( stderr, "usage: %s firmware.elf [rtt.bin]\n", argv[0] );
+                    return 1;
+                    }
+                Elf elf;
+                if( not elf.load(argv[1]) ){
+                    fprintf( stderr, "%s: not a usable elf file\n", argv[1] );
+                    return 1;
+                    }
+                auto in = argc > 2 ? fopen( argv[2], "rb" ) : stdin;
+                if( not in ){
+                    fprintf( stderr, "%s: cannot open\n", argv[2] );
+                    return 1;
+                    }
+
+                enum { STR = 1, CHR, TXT, NUM };
+                auto get = [&](u8* buf, unsigned n){ return fread( buf, 1, n, in ) == n; };
+                auto le = [](const u8* p, unsigned n){
+                    u64 v = 0;
+                    for( unsigned i = 0; i < n; i++ ) v |= (u64)p[i] << (i*8);
+                    return v;
+                };
+
+                int c;
+                u8 buf[256];
+                while( (c = fgetc(in)) != EOF ){
+                    switch( c ){
+                        case STR: {
+                            if( not get(buf, 4) ) return 0;
+                            u64 a = le( buf, 4 );
+                            auto s = elf.string( a );
+                            if( s ) fputs( s, stdout );
+                            else printf( "<?str 0x%08llX>", (unsigned long long)a );
+                            break;
+                            }
+                        case CHR:
+                            if( not get(buf, 1) ) return 0;
+                            fputc( buf[0], stdout );
+                            break;
+                        case TXT:
+                            if( not get(buf, 1) or not get(&buf[1], buf[0]) ) return 0;
+                            fwrite( &buf[1], 1, buf[0], stdout );
+                            break;
+                        case NUM: {
+                            if( not get(buf, 3) ) return 0;
+                            unsigned n = buf[0] & (1<<7) ? 8 : 4;
+                            if( not get(&buf[3], n) ) return 0;
+                            fputs( number(le(&buf[3], n), buf[0], buf[1], buf[2]).c_str(), stdout );
+                            break;
+                            }
+                        default: //out of sync (or plain text channel), show as is
+                            fputc( c, stdout );
+                            break;
+                        }
+                    fflush( stdout );
+                    }
+                return 0;
+                }